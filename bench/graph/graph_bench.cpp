@@ -0,0 +1,220 @@
+#include "generators.hpp"
+#include "graph.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using clock_ = std::chrono::steady_clock;
+using graph = cxx_graph::graph<std::int64_t>;
+namespace el = cxx_graph::edge_list;
+namespace gen = cxx_graph::generators;
+
+template<class F>
+auto best_of(size_t runs, F &&f){
+    auto best = std::chrono::nanoseconds::max();
+    for(size_t i=0; i<runs; i++){
+        auto beg = clock_::now();
+        f();
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_::now() - beg);
+        best = std::min(best, time);
+    }
+    return best;
+}
+
+static volatile std::int64_t sink;
+
+/**
+ * Storage layout a graph is built and measured with
+ */
+struct layout{
+    const char *m_name;
+    cxx_graph::adjacency_mode m_mode;
+    bool m_reorder; // rcm reorder after build
+};
+
+struct result{
+    std::string m_generator;
+    std::string m_layout;
+    size_t m_nodes;
+    size_t m_edges;
+    std::string m_op;
+    size_t m_count; // items an op handles, time per item is ns/count
+    std::chrono::nanoseconds m_time;
+};
+
+/**
+ * Edge list of "generator" with about edge_count edges
+ */
+el::edges generate(const std::string &generator, size_t edge_count, cxx_graph::thread_pool &pool){
+    if(generator == "kronecker"){
+        // Graph500 edge factor 16
+        auto scale = unsigned(std::max(1.0, std::round(std::log2(double(edge_count) / 16))));
+        return gen::kronecker(scale, 16, pool);
+    }
+    if(generator == "erdos_renyi"){
+        return gen::erdos_renyi(std::uint32_t(std::max<size_t>(2, edge_count / 8)), edge_count, pool);
+    }
+    if(generator == "power_law"){
+        return gen::power_law(std::uint32_t(std::max<size_t>(2, edge_count / 8)), edge_count, pool);
+    }
+    auto side = std::uint32_t(std::max(2.0, std::round(std::sqrt(double(edge_count) / 2))));
+    return gen::grid(side, side);
+}
+
+void run(const std::string &generator, const el::edges &edges, const layout &lay, size_t runs,
+    std::vector<result> &out)
+{
+    const size_t n = size_t(edges.m_node_count), m = edges.m_keys.size();
+    auto add = [&](const char *op, size_t count, std::chrono::nanoseconds time){
+        out.emplace_back(result{generator, lay.m_name, n, m, op, count, time});
+        std::cout << "  " << op << ":\t" << double(time.count()) / std::max<size_t>(1, count) << " ns/item\n";
+    };
+    std::cout << generator << ", " << lay.m_name << ", " << n << " nodes, " << m << " edges\n";
+
+    graph gr;
+    gr.set_adjacency_mode(lay.m_mode);
+    std::vector<graph::bfs_iterator> nodes(n, graph::bfs_iterator(nullptr));
+    auto beg = clock_::now();
+    for(size_t i=0; i<n; i++){
+        nodes[i] = gr.insert(std::int64_t(i));
+    }
+    for(auto k:edges.m_keys){
+        gr.connect(nodes[el::key_first(k)], nodes[el::key_second(k)]);
+    }
+    add("insert", n + m, clock_::now() - beg);
+    std::vector<cxx_graph::node_handle> handles(n);
+    for(size_t i=0; i<n; i++){
+        handles[i] = gr.handle(nodes[i]);
+    }
+    if(lay.m_reorder){
+        gr.reorder(cxx_graph::reorder_policy::rcm);
+        // reorder invalidates iterators, handles stay
+        for(size_t i=0; i<n; i++){
+            nodes[i] = gr.find(handles[i]);
+        }
+    }
+
+    // traversal starts from the highest degree node, it's in the giant component
+    std::vector<size_t> degree(n, 0);
+    for(auto k:edges.m_keys){
+        degree[el::key_first(k)]++;
+        degree[el::key_second(k)]++;
+    }
+    const auto root = nodes[size_t(std::max_element(degree.begin(), degree.end()) - degree.begin())];
+    size_t visited = 0;
+    auto bfs = best_of(runs, [&]{
+        std::int64_t sum = 0;
+        visited = 0;
+        for(auto it = graph::bfs_iterator(root); it != gr.end(); ++it){
+            sum += *it;
+            visited++;
+        }
+        sink = sum;
+    });
+    add("bfs", visited, bfs);
+    auto dfs = best_of(runs, [&]{
+        std::int64_t sum = 0;
+        visited = 0;
+        for(auto it = graph::dfs_iterator(root); it != gr.end(); ++it){
+            sum += *it;
+            visited++;
+        }
+        sink = sum;
+    });
+    add("dfs", visited, dfs);
+
+    // half of queries are edges, half are random pairs
+    const size_t query_count = std::min<size_t>(m, 1 << 20);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> queries(query_count);
+    std::mt19937_64 rng(7);
+    for(size_t i=0; i<query_count; i++){
+        if(i % 2){
+            auto k = edges.m_keys[rng() % m];
+            queries[i] = {el::key_first(k), el::key_second(k)};
+        }else{
+            queries[i] = {std::uint32_t(rng() % n), std::uint32_t(rng() % n)};
+        }
+    }
+    add("is_adjacent", query_count, best_of(runs, [&]{
+        std::int64_t found = 0;
+        for(auto &q:queries){
+            found += graph::is_adjacent(nodes[q.first], nodes[q.second]);
+        }
+        sink = found;
+    }));
+
+    add("copy", n + m, best_of(runs, [&]{
+        graph copy(gr);
+        sink = std::int64_t(copy.size());
+    }));
+
+    // every node of a copy, in random order, so erase also removes edges from live neighbours
+    graph copy(gr);
+    std::vector<graph::bfs_iterator> victims(n, graph::bfs_iterator(nullptr));
+    for(size_t i=0; i<n; i++){
+        victims[i] = copy.find(handles[i]);
+    }
+    std::shuffle(victims.begin(), victims.end(), std::mt19937_64(11));
+    beg = clock_::now();
+    for(auto &v:victims){
+        copy.erase(v);
+    }
+    add("erase", n, clock_::now() - beg);
+}
+
+void write_json(std::ostream &os, const std::vector<result> &results, size_t runs){
+    os << "{\n  \"benchmark\": \"graph_bench\",\n  \"runs\": " << runs << ",\n  \"results\": [\n";
+    for(size_t i=0; i<results.size(); i++){
+        const auto& r = results[i];
+        os << "    {\"generator\": \"" << r.m_generator << "\", \"layout\": \"" << r.m_layout
+           << "\", \"nodes\": " << r.m_nodes << ", \"edges\": " << r.m_edges
+           << ", \"op\": \"" << r.m_op << "\", \"count\": " << r.m_count
+           << ", \"ns\": " << r.m_time.count()
+           << ", \"ns_per_item\": " << double(r.m_time.count()) / std::max<size_t>(1, r.m_count) << "}"
+           << (i+1 < results.size()? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+/**
+ * graph_bench [max edges] [json path]
+ * Runs every generator at 1e3, 1e4, ... edges up to max edges (1e6 by default)
+ * in every layout, prints a summary and writes all timings as JSON.
+ * 1e8 edges need several GB of memory for the pointer graph.
+ */
+int main(int argc, char **argv){
+    const size_t max_edges = (argc > 1)? size_t(std::stod(argv[1])) : 1000000;
+    const std::string json_path = (argc > 2)? argv[2] : "graph_bench.json";
+    const size_t runs = 3;
+    const char *generators[] = {"kronecker", "erdos_renyi", "grid", "power_law"};
+    const layout layouts[] = {
+        {"unordered", cxx_graph::adjacency_mode::unordered, false},
+        {"sorted", cxx_graph::adjacency_mode::sorted, false},
+        {"hashed", cxx_graph::adjacency_mode::hashed, false},
+        {"unordered_rcm", cxx_graph::adjacency_mode::unordered, true},
+    };
+    cxx_graph::thread_pool pool;
+    std::vector<result> results;
+    for(size_t edges=1000; edges<=max_edges; edges*=10){
+        for(auto generator:generators){
+            auto list = generate(generator, edges, pool);
+            for(const auto& lay:layouts){
+                run(generator, list, lay, runs, results);
+            }
+        }
+    }
+    std::ofstream json(json_path);
+    write_json(json, results, runs);
+    if(!json){
+        std::cerr << "can't write " << json_path << '\n';
+        return 1;
+    }
+    std::cout << "results written to " << json_path << '\n';
+    return 0;
+}
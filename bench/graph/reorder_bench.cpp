@@ -0,0 +1,125 @@
+#include "graph.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using clock_ = std::chrono::steady_clock;
+using graph = cxx_graph::graph<std::int64_t>;
+
+template<class F>
+auto best_of(size_t runs, F &&f){
+    auto best = std::chrono::nanoseconds::max();
+    for(size_t i=0; i<runs; i++){
+        auto beg = clock_::now();
+        f();
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_::now() - beg);
+        best = std::min(best, time);
+    }
+    return best;
+}
+
+static volatile std::int64_t sink;
+
+/**
+ * Grid of side*side nodes, cells are inserted in shuffled order,
+ * so grid neighbours are far from each other on the heap
+ */
+void build(graph &gr, size_t side){
+    std::vector<size_t> cells(side*side);
+    for(size_t i=0; i<cells.size(); i++){
+        cells[i] = i;
+    }
+    std::shuffle(cells.begin(), cells.end(), std::mt19937(42));
+    std::vector<graph::bfs_iterator> nodes(cells.size(), graph::bfs_iterator(nullptr));
+    for(auto cell:cells){
+        nodes[cell] = gr.insert(std::int64_t(cell));
+    }
+    for(size_t y=0; y<side; y++){
+        for(size_t x=0; x<side; x++){
+            if(x+1 < side){
+                gr.connect(nodes[y*side+x], nodes[y*side+x+1]);
+            }
+            if(y+1 < side){
+                gr.connect(nodes[y*side+x], nodes[(y+1)*side+x]);
+            }
+        }
+    }
+}
+
+struct times{
+    std::chrono::nanoseconds bfs, dfs, csr_bfs;
+};
+
+times run(const graph &gr, size_t runs){
+    times result;
+    result.bfs = best_of(runs, [&]{
+        std::int64_t sum = 0;
+        for(auto it = graph::bfs_iterator(gr.begin()); it != gr.end(); ++it){
+            sum += *it;
+        }
+        sink = sum;
+    });
+    result.dfs = best_of(runs, [&]{
+        std::int64_t sum = 0;
+        for(auto it = graph::dfs_iterator(gr.begin()); it != gr.end(); ++it){
+            sum += *it;
+        }
+        sink = sum;
+    });
+    auto csr = gr.to_csr();
+    result.csr_bfs = best_of(runs, [&]{
+        std::int64_t sum = 0;
+        csr.bfs(0, [&](size_t v, size_t){
+            sum += csr.value(v);
+        });
+        sink = sum;
+    });
+    return result;
+}
+
+int main(int argc, char **argv){
+    const size_t side = (argc > 1)? std::stoul(argv[1]) : 1000;
+    const size_t runs = 5;
+    const size_t size = side*side;
+    std::cout << side << "x" << side << " grid, best of " << runs << '\n';
+
+    times baseline;
+    auto print = [&](const std::string &name, const times &t, std::chrono::nanoseconds reorder){
+        auto line = [&](const char *kernel, std::chrono::nanoseconds time, std::chrono::nanoseconds base){
+            std::cout << "  " << kernel << ":\t" << double(time.count()) / size << " ns/node\tspeedup x"
+                      << double(base.count()) / time.count() << '\n';
+        };
+        std::cout << name;
+        if(reorder.count()){
+            std::cout << ", reorder took " << reorder.count() / 1e6 << " ms";
+        }
+        std::cout << '\n';
+        line("bfs_iterator", t.bfs, baseline.bfs);
+        line("dfs_iterator", t.dfs, baseline.dfs);
+        line("csr bfs     ", t.csr_bfs, baseline.csr_bfs);
+    };
+    {
+        graph gr;
+        build(gr, side);
+        baseline = run(gr, runs);
+        print("insertion order", baseline, std::chrono::nanoseconds(0));
+    }
+    const std::pair<const char*, cxx_graph::reorder_policy> policies[] = {
+        {"rcm", cxx_graph::reorder_policy::rcm},
+        {"degree", cxx_graph::reorder_policy::degree},
+        {"bfs", cxx_graph::reorder_policy::bfs},
+    };
+    for(const auto& policy:policies){
+        graph gr;
+        build(gr, side);
+        auto beg = clock_::now();
+        gr.reorder(policy.second);
+        auto reorder = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_::now() - beg);
+        print(policy.first, run(gr, runs), reorder);
+    }
+    return 0;
+}
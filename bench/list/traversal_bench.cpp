@@ -0,0 +1,141 @@
+#include "list.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using clock_ = std::chrono::steady_clock;
+
+template<class F>
+auto best_of(size_t runs, F&& f) {
+    auto best = std::chrono::nanoseconds::max();
+    for (size_t i = 0; i < runs; i++) {
+        auto beg = clock_::now();
+        f();
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_::now() - beg);
+        best = std::min(best, time);
+    }
+    return best;
+}
+
+static volatile std::int64_t sink;
+
+/**
+ * Hands out values from a shuffled arena, so a value is never near it's node.
+ * Models values that live in another memory region than list nodes.
+ */
+template<class T>
+struct scatter_allocator {
+    using value_type = T;
+    static std::vector<T> arena;
+    static std::vector<size_t> slots;
+
+    static void reset(size_t size) {
+        arena.assign(size, T());
+        slots.resize(size);
+        std::iota(slots.begin(), slots.end(), 0);
+        std::shuffle(slots.begin(), slots.end(), std::mt19937(7));
+    }
+
+    scatter_allocator() = default;
+    template<class U>
+    scatter_allocator(const scatter_allocator<U>&) {}
+    /**
+     * Single values come from the arena, anything else (nodes, whose arena
+     * is never reset, and arrays) from the heap
+     */
+    auto allocate(size_t n) -> T* {
+        if (n != 1 || slots.empty()) {
+            return std::allocator<T>().allocate(n);
+        }
+        auto slot = slots.back();
+        slots.pop_back();
+        return &arena[slot];
+    }
+    void deallocate(T* p, size_t n) {
+        if (arena.empty() || p < arena.data() || p >= arena.data() + arena.size()) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+    friend bool operator==(const scatter_allocator&, const scatter_allocator&) { return true; }
+    friend bool operator!=(const scatter_allocator&, const scatter_allocator&) { return false; }
+};
+template<class T>
+std::vector<T> scatter_allocator<T>::arena;
+template<class T>
+std::vector<size_t> scatter_allocator<T>::slots;
+
+template<class List>
+void run(const char* title, const List& l, size_t size, size_t runs) {
+    auto iterator_loop = best_of(runs, [&] {
+        std::int64_t sum = 0;
+        for (auto it = l.begin(); it != l.end(); ++it) {
+            sum += *it;
+        }
+        sink = sum;
+    });
+    auto for_each = best_of(runs, [&] {
+        std::int64_t sum = 0;
+        l.for_each([&sum](std::int64_t val) { sum += val; });
+        sink = sum;
+    });
+    auto gather = best_of(runs, [&] {
+        auto vec = l.to_vector();
+        sink = std::accumulate(vec.begin(), vec.end(), std::int64_t(0));
+    });
+    std::vector<std::int64_t> buf(size);
+    auto copy_to = best_of(runs, [&] {
+        l.copy_to(buf.begin());
+        sink = std::accumulate(buf.begin(), buf.end(), std::int64_t(0));
+    });
+    auto kernel = best_of(runs, [&] {
+        sink = std::accumulate(buf.begin(), buf.end(), std::int64_t(0));
+    });
+
+    auto print = [&](const char* name, std::chrono::nanoseconds time) {
+        std::cout << name << ":\t" << time.count() / 1e6 << " ms\t"
+                  << double(time.count()) / size << " ns/elem\tspeedup x"
+                  << double(iterator_loop.count()) / time.count() << '\n';
+    };
+    std::cout << title << ", " << size << " elements, best of " << runs << '\n';
+    print("iterator loop  ", iterator_loop);
+    print("for_each       ", for_each);
+    print("to_vector+sum  ", gather);
+    print("copy_to+sum    ", copy_to);
+    print("gathered sum   ", kernel);
+}
+
+int main(int argc, char** argv) {
+    const size_t size = (argc > 1) ? std::stoul(argv[1]) : (1 << 22);
+    const size_t runs = 5;
+
+    std::vector<std::int64_t> values(size);
+    std::iota(values.begin(), values.end(), 0);
+    std::shuffle(values.begin(), values.end(), std::mt19937(42));
+    {
+        // nodes are allocated in list order, values are scattered
+        using alloc_ = scatter_allocator<std::int64_t>;
+        alloc_::reset(size);
+        cont::list<std::int64_t, alloc_> l;
+        for (auto val : values) {
+            l.insert_before(l.end(), val);
+        }
+        run("scattered values", l, size, runs);
+    }
+    {
+        // values are inserted in shuffled order and then sorted,
+        // so list order doesn't match allocation order, like in a long-living list
+        cont::list<std::int64_t> l;
+        for (auto val : values) {
+            l.insert_before(l.end(), val);
+        }
+        l.sort();
+        run("shuffled nodes", l, size, runs);
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#pragma once
+/**
+ * Hot path instrumentation of iterators, compiled in with -DCONT_INSTRUMENT=1.
+ * Off by default: every CONT_INSTRUMENT_* macro expands to nothing and it's arguments
+ * aren't evaluated, so iterators are exactly as they are without this header.
+ * With -DCONT_INSTRUMENT_LATENCY=1 too, each operation is timed into a log2 histogram.
+ *
+ * Counters are thread local: instrument::snapshot() and instrument::reset()
+ * see operations of the calling thread only.
+ */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef CONT_INSTRUMENT
+#define CONT_INSTRUMENT 0
+#endif
+#ifndef CONT_INSTRUMENT_LATENCY
+#define CONT_INSTRUMENT_LATENCY 0
+#endif
+
+#if CONT_INSTRUMENT && CONT_INSTRUMENT_LATENCY
+#include <chrono>
+#endif
+
+namespace cont {
+namespace instrument {
+
+/**
+ * Instrumented operations
+ */
+enum class op_kind : std::size_t {
+    tree_df_next,   /**< tree::df_iterator::operator++ */
+    tree_df_prev,   /**< tree::df_iterator::operator-- */
+    tree_bf_next,   /**< tree::bf_iterator::operator++ */
+    list_next,      /**< list::iterator::operator++ */
+    list_prev,      /**< list::iterator::operator-- */
+    graph_bfs_next, /**< graph::bfs_iterator::operator++ */
+    graph_dfs_next, /**< graph::dfs_iterator::operator++, pre-order or post-order */
+    count
+};
+
+constexpr std::size_t op_count = std::size_t(op_kind::count);
+constexpr std::size_t latency_buckets = 32;
+
+inline auto op_name(op_kind kind) -> const char* {
+    static const char* names[op_count] = {
+        "tree_df_next", "tree_df_prev", "tree_bf_next",
+        "list_next", "list_prev",
+        "graph_bfs_next", "graph_dfs_next"};
+    return kind < op_kind::count ? names[std::size_t(kind)] : "unknown";
+}
+
+/**
+ * Counters of one operation kind
+ */
+struct op_counters {
+    std::size_t calls = 0;            /**< Count of operations */
+    std::size_t node_visits = 0;      /**< Nodes and adjacency entries read, i.e. pointer hops */
+    std::size_t parent_climbs = 0;    /**< Steps up to a parent, tree only */
+    std::size_t queue_high_water = 0; /**< Max size of a traversal queue or stack after an operation */
+    std::size_t allocations = 0;      /**< Allocations of traversal state and buffers it grows */
+    /**
+     * latency[i] is count of operations that took [2^i, 2^(i+1)) ns, latency[0] takes faster ones too.
+     * Filled only with CONT_INSTRUMENT_LATENCY
+     */
+    std::array<std::size_t, latency_buckets> latency{};
+
+    /**
+     * @return mean count of node visits per operation
+     */
+    auto visits_per_call() const -> double {
+        return calls ? double(node_visits) / double(calls) : 0;
+    }
+};
+
+/**
+ * Counters of all operation kinds
+ */
+struct counters {
+    std::array<op_counters, op_count> ops{};
+
+    auto operator[](op_kind kind) -> op_counters& { return ops[std::size_t(kind)]; }
+    auto operator[](op_kind kind) const -> const op_counters& { return ops[std::size_t(kind)]; }
+};
+
+/**
+ * Whether the library was compiled with instrumentation
+ */
+constexpr bool enabled = CONT_INSTRUMENT != 0;
+
+namespace detail {
+
+struct thread_state {
+    counters all;
+    op_counters* current = nullptr; /**< Counters of an operation in progress */
+};
+
+inline auto local() -> thread_state& {
+    thread_local thread_state state;
+    return state;
+}
+
+/**
+ * Counters of an operation in progress, nullptr outside of one
+ */
+inline auto current() -> op_counters* {
+    return local().current;
+}
+
+/**
+ * Makes an operation current for it's lifetime, times it with CONT_INSTRUMENT_LATENCY.
+ * Nested operations, e.g. postfix increment calling prefix one, are counted once.
+ */
+class op_scope {
+    op_counters* p_counters; /**< nullptr if an outer operation is counted */
+#if CONT_INSTRUMENT_LATENCY
+    std::chrono::steady_clock::time_point p_start;
+#endif
+
+public:
+    explicit op_scope(op_kind kind) : p_counters(nullptr) {
+        auto& state = local();
+        if (state.current) {
+            return;
+        }
+        p_counters = state.current = &state.all[kind];
+        p_counters->calls++;
+#if CONT_INSTRUMENT_LATENCY
+        p_start = std::chrono::steady_clock::now();
+#endif
+    }
+    op_scope(const op_scope&) = delete;
+    op_scope& operator=(const op_scope&) = delete;
+    ~op_scope() {
+        if (!p_counters) {
+            return;
+        }
+#if CONT_INSTRUMENT_LATENCY
+        auto ns = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - p_start).count());
+        std::size_t bucket = 0;
+        while (ns > 1 && bucket + 1 < latency_buckets) {
+            ns >>= 1;
+            bucket++;
+        }
+        p_counters->latency[bucket]++;
+#endif
+        local().current = nullptr;
+    }
+};
+
+inline void add_visits(std::size_t count) {
+    if (auto c = current()) {
+        c->node_visits += count;
+    }
+}
+inline void add_climb() {
+    if (auto c = current()) {
+        c->parent_climbs++;
+    }
+}
+inline void add_queue(std::size_t size) {
+    if (auto c = current()) {
+        c->queue_high_water = size > c->queue_high_water ? size : c->queue_high_water;
+    }
+}
+inline void add_allocation() {
+    if (auto c = current()) {
+        c->allocations++;
+    }
+}
+
+}; // namespace detail
+
+/**
+ * @return counters of the calling thread, zeros if instrumentation is off
+ */
+inline auto snapshot() -> counters {
+    return detail::local().all;
+}
+/**
+ * Zeroes counters of the calling thread
+ */
+inline void reset() {
+    detail::local().all = counters();
+}
+
+}; // namespace instrument
+}; // namespace cont
+
+#define CONT_INSTRUMENT_CAT_(a, b) a##b
+#define CONT_INSTRUMENT_CAT(a, b) CONT_INSTRUMENT_CAT_(a, b)
+
+#if CONT_INSTRUMENT
+/** Counts the enclosing function as one operation of "kind", until the end of scope */
+#define CONT_INSTRUMENT_OP(kind) \
+    ::cont::instrument::detail::op_scope CONT_INSTRUMENT_CAT(cont_instrument_op_, __LINE__)(::cont::instrument::op_kind::kind)
+/** "count" nodes or adjacency entries were read */
+#define CONT_INSTRUMENT_VISIT(count) ::cont::instrument::detail::add_visits(count)
+/** One step up to a parent */
+#define CONT_INSTRUMENT_CLIMB() ::cont::instrument::detail::add_climb()
+/** Traversal queue or stack has "size" entries */
+#define CONT_INSTRUMENT_QUEUE(size) ::cont::instrument::detail::add_queue(size)
+/** One allocation */
+#define CONT_INSTRUMENT_ALLOC() ::cont::instrument::detail::add_allocation()
+/** Vector "buffer" reallocates if it grows to "new_size" */
+#define CONT_INSTRUMENT_GROWS(buffer, new_size) \
+    ((new_size) > (buffer).capacity() ? ::cont::instrument::detail::add_allocation() : void())
+#else
+#define CONT_INSTRUMENT_OP(kind)
+#define CONT_INSTRUMENT_VISIT(count) ((void)0)
+#define CONT_INSTRUMENT_CLIMB() ((void)0)
+#define CONT_INSTRUMENT_QUEUE(size) ((void)0)
+#define CONT_INSTRUMENT_ALLOC() ((void)0)
+#define CONT_INSTRUMENT_GROWS(buffer, new_size) ((void)0)
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+/**
+ * Detection of std::pmr, which needs C++17 and a standard library that ships <memory_resource>.
+ * CONT_HAS_PMR is 1 when it's usable, pmr aliases of containers are declared only then.
+ */
+#if defined(__has_include)
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#define CONT_HAS_PMR 1
+#endif
+#endif
+
+#ifndef CONT_HAS_PMR
+#define CONT_HAS_PMR 0
+#endif
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace cont {
+
+/**
+ * Counters of a counting_allocator, shared by all of it's copies and rebinds.
+ * Updated with relaxed atomics, so containers on different threads may share them,
+ * but figures read while others allocate aren't a consistent snapshot.
+ */
+struct alloc_counters {
+    std::atomic<std::size_t> live_bytes{0};    /**< Bytes allocated and not freed yet */
+    std::atomic<std::size_t> peak_bytes{0};    /**< Max of live_bytes */
+    std::atomic<std::size_t> allocations{0};   /**< Calls of allocate() */
+    std::atomic<std::size_t> deallocations{0}; /**< Calls of deallocate() */
+};
+
+/**
+ * Counters of default constructed counting allocators
+ */
+inline auto global_alloc_counters() -> alloc_counters& {
+    static alloc_counters counters;
+    return counters;
+}
+
+/**
+ * Allocator that forwards to "Upstream" and counts every call and byte into alloc_counters.
+ * Plug it into a container to get allocation figures from it's stats().
+ * Allocators are equal if they share counters and their upstreams are equal.
+ * @tparam Upstream allocator that gives the memory, rebound to each type
+ */
+template<class T, class Upstream = std::allocator<T>>
+class counting_allocator {
+    template<class, class>
+    friend class counting_allocator;
+    using upstream_traits_t = std::allocator_traits<Upstream>;
+
+    Upstream p_upstream;        /**< Source of memory */
+    alloc_counters* p_counters; /**< Shared counters, never nullptr */
+
+public:
+    using value_type = T;
+    template<class U>
+    struct rebind {
+        using other = counting_allocator<U, typename upstream_traits_t::template rebind_alloc<U>>;
+    };
+
+    /**
+     * Counts into global_alloc_counters()
+     */
+    counting_allocator() : p_counters(&global_alloc_counters()) {}
+    /**
+     * @param counters counters to update, must outlive the allocator and it's copies
+     * @param upstream source of memory
+     */
+    explicit counting_allocator(alloc_counters& counters, const Upstream& upstream = Upstream())
+        : p_upstream(upstream), p_counters(&counters) {}
+    template<class U, class UpstreamU>
+    counting_allocator(const counting_allocator<U, UpstreamU>& rhs)
+        : p_upstream(rhs.p_upstream), p_counters(rhs.p_counters) {}
+
+    auto allocate(std::size_t n) -> T* {
+        T* p = upstream_traits_t::allocate(p_upstream, n);
+        auto live = p_counters->live_bytes.fetch_add(n * sizeof(T), std::memory_order_relaxed) + n * sizeof(T);
+        auto peak = p_counters->peak_bytes.load(std::memory_order_relaxed);
+        while (peak < live && !p_counters->peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        p_counters->allocations.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+    void deallocate(T* p, std::size_t n) {
+        upstream_traits_t::deallocate(p_upstream, p, n);
+        p_counters->live_bytes.fetch_sub(n * sizeof(T), std::memory_order_relaxed);
+        p_counters->deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counters() const -> const alloc_counters& { return *p_counters; }
+    auto upstream() const -> const Upstream& { return p_upstream; }
+
+    template<class U, class UpstreamU>
+    friend bool operator==(const counting_allocator& lhs, const counting_allocator<U, UpstreamU>& rhs) {
+        return &lhs.counters() == &rhs.counters() && lhs.upstream() == rhs.upstream();
+    }
+    template<class U, class UpstreamU>
+    friend bool operator!=(const counting_allocator& lhs, const counting_allocator<U, UpstreamU>& rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+/**
+ * Memory footprint of a container, see stats() of tree, list, index_list and graph.
+ * Node and value figures are kept by a container itself and cost O(1).
+ * Allocation figures are present only if the container uses counting_allocator,
+ * they cover everything counted by it's counters, other containers sharing them included.
+ */
+struct container_stats {
+    std::size_t elements = 0;    /**< Count of values */
+    std::size_t live_nodes = 0;  /**< Nodes allocated now, sentinels included */
+    std::size_t node_bytes = 0;  /**< Bytes of nodes and other structure, values excluded */
+    std::size_t value_bytes = 0; /**< Bytes of values */
+
+    bool counted = false;          /**< Whether fields below are filled */
+    std::size_t allocated_bytes = 0; /**< alloc_counters::live_bytes */
+    std::size_t peak_bytes = 0;    /**< alloc_counters::peak_bytes */
+    std::size_t allocations = 0;   /**< alloc_counters::allocations */
+    std::size_t deallocations = 0; /**< alloc_counters::deallocations */
+
+    /**
+     * @return allocated bytes if counted, node and value bytes otherwise, per value.
+     *      0 for an empty container.
+     */
+    auto bytes_per_element() const -> double {
+        if (!elements) {
+            return 0;
+        }
+        auto bytes = counted ? allocated_bytes : node_bytes + value_bytes;
+        return double(bytes) / double(elements);
+    }
+};
+
+namespace detail {
+
+/**
+ * Nothing to add for allocators that don't count
+ */
+template<class Allocator>
+void add_counters(container_stats&, const Allocator&) {}
+
+template<class T, class Upstream>
+void add_counters(container_stats& s, const counting_allocator<T, Upstream>& alloc) {
+    const auto& c = alloc.counters();
+    s.counted = true;
+    s.allocated_bytes = c.live_bytes.load(std::memory_order_relaxed);
+    s.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+    s.allocations = c.allocations.load(std::memory_order_relaxed);
+    s.deallocations = c.deallocations.load(std::memory_order_relaxed);
+}
+
+}; // namespace detail
+}; // namespace cont
@@ -0,0 +1,286 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cxx_graph{
+
+/**
+ * Default edge payload, edges without payload take no memory for it
+ */
+struct no_payload{};
+
+/**
+ * Immutable graph in compressed sparse row format.
+ * Neighbours of node "v" are targets[offsets[v]..offsets[v+1]),
+ * each row is sorted, so traversal touches memory sequentially.
+ * Undirected edge is stored in both rows of it's ends.
+ * Directed edge is stored in the row of it's source, and in the in-row of it's target:
+ * sources of edges coming to "v" are in_sources[in_offsets[v]..in_offsets[v+1]), sorted too.
+ * In-rows of an undirected graph are it's rows.
+ * Edge payloads, if any, are stored parallel to targets.
+ */
+template<class ValT, class EdgeT = no_payload>
+class csr_graph{
+public:
+    using value_type = ValT;
+    using edge_value_type = EdgeT;
+    using index_type = std::uint32_t;
+    using offset_type = std::uint64_t;
+
+    /**
+     * Range of neighbours of a node
+     */
+    class neighbors_range{
+        const index_type* m_begin, * m_end;
+    public:
+        neighbors_range(const index_type* b, const index_type* e)
+            :m_begin(b), m_end(e)
+        {}
+        const index_type* begin()const{ return m_begin; }
+        const index_type* end()const{ return m_end; }
+        size_t size()const{ return m_end - m_begin; }
+        bool empty()const{ return m_begin == m_end; }
+    };
+
+    csr_graph() = default;
+    /**
+     * @param offsets row offsets, node_count + 1 elements
+     * @param targets neighbours of nodes, rows have to be sorted
+     * @param values values of nodes, node_count elements
+     * @param edge_values payloads of adjacencies, same size as targets or empty for empty EdgeT
+     * @param directed whether rows hold outgoing edges only, in-rows are built then in O(V+E)
+     */
+    csr_graph(std::vector<offset_type> offsets, std::vector<index_type> targets,
+        std::vector<value_type> values, std::vector<edge_value_type> edge_values = {}, bool directed = false);
+
+    size_t node_count()const;
+    /**
+     * @return count of stored adjacencies, undirected edge is counted twice, directed one once
+     */
+    size_t edge_count()const;
+    bool is_directed()const{ return m_directed; }
+    /**
+     * Out-degree in a directed graph
+     */
+    size_t degree(index_type v)const;
+    /**
+     * Successors in a directed graph
+     */
+    neighbors_range neighbors(index_type v)const;
+    size_t in_degree(index_type v)const;
+    /**
+     * Predecessors in a directed graph, same as neighbors() in an undirected one
+     */
+    neighbors_range in_neighbors(index_type v)const;
+    const value_type& value(index_type v)const;
+    /**
+     * @param offset position of an adjacency in targets()
+     */
+    const edge_value_type& edge_value(offset_type offset)const;
+    /**
+     * Binary search in a row of a node with smaller degree, O(log deg).
+     * In a directed graph checks for an edge from "a" to "b" in out-row of "a" or in-row of "b"
+     */
+    bool is_adjacent(index_type a, index_type b)const;
+
+    /**
+     * Breadth-first traversal from "source"
+     * @param visit functor called as visit(node, depth) for each reached node
+     */
+    template<class F>
+    void bfs(index_type source, F &&visit)const;
+    /**
+     * Depth-first pre-order traversal from "source" with an explicit stack
+     * @param visit functor called as visit(node) for each reached node
+     */
+    template<class F>
+    void dfs(index_type source, F &&visit)const;
+
+    const std::vector<offset_type>& offsets()const{ return m_offsets; }
+    const std::vector<index_type>& targets()const{ return m_targets; }
+    const std::vector<value_type>& values()const{ return m_values; }
+    const std::vector<edge_value_type>& edge_values()const{ return m_edge_values; }
+    const std::vector<offset_type>& in_offsets()const{ return m_directed? m_in_offsets : m_offsets; }
+    const std::vector<index_type>& in_sources()const{ return m_directed? m_in_sources : m_targets; }
+    /**
+     * @param in_offset position of an adjacency in in_sources()
+     * @return position of the same edge in targets(), for edge_value()
+     */
+    offset_type in_edge(offset_type in_offset)const{ return m_directed? m_in_edges[in_offset] : in_offset; }
+private:
+    std::vector<offset_type> m_offsets = {0};
+    std::vector<index_type> m_targets;
+    std::vector<value_type> m_values;
+    std::vector<edge_value_type> m_edge_values; // empty for empty EdgeT
+    bool m_directed = false;
+    // directed graph only
+    std::vector<offset_type> m_in_offsets;
+    std::vector<index_type> m_in_sources;
+    std::vector<offset_type> m_in_edges; // position in m_targets of each in-adjacency
+
+    void p_build_in_rows();
+};
+
+template<class ValT, class EdgeT>
+csr_graph<ValT, EdgeT>::csr_graph(std::vector<offset_type> offsets, std::vector<index_type> targets,
+    std::vector<value_type> values, std::vector<edge_value_type> edge_values, bool directed)
+    :m_offsets(std::move(offsets))
+    ,m_targets(std::move(targets))
+    ,m_values(std::move(values))
+    ,m_edge_values(std::move(edge_values))
+    ,m_directed(directed)
+{
+    assert(m_offsets.size() == m_values.size()+1);
+    assert(m_offsets.back() == m_targets.size());
+    assert(m_edge_values.size() == m_targets.size()
+        || (m_edge_values.empty() && std::is_empty<edge_value_type>::value));
+    if(m_directed){
+        p_build_in_rows();
+    }
+}
+
+template<class ValT, class EdgeT>
+void csr_graph<ValT, EdgeT>::p_build_in_rows(){
+    // counting sort by target, sources come in increasing order, so in-rows end up sorted
+    const auto n = node_count();
+    m_in_offsets.assign(n+1, 0);
+    for(auto t:m_targets){
+        m_in_offsets[t+1]++;
+    }
+    for(size_t v=0; v<n; v++){
+        m_in_offsets[v+1] += m_in_offsets[v];
+    }
+    m_in_sources.resize(m_targets.size());
+    m_in_edges.resize(m_targets.size());
+    std::vector<offset_type> next(m_in_offsets.begin(), m_in_offsets.end()-1);
+    for(index_type v=0; v<n; v++){
+        for(auto o=m_offsets[v]; o<m_offsets[v+1]; o++){
+            auto pos = next[m_targets[o]]++;
+            m_in_sources[pos] = v;
+            m_in_edges[pos] = o;
+        }
+    }
+}
+
+template<class ValT, class EdgeT>
+size_t csr_graph<ValT, EdgeT>::node_count()const{
+    return m_values.size();
+}
+
+template<class ValT, class EdgeT>
+size_t csr_graph<ValT, EdgeT>::edge_count()const{
+    return m_targets.size();
+}
+
+template<class ValT, class EdgeT>
+size_t csr_graph<ValT, EdgeT>::degree(index_type v)const{
+    return m_offsets[v+1] - m_offsets[v];
+}
+
+template<class ValT, class EdgeT>
+auto csr_graph<ValT, EdgeT>::neighbors(index_type v)const
+    ->neighbors_range
+{
+    auto data = m_targets.data();
+    return neighbors_range(data + m_offsets[v], data + m_offsets[v+1]);
+}
+
+template<class ValT, class EdgeT>
+size_t csr_graph<ValT, EdgeT>::in_degree(index_type v)const{
+    const auto& offsets = in_offsets();
+    return offsets[v+1] - offsets[v];
+}
+
+template<class ValT, class EdgeT>
+auto csr_graph<ValT, EdgeT>::in_neighbors(index_type v)const
+    ->neighbors_range
+{
+    const auto& offsets = in_offsets();
+    auto data = in_sources().data();
+    return neighbors_range(data + offsets[v], data + offsets[v+1]);
+}
+
+template<class ValT, class EdgeT>
+auto csr_graph<ValT, EdgeT>::value(index_type v)const
+    ->const value_type&
+{
+    return m_values[v];
+}
+
+template<class ValT, class EdgeT>
+auto csr_graph<ValT, EdgeT>::edge_value(offset_type offset)const
+    ->const edge_value_type&
+{
+    static const edge_value_type empty{};
+    return m_edge_values.empty()? empty : m_edge_values[offset];
+}
+
+template<class ValT, class EdgeT>
+bool csr_graph<ValT, EdgeT>::is_adjacent(index_type a, index_type b)const{
+    if(m_directed && degree(a) > in_degree(b)){
+        auto row = in_neighbors(b);
+        return std::binary_search(row.begin(), row.end(), a);
+    }
+    if(!m_directed && degree(a) > degree(b)){
+        std::swap(a, b);
+    }
+    auto row = neighbors(a);
+    return std::binary_search(row.begin(), row.end(), b);
+}
+
+template<class ValT, class EdgeT>
+template<class F>
+void csr_graph<ValT, EdgeT>::bfs(index_type source, F &&visit)const{
+    std::vector<bool> visited(node_count());
+    std::vector<index_type> queue;
+    queue.reserve(node_count());
+    queue.emplace_back(source);
+    visited[source] = true;
+    size_t level_end = 1;
+    size_t depth = 0;
+    for(size_t head = 0; head < queue.size(); head++){
+        if(head == level_end){
+            level_end = queue.size();
+            depth++;
+        }
+        auto v = queue[head];
+        visit(v, depth);
+        for(auto u:neighbors(v)){
+            if(!visited[u]){
+                visited[u] = true;
+                queue.emplace_back(u);
+            }
+        }
+    }
+}
+
+template<class ValT, class EdgeT>
+template<class F>
+void csr_graph<ValT, EdgeT>::dfs(index_type source, F &&visit)const{
+    std::vector<bool> visited(node_count());
+    std::vector<std::pair<index_type, offset_type>> stack; // node, next neighbour offset
+    visited[source] = true;
+    visit(source);
+    stack.emplace_back(source, m_offsets[source]);
+    while(!stack.empty()){
+        auto &top = stack.back();
+        auto end = m_offsets[top.first+1];
+        while(top.second < end && visited[m_targets[top.second]]){
+            top.second++;
+        }
+        if(top.second == end){
+            stack.pop_back();
+            continue;
+        }
+        auto u = m_targets[top.second++];
+        visited[u] = true;
+        visit(u);
+        stack.emplace_back(u, m_offsets[u]);
+    }
+}
+
+};
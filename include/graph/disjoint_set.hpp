@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace cxx_graph{
+
+/**
+ * Union-find over elements 0..size()-1, stored in two flat arrays.
+ * Union by rank and path compression give near O(1) amortized find and unite.
+ */
+class disjoint_set{
+public:
+    using index_type = std::uint32_t;
+
+    disjoint_set() = default;
+    explicit disjoint_set(size_t count){ reset(count); }
+
+    /**
+     * Makes "count" single element sets
+     */
+    void reset(size_t count);
+    /**
+     * Adds a new single element set
+     * @return it's element
+     */
+    index_type add();
+    index_type find(index_type x);
+    /**
+     * Merges sets of "a" and "b"
+     * @return false if they were in one set already
+     */
+    bool unite(index_type a, index_type b);
+    bool same(index_type a, index_type b){ return find(a) == find(b); }
+
+    size_t size()const{ return m_parent.size(); }
+    size_t set_count()const{ return m_sets; }
+private:
+    std::vector<index_type> m_parent;
+    std::vector<std::uint8_t> m_rank; // rank never exceeds log2 of size
+    size_t m_sets = 0;
+};
+
+inline void disjoint_set::reset(size_t count){
+    m_parent.resize(count);
+    std::iota(m_parent.begin(), m_parent.end(), index_type(0));
+    m_rank.assign(count, 0);
+    m_sets = count;
+}
+
+inline auto disjoint_set::add()
+    ->index_type
+{
+    auto x = static_cast<index_type>(m_parent.size());
+    m_parent.emplace_back(x);
+    m_rank.emplace_back(0);
+    m_sets++;
+    return x;
+}
+
+inline auto disjoint_set::find(index_type x)
+    ->index_type
+{
+    auto root = x;
+    while(m_parent[root] != root){
+        root = m_parent[root];
+    }
+    // second pass points the whole path to root
+    while(m_parent[x] != root){
+        auto next = m_parent[x];
+        m_parent[x] = root;
+        x = next;
+    }
+    return root;
+}
+
+inline bool disjoint_set::unite(index_type a, index_type b){
+    a = find(a);
+    b = find(b);
+    if(a == b){
+        return false;
+    }
+    if(m_rank[a] < m_rank[b]){
+        std::swap(a, b);
+    }
+    m_parent[b] = a;
+    if(m_rank[a] == m_rank[b]){
+        m_rank[a]++;
+    }
+    m_sets--;
+    return true;
+}
+
+};
@@ -0,0 +1,621 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "graph_file.hpp"
+#include "thread_pool.hpp"
+
+namespace cxx_graph{
+
+/**
+ * Bulk ingestion of edge list files.
+ * Node ids of a file are dense, node count is max id + 1.
+ * Loops and repeated edges, in any direction, are dropped.
+ */
+namespace edge_list{
+
+enum class format{
+    text,  // "u v" per line, rest of a line is ignored, lines starting with # or % are comments
+    binary // pairs of uint32 in native byte order
+};
+
+using key_type = std::uint64_t; // edge (u, v) as u << 32 | v
+
+inline key_type make_key(std::uint32_t u, std::uint32_t v){ return (key_type(u) << 32) | v; }
+inline std::uint32_t key_first(key_type k){ return std::uint32_t(k >> 32); }
+inline std::uint32_t key_second(key_type k){ return std::uint32_t(k); }
+
+/**
+ * Edges of a file, sorted keys with u < v, each edge once
+ */
+struct edges{
+    std::vector<key_type> m_keys;
+    std::uint64_t m_node_count = 0;
+};
+
+/**
+ * LSD radix sort by bytes, O(8n).
+ * Histograms of all bytes are built in one pass, bytes equal in all keys
+ * (high bytes of small ids) take no pass.
+ */
+inline void radix_sort(std::vector<key_type> &keys);
+/**
+ * Radix sort and removal of repeated keys
+ */
+inline void sort_unique(std::vector<key_type> &keys);
+
+/**
+ * Reads whole edge list, mapped file is split into chunks parsed in parallel
+ * @throw std::runtime_error if file can't be read or a line is malformed
+ */
+inline edges read(const std::string &path, format fmt, thread_pool &pool);
+/**
+ * Same as above for a stream, it's read by blocks, each block is parsed in parallel
+ */
+inline edges read(std::istream &in, format fmt, thread_pool &pool);
+
+/**
+ * Builds a graph, e.g. cxx_graph::graph, from an edge list with Graph::from_edges().
+ * Node "i" is node "i" of a file with default value, like in to_csr().
+ * @throw std::runtime_error if file can't be read or is malformed
+ */
+template<class Graph>
+Graph load(const std::string &path, format fmt = format::text);
+template<class Graph>
+Graph load(std::istream &in, format fmt = format::text);
+
+/**
+ * Converts edge list straight into a graph file with bounded memory:
+ * parsed edges are sorted in runs of at most memory_budget/4 bytes, runs go to
+ * temporary files next to graph_path and are merged into CSR, at most 64 runs at once,
+ * more runs take extra merge passes.
+ * Besides the budget only node offsets are kept in memory, 8 bytes per node.
+ * Node values are zero bytes, a file opens as mapped_graph<ValT>.
+ * @throw std::runtime_error on I/O error or a malformed line
+ */
+template<class ValT>
+void convert(const std::string &path, const std::string &graph_path, format fmt,
+    size_t memory_budget = size_t(1) << 30);
+
+namespace detail{
+
+// ids above it don't fit node index_type together with node count
+constexpr std::uint64_t max_id = 0xfffffffeull;
+
+/**
+ * Keys and largest id of a part of a file
+ */
+struct chunk{
+    std::vector<key_type> m_keys;
+    std::uint64_t m_max_id = 0;
+    bool m_seen = false; // any edge, loops included
+    bool m_bad = false;
+};
+
+/**
+ * Parses lines in [begin, end), which ends at a line end or at end of data
+ * @param both_directions emit (u, v) and (v, u) instead of (min, max)
+ */
+inline void parse_text(const char *begin, const char *end, bool both_directions, chunk &out){
+    auto p = begin;
+    auto skip_blank = [&]{
+        while(p != end && (*p == ' ' || *p == '\t' || *p == '\r')){
+            ++p;
+        }
+    };
+    auto number = [&](std::uint64_t &x){
+        if(p == end || *p < '0' || *p > '9'){
+            return false;
+        }
+        x = 0;
+        for(; p != end && *p >= '0' && *p <= '9'; ++p){
+            x = x*10 + std::uint64_t(*p - '0');
+            if(x > max_id){
+                return false;
+            }
+        }
+        return true;
+    };
+    while(p != end){
+        skip_blank();
+        if(p != end && *p != '\n' && *p != '#' && *p != '%'){
+            std::uint64_t u = 0, v = 0;
+            bool ok = number(u);
+            skip_blank();
+            if(!ok || !number(v)){
+                out.m_bad = true;
+                return;
+            }
+            out.m_seen = true;
+            out.m_max_id = std::max(out.m_max_id, std::max(u, v));
+            if(u != v){
+                if(both_directions){
+                    out.m_keys.emplace_back(make_key(std::uint32_t(u), std::uint32_t(v)));
+                    out.m_keys.emplace_back(make_key(std::uint32_t(v), std::uint32_t(u)));
+                }else{
+                    out.m_keys.emplace_back(make_key(std::uint32_t(std::min(u, v)), std::uint32_t(std::max(u, v))));
+                }
+            }
+        }
+        auto line_end = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        p = line_end? line_end + 1 : end;
+    }
+}
+
+inline void parse_binary(const char *begin, const char *end, bool both_directions, chunk &out){
+    // parts are cut at record boundaries, so only the end of a file can have a partial record
+    if(size_t(end - begin) % (2*sizeof(std::uint32_t)) != 0){
+        out.m_bad = true;
+        return;
+    }
+    for(auto p = begin; p + 2*sizeof(std::uint32_t) <= end; p += 2*sizeof(std::uint32_t)){
+        std::uint32_t pair[2];
+        std::memcpy(pair, p, sizeof(pair));
+        auto u = pair[0], v = pair[1];
+        if(u > max_id || v > max_id){
+            out.m_bad = true;
+            return;
+        }
+        out.m_seen = true;
+        out.m_max_id = std::max<std::uint64_t>(out.m_max_id, std::max(u, v));
+        if(u != v){
+            if(both_directions){
+                out.m_keys.emplace_back(make_key(u, v));
+                out.m_keys.emplace_back(make_key(v, u));
+            }else{
+                out.m_keys.emplace_back(make_key(std::min(u, v), std::max(u, v)));
+            }
+        }
+    }
+}
+
+/**
+ * Splits [begin, end) into a part per worker at record boundaries, parses them in parallel
+ * and appends all keys to "out"
+ */
+inline void parse(const char *begin, const char *end, format fmt, bool both_directions,
+    thread_pool &pool, chunk &out)
+{
+    const size_t record = 2*sizeof(std::uint32_t);
+    const auto parts = std::max<size_t>(1, std::min(pool.size(), size_t(end - begin) / (1 << 16)));
+    std::vector<const char*> bounds{begin};
+    for(size_t i=1; i<parts; i++){
+        auto p = begin + size_t(end - begin) * i / parts;
+        if(fmt == format::text){
+            auto line_end = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+            p = line_end? line_end + 1 : end;
+        }else{
+            p = begin + size_t(p - begin) / record * record;
+        }
+        bounds.emplace_back(std::max(p, bounds.back()));
+    }
+    bounds.emplace_back(end);
+    std::vector<chunk> chunks(parts);
+    pool.parallel_for(0, parts, 1, [&](size_t b, size_t e, size_t){
+        for(auto i=b; i<e; i++){
+            if(fmt == format::text){
+                parse_text(bounds[i], bounds[i+1], both_directions, chunks[i]);
+            }else{
+                parse_binary(bounds[i], bounds[i+1], both_directions, chunks[i]);
+            }
+        }
+    });
+    size_t total = out.m_keys.size();
+    for(const auto& c:chunks){
+        total += c.m_keys.size();
+    }
+    if(total > out.m_keys.capacity()){
+        out.m_keys.reserve(std::max(total, out.m_keys.capacity()*2));
+    }
+    for(const auto& c:chunks){
+        out.m_keys.insert(out.m_keys.end(), c.m_keys.begin(), c.m_keys.end());
+        out.m_max_id = std::max(out.m_max_id, c.m_max_id);
+        out.m_seen = out.m_seen || c.m_seen;
+        out.m_bad = out.m_bad || c.m_bad;
+    }
+}
+
+/**
+ * Read-only mapping of a whole file
+ */
+class mapped_file{
+    void* m_map = nullptr;
+    size_t m_size = 0;
+public:
+    explicit mapped_file(const std::string &path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error(path + ": can't open");
+        }
+        struct stat st;
+        if(::fstat(fd, &st) != 0){
+            ::close(fd);
+            throw std::runtime_error(path + ": can't stat");
+        }
+        m_size = size_t(st.st_size);
+        if(m_size){
+            m_map = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if(m_map == MAP_FAILED){
+            m_map = nullptr;
+            throw std::runtime_error(path + ": can't map");
+        }
+        if(m_map){
+            ::madvise(m_map, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file(){
+        if(m_map){
+            ::munmap(m_map, m_size);
+        }
+    }
+    const char* data()const{ return static_cast<const char*>(m_map); }
+    size_t size()const{ return m_size; }
+    /**
+     * Drops pages of [0, size) from the mapping, they are read again on next access
+     */
+    void release(size_t size)const{
+        const auto page = size_t(::sysconf(_SC_PAGESIZE));
+        if(m_map && size >= page){
+            ::madvise(m_map, size / page * page, MADV_DONTNEED);
+        }
+    }
+};
+
+/**
+ * Buffered sequential reader of a run file of sorted keys
+ */
+class run_reader{
+    std::FILE* m_file;
+    std::vector<key_type> m_buffer;
+    size_t m_pos = 0, m_size = 0;
+public:
+    run_reader(std::FILE *file, size_t buffer_keys)
+        :m_file(file), m_buffer(buffer_keys)
+    {}
+    bool next(key_type &key){
+        if(m_pos == m_size){
+            m_size = std::fread(m_buffer.data(), sizeof(key_type), m_buffer.size(), m_file);
+            m_pos = 0;
+            if(m_size == 0){
+                return false;
+            }
+        }
+        key = m_buffer[m_pos++];
+        return true;
+    }
+};
+
+// runs merged at once, open files stay far below the usual descriptor limit
+constexpr size_t merge_fan_in = 64;
+
+/**
+ * k-way merge of run files [first, last) of sorted keys, "emit" gets each key once, in order
+ * @param emit returns false to stop on error
+ * @return false if a run can't be opened or "emit" failed
+ */
+template<class F>
+bool merge_runs(const std::string *first, const std::string *last, size_t buffer_keys, F &&emit){
+    std::vector<std::FILE*> files;
+    std::vector<run_reader> readers;
+    bool ok = true;
+    for(auto p = first; p != last; ++p){
+        files.emplace_back(std::fopen(p->c_str(), "rb"));
+        if(!files.back()){
+            ok = false;
+            break;
+        }
+        readers.emplace_back(files.back(), buffer_keys);
+    }
+    using entry = std::pair<key_type, size_t>;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+    for(size_t i=0; ok && i<readers.size(); i++){
+        key_type k;
+        if(readers[i].next(k)){
+            heap.emplace(k, i);
+        }
+    }
+    bool first_key = true;
+    key_type prev = 0;
+    while(ok && !heap.empty()){
+        auto top = heap.top();
+        heap.pop();
+        key_type k;
+        if(readers[top.second].next(k)){
+            heap.emplace(k, top.second);
+        }
+        if(!first_key && top.first == prev){
+            continue;
+        }
+        first_key = false;
+        prev = top.first;
+        ok = emit(prev);
+    }
+    for(auto f:files){
+        if(f){
+            std::fclose(f);
+        }
+    }
+    return ok;
+}
+
+};
+
+inline void radix_sort(std::vector<key_type> &keys){
+    const auto n = keys.size();
+    if(n < 2){
+        return;
+    }
+    std::vector<size_t> counts(8*256);
+    for(auto k:keys){
+        for(int byte=0; byte<8; byte++){
+            counts[byte*256 + ((k >> (byte*8)) & 0xff)]++;
+        }
+    }
+    std::vector<key_type> buffer(n);
+    for(int byte=0; byte<8; byte++){
+        auto count = counts.data() + byte*256;
+        const auto shift = byte*8;
+        if(count[(keys[0] >> shift) & 0xff] == n){
+            continue;
+        }
+        size_t sum = 0;
+        for(size_t i=0; i<256; i++){
+            auto c = count[i];
+            count[i] = sum;
+            sum += c;
+        }
+        for(auto k:keys){
+            buffer[count[(k >> shift) & 0xff]++] = k;
+        }
+        keys.swap(buffer);
+    }
+}
+
+inline void sort_unique(std::vector<key_type> &keys){
+    radix_sort(keys);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+inline edges read(const std::string &path, format fmt, thread_pool &pool){
+    detail::mapped_file file(path);
+    detail::chunk all;
+    detail::parse(file.data(), file.data() + file.size(), fmt, false, pool, all);
+    if(all.m_bad){
+        throw std::runtime_error(path + ": malformed edge list");
+    }
+    edges result;
+    result.m_keys = std::move(all.m_keys);
+    sort_unique(result.m_keys);
+    result.m_node_count = all.m_seen? all.m_max_id + 1 : 0;
+    return result;
+}
+
+inline edges read(std::istream &in, format fmt, thread_pool &pool){
+    const size_t block = size_t(16) << 20;
+    std::vector<char> buffer;
+    size_t carry = 0; // bytes of an unfinished record from previous block, a line longer than a block grows it
+    detail::chunk all;
+    while(true){
+        buffer.resize(carry + block);
+        in.read(buffer.data() + carry, std::streamsize(block));
+        const auto size = carry + size_t(in.gcount());
+        const bool last = size < carry + block;
+        auto end = buffer.data() + size;
+        if(!last){
+            if(fmt == format::text){
+                for(; end != buffer.data() && end[-1] != '\n'; --end){}
+            }else{
+                end = buffer.data() + size / (2*sizeof(std::uint32_t)) * (2*sizeof(std::uint32_t));
+            }
+        }
+        detail::parse(buffer.data(), end, fmt, false, pool, all);
+        if(all.m_bad){
+            throw std::runtime_error("malformed edge list");
+        }
+        carry = size_t(buffer.data() + size - end);
+        std::memmove(buffer.data(), end, carry);
+        if(last){
+            break;
+        }
+    }
+    if(in.bad()){
+        throw std::runtime_error("can't read edge list");
+    }
+    edges result;
+    result.m_keys = std::move(all.m_keys);
+    sort_unique(result.m_keys);
+    result.m_node_count = all.m_seen? all.m_max_id + 1 : 0;
+    return result;
+}
+
+template<class Graph>
+Graph load(const std::string &path, format fmt){
+    thread_pool pool;
+    auto e = read(path, fmt, pool);
+    return Graph::from_edges(size_t(e.m_node_count), e.m_keys);
+}
+
+template<class Graph>
+Graph load(std::istream &in, format fmt){
+    thread_pool pool;
+    auto e = read(in, fmt, pool);
+    return Graph::from_edges(size_t(e.m_node_count), e.m_keys);
+}
+
+template<class ValT>
+void convert(const std::string &path, const std::string &graph_path, format fmt, size_t memory_budget){
+    static_assert(std::is_trivially_copyable<ValT>::value, "node values are stored as raw bytes");
+    const auto run_bytes = std::max<size_t>(memory_budget / 4, 1 << 16);
+    const auto window = std::max<size_t>(run_bytes / 8, 1 << 12); // text bytes parsed at once
+    thread_pool pool;
+    detail::mapped_file input(path);
+    std::vector<std::string> run_paths;
+    struct cleanup{
+        std::vector<std::string>& m_paths;
+        ~cleanup(){
+            for(const auto& p:m_paths){
+                std::remove(p.c_str());
+            }
+        }
+    } remove_runs{run_paths};
+
+    size_t run_id = 0;
+    auto new_run = [&]{
+        run_paths.emplace_back(graph_path + ".run" + std::to_string(run_id++));
+        return run_paths.back();
+    };
+    // runs of sorted unique adjacencies, both directions of each edge
+    detail::chunk keys;
+    auto flush = [&]{
+        if(keys.m_keys.empty()){
+            return;
+        }
+        sort_unique(keys.m_keys);
+        const auto run_path = new_run();
+        auto file = std::fopen(run_path.c_str(), "wb");
+        bool ok = file && std::fwrite(keys.m_keys.data(), sizeof(key_type), keys.m_keys.size(), file) == keys.m_keys.size();
+        ok = file && (std::fclose(file) == 0) && ok;
+        if(!ok){
+            throw std::runtime_error(run_path + ": write failed");
+        }
+        keys.m_keys.clear();
+    };
+    const char* data = input.data();
+    size_t pos = 0;
+    while(pos < input.size()){
+        auto end = std::min(pos + window, input.size());
+        if(end < input.size()){
+            if(fmt == format::text){
+                auto line_end = static_cast<const char*>(std::memchr(data + end, '\n', input.size() - end));
+                end = line_end? size_t(line_end - data) + 1 : input.size();
+            }else{
+                end = end / (2*sizeof(std::uint32_t)) * (2*sizeof(std::uint32_t));
+            }
+        }
+        detail::parse(data + pos, data + end, fmt, true, pool, keys);
+        if(keys.m_bad){
+            throw std::runtime_error(path + ": malformed edge list");
+        }
+        input.release(end);
+        pos = end;
+        if(keys.m_keys.size() * sizeof(key_type) >= run_bytes){
+            flush();
+        }
+    }
+    flush();
+    keys.m_keys.shrink_to_fit();
+    const std::uint64_t n = keys.m_seen? keys.m_max_id + 1 : 0;
+
+    // too many runs for one merge are merged by merge_fan_in into longer runs first
+    auto buffer_keys = [run_bytes](size_t runs){
+        return std::max<size_t>(run_bytes / sizeof(key_type) / std::max<size_t>(runs, 1), 1 << 12);
+    };
+    while(run_paths.size() > detail::merge_fan_in){
+        const auto run_path = new_run();
+        auto file = std::fopen(run_path.c_str(), "wb");
+        std::vector<key_type> buffer;
+        buffer.reserve(1 << 16);
+        auto write = [&]{
+            bool written = std::fwrite(buffer.data(), sizeof(key_type), buffer.size(), file) == buffer.size();
+            buffer.clear();
+            return written;
+        };
+        bool ok = file && detail::merge_runs(run_paths.data(), run_paths.data() + detail::merge_fan_in,
+            buffer_keys(detail::merge_fan_in), [&](key_type k){
+                buffer.emplace_back(k);
+                return buffer.size() < buffer.capacity() || write();
+            });
+        ok = ok && write();
+        ok = file && (std::fclose(file) == 0) && ok;
+        if(!ok){
+            throw std::runtime_error(run_path + ": write failed");
+        }
+        for(size_t i=0; i<detail::merge_fan_in; i++){
+            std::remove(run_paths[i].c_str());
+        }
+        run_paths.erase(run_paths.begin(), run_paths.begin() + long(detail::merge_fan_in));
+    }
+
+    // k-way merge of runs, adjacencies go straight to targets section
+    auto h = graph_file::make_header(sizeof(ValT), 0, n, 0);
+    const auto tmp_path = graph_path + ".tmp";
+    auto out = std::fopen(tmp_path.c_str(), "w+b");
+    if(!out){
+        throw std::runtime_error(tmp_path + ": can't open for writing");
+    }
+    bool ok = true;
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    std::uint64_t m = 0;
+    {
+        std::vector<std::uint32_t> targets;
+        targets.reserve(1 << 16);
+        auto write = [&]{
+            bool written = std::fwrite(targets.data(), sizeof(std::uint32_t), targets.size(), out) == targets.size();
+            targets.clear();
+            return written;
+        };
+        ok = std::fseek(out, long(h.m_sections[graph_file::targets_section].m_pos), SEEK_SET) == 0;
+        ok = ok && detail::merge_runs(run_paths.data(), run_paths.data() + run_paths.size(),
+            buffer_keys(run_paths.size()), [&](key_type k){
+                offsets[key_first(k) + 1]++;
+                targets.emplace_back(key_second(k));
+                m++;
+                return targets.size() < targets.capacity() || write();
+            });
+        ok = ok && (targets.empty() || write());
+    }
+    for(size_t i=1; i<offsets.size(); i++){
+        offsets[i] += offsets[i-1];
+    }
+
+    // now adjacency count is known, sections before and after targets are written
+    h = graph_file::make_header(sizeof(ValT), 0, n, m);
+    auto write_at = [&](std::uint64_t at, const void *bytes, size_t size){
+        return std::fseek(out, long(at), SEEK_SET) == 0 && (size == 0 || std::fwrite(bytes, 1, size, out) == size);
+    };
+    const auto& values = h.m_sections[graph_file::values_section];
+    const std::vector<char> zeros(1 << 16, 0);
+    for(std::uint64_t written = 0; ok && written < values.m_size; written += zeros.size()){
+        ok = write_at(values.m_pos + written, zeros.data(), size_t(std::min<std::uint64_t>(zeros.size(), values.m_size - written)));
+    }
+    const auto& edge_values = h.m_sections[graph_file::edge_values_section];
+    // file ends at an aligned edge values section even if it's empty
+    ok = ok && write_at(edge_values.m_pos, nullptr, 0) && std::fflush(out) == 0
+        && ::ftruncate(::fileno(out), off_t(edge_values.m_pos)) == 0;
+    ok = ok && write_at(h.m_sections[graph_file::offsets_section].m_pos, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    offsets = std::vector<std::uint64_t>();
+    ok = ok && std::fflush(out) == 0;
+    if(ok){
+        // checksums by a sequential pass over the written file
+        detail::mapped_file written(tmp_path);
+        for(auto& s:h.m_sections){
+            s.m_checksum = graph_file::checksum(written.data() + s.m_pos, s.m_size);
+        }
+        h.m_checksum = graph_file::header_checksum(h);
+        ok = write_at(0, &h, sizeof(h));
+    }
+    ok = (std::fclose(out) == 0) && ok;
+    if(!ok || std::rename(tmp_path.c_str(), graph_path.c_str()) != 0){
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error(graph_path + ": write failed");
+    }
+}
+
+};
+};
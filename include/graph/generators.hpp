@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "edge_list.hpp"
+#include "thread_pool.hpp"
+
+namespace cxx_graph{
+
+/**
+ * Synthetic undirected graphs for tests and benchmarks, as edge lists
+ * of the same shape as edge_list::read() gives: sorted keys with u < v,
+ * no loops, each edge once.
+ * Random generators draw edges in fixed chunks seeded from "seed" and chunk number,
+ * so a result depends on the seed only, not on the pool size.
+ * Loops and repeats are dropped, so random graphs can have a bit less edges than asked.
+ */
+namespace generators{
+
+/**
+ * Quadrant probabilities of R-MAT, the fourth one is 1 - a - b - c
+ */
+struct rmat_params{
+    double m_a = 0.57;
+    double m_b = 0.19;
+    double m_c = 0.19;
+};
+
+/**
+ * R-MAT: each edge picks a quadrant of adjacency matrix "scale" times.
+ * Gives skewed degrees and community structure, hubs get low ids.
+ * @param scale log2 of node count, at most 31: ids go up to edge_list::detail::max_id
+ */
+inline edge_list::edges rmat(unsigned scale, size_t edge_count, thread_pool &pool,
+    const rmat_params &params = rmat_params(), std::uint64_t seed = 1);
+/**
+ * Graph500 Kronecker graph: R-MAT with default params and edge_factor*2^scale edges,
+ * node ids are randomly permuted so hubs are spread over the id space
+ */
+inline edge_list::edges kronecker(unsigned scale, size_t edge_factor, thread_pool &pool,
+    std::uint64_t seed = 1);
+/**
+ * Erdős–Rényi G(n, m): edge_count uniformly random node pairs
+ */
+inline edge_list::edges erdos_renyi(std::uint32_t node_count, size_t edge_count, thread_pool &pool,
+    std::uint64_t seed = 1);
+/**
+ * Chung–Lu graph with power-law expected degrees: node "i" has weight (i+1)^(-1/(exponent-1)),
+ * ends of an edge are drawn proportionally to weight
+ * @param exponent of degree distribution, greater than 2 for finite mean degree
+ */
+inline edge_list::edges power_law(std::uint32_t node_count, size_t edge_count, thread_pool &pool,
+    double exponent = 2.5, std::uint64_t seed = 1);
+/**
+ * 2D grid of width*height nodes with 4-neighbourhood, node of cell (x, y) is y*width+x
+ */
+inline edge_list::edges grid(std::uint32_t width, std::uint32_t height);
+
+namespace detail{
+
+/**
+ * Edges generated by one seeded generator
+ */
+constexpr size_t chunk_size = size_t(1) << 16;
+
+/**
+ * SplitMix64 step, turns seed and chunk number into independent generator seeds
+ */
+inline std::uint64_t mix(std::uint64_t x){
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Uniform double in [0, 1) from top 53 bits
+ */
+inline double unit(std::mt19937_64 &rng){
+    return double(rng() >> 11) * (1.0 / double(std::uint64_t(1) << 53));
+}
+
+/**
+ * Fills edge_count keys in parallel, chunk "i" calls draw(rng) with a generator seeded
+ * by seed and "i", then drops loops and repeats
+ * @param draw functor returning a pair of node ids
+ */
+template<class F>
+edge_list::edges generate(std::uint64_t node_count, size_t edge_count, thread_pool &pool,
+    std::uint64_t seed, F &&draw)
+{
+    edge_list::edges result;
+    result.m_node_count = node_count;
+    result.m_keys.resize(edge_count);
+    auto keys = result.m_keys.data();
+    const size_t chunks = (edge_count + chunk_size - 1) / chunk_size;
+    pool.parallel_for(0, chunks, 1, [&](size_t begin, size_t end, size_t){
+        for(auto c=begin; c<end; c++){
+            std::mt19937_64 rng(mix(seed ^ mix(c)));
+            const auto last = std::min(edge_count, (c + 1) * chunk_size);
+            for(auto i=c*chunk_size; i<last; i++){
+                auto e = draw(rng);
+                keys[i] = edge_list::make_key(std::min(e.first, e.second), std::max(e.first, e.second));
+            }
+        }
+    });
+    auto& all = result.m_keys;
+    all.erase(std::remove_if(all.begin(), all.end(), [](edge_list::key_type k){
+        return edge_list::key_first(k) == edge_list::key_second(k);
+    }), all.end());
+    edge_list::sort_unique(all);
+    return result;
+}
+
+};
+
+inline edge_list::edges rmat(unsigned scale, size_t edge_count, thread_pool &pool,
+    const rmat_params &params, std::uint64_t seed)
+{
+    if(scale > 31){
+        throw std::invalid_argument("rmat scale is above 31");
+    }
+    const double ab = params.m_a + params.m_b, abc = ab + params.m_c;
+    return detail::generate(std::uint64_t(1) << scale, edge_count, pool, seed, [&](std::mt19937_64 &rng){
+        std::uint32_t u = 0, v = 0;
+        for(unsigned bit=0; bit<scale; bit++){
+            auto r = detail::unit(rng);
+            // quadrants: a top left, b top right, c bottom left, d bottom right
+            u = (u << 1) | std::uint32_t(r >= ab);
+            v = (v << 1) | std::uint32_t((r >= params.m_a && r < ab) || r >= abc);
+        }
+        return std::make_pair(u, v);
+    });
+}
+
+inline edge_list::edges kronecker(unsigned scale, size_t edge_factor, thread_pool &pool, std::uint64_t seed){
+    auto result = rmat(scale, edge_factor << scale, pool, rmat_params(), seed);
+    std::vector<std::uint32_t> permutation(size_t(result.m_node_count));
+    std::iota(permutation.begin(), permutation.end(), std::uint32_t(0));
+    std::shuffle(permutation.begin(), permutation.end(), std::mt19937_64(detail::mix(~seed)));
+    for(auto &k:result.m_keys){
+        auto u = permutation[edge_list::key_first(k)], v = permutation[edge_list::key_second(k)];
+        k = edge_list::make_key(std::min(u, v), std::max(u, v));
+    }
+    // permutation keeps edges unique and loop free, only order is lost
+    edge_list::radix_sort(result.m_keys);
+    return result;
+}
+
+inline edge_list::edges erdos_renyi(std::uint32_t node_count, size_t edge_count, thread_pool &pool,
+    std::uint64_t seed)
+{
+    if(node_count < 2){
+        return edge_list::edges{{}, node_count};
+    }
+    return detail::generate(node_count, edge_count, pool, seed, [&](std::mt19937_64 &rng){
+        std::uniform_int_distribution<std::uint32_t> node(0, node_count - 1);
+        return std::make_pair(node(rng), node(rng));
+    });
+}
+
+inline edge_list::edges power_law(std::uint32_t node_count, size_t edge_count, thread_pool &pool,
+    double exponent, std::uint64_t seed)
+{
+    if(exponent <= 1){
+        throw std::invalid_argument("power law exponent must be above 1");
+    }
+    if(node_count < 2){
+        return edge_list::edges{{}, node_count};
+    }
+    // an end is found by binary search of a uniform point in prefix sums of weights
+    std::vector<double> prefix(node_count);
+    double sum = 0;
+    for(std::uint32_t i=0; i<node_count; i++){
+        sum += std::pow(double(i) + 1, -1 / (exponent - 1));
+        prefix[i] = sum;
+    }
+    return detail::generate(node_count, edge_count, pool, seed, [&](std::mt19937_64 &rng){
+        auto pick = [&]{
+            auto it = std::upper_bound(prefix.begin(), prefix.end(), detail::unit(rng) * sum);
+            return std::uint32_t(std::min<size_t>(size_t(it - prefix.begin()), node_count - 1));
+        };
+        auto u = pick();
+        return std::make_pair(u, pick());
+    });
+}
+
+inline edge_list::edges grid(std::uint32_t width, std::uint32_t height){
+    edge_list::edges result;
+    result.m_node_count = std::uint64_t(width) * height;
+    if(result.m_node_count > edge_list::detail::max_id + 1){
+        throw std::invalid_argument("grid has more nodes than node ids");
+    }
+    if(width && height){
+        result.m_keys.reserve(2 * size_t(result.m_node_count) - width - height);
+    }
+    // right neighbour has a smaller id than lower one, so keys come sorted
+    for(std::uint32_t y=0; y<height; y++){
+        for(std::uint32_t x=0; x<width; x++){
+            auto id = y * width + x;
+            if(x + 1 < width){
+                result.m_keys.emplace_back(edge_list::make_key(id, id + 1));
+            }
+            if(y + 1 < height){
+                result.m_keys.emplace_back(edge_list::make_key(id, id + width));
+            }
+        }
+    }
+    return result;
+}
+
+};
+};
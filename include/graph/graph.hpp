@@ -1,23 +1,323 @@
 #pragma once
 #include <vector>
+#include <cstdint>
+#include <type_traits>
 #include <algorithm>
+#include <numeric>
+#include <memory>
+#include <stdexcept>
+#include <limits>
+#include <string>
+#include "csr_graph.hpp"
+#include "disjoint_set.hpp"
+#include "set_intersection.hpp"
+#include "../common/instrument.hpp"
+#include "../common/pmr.hpp"
+#include "../common/stats.hpp"
 
 namespace cxx_graph{
 
-template<class ValT>
+/**
+ * Order in which dfs_iterator visits nodes
+ */
+enum class dfs_order{
+    pre,  // node goes before it's descendants
+    post  // node goes after it's descendants
+};
+
+/**
+ * Node order produced by graph::reorder
+ */
+enum class reorder_policy{
+    rcm,    // reverse Cuthill-McKee: BFS from low degree nodes, reversed, keeps neighbours close
+    degree, // by degree, highest first: hubs share cache lines
+    bfs     // breadth-first order of each component
+};
+
+/**
+ * Whether graph edges have a direction
+ */
+enum class direction{
+    undirected, // edge is in adjacency of both ends
+    directed    // edge is in out adjacency of it's source and in in-adjacency of it's target
+};
+
+/**
+ * How graph keeps adjacency of it's nodes
+ */
+enum class adjacency_mode{
+    unordered, // O(1) edge insertion and removal, is_adjacent is linear in degree
+    sorted,    // sorted by neighbour, O(log deg) is_adjacent, O(deg) edge insertion and removal
+    hashed     // sorted, nodes above degree threshold also keep a hash set of neighbours, O(1) is_adjacent
+};
+
+namespace detail{
+
+/**
+ * Holds edge payload, empty payload takes no space thanks to empty base optimization
+ */
+template<class T, bool = std::is_empty<T>::value>
+struct edge_payload{
+    T m_value{};
+    T& value(){ return m_value; }
+    const T& value()const{ return m_value; }
+};
+
+template<class T>
+struct edge_payload<T, true>:T{
+    T& value(){ return *this; }
+    const T& value()const{ return *this; }
+};
+
+/**
+ * Open addressing hash set of pointers, linear probing,
+ * erase shifts following entries back instead of leaving tombstones
+ */
+template<class T, class Alloc = std::allocator<const T*>>
+class pointer_set{
+    using Slots = std::vector<const T*, Alloc>;
+    Slots m_slots; // nullptr is an empty slot, size is a power of 2
+    size_t m_size = 0;
+
+    size_t p_hash(const T *p)const{
+        auto h = reinterpret_cast<uintptr_t>(p) * uintptr_t(0x9e3779b97f4a7c15ull);
+        return (h >> 16) & (m_slots.size()-1);
+    }
+    void p_grow(){
+        Slots old(std::max<size_t>(16, m_slots.size()*2), nullptr, m_slots.get_allocator());
+        old.swap(m_slots);
+        m_size = 0;
+        for(auto p:old){
+            if(p){
+                insert(p);
+            }
+        }
+    }
+public:
+    explicit pointer_set(const Alloc &alloc = Alloc())
+        :m_slots(alloc)
+    {}
+
+    bool contains(const T *p)const{
+        if(m_slots.empty()){
+            return false;
+        }
+        for(auto i = p_hash(p); m_slots[i]; i = (i+1) & (m_slots.size()-1)){
+            if(m_slots[i] == p){
+                return true;
+            }
+        }
+        return false;
+    }
+    void insert(const T *p){
+        if((m_size+1)*2 > m_slots.size()){
+            p_grow();
+        }
+        auto i = p_hash(p);
+        for(; m_slots[i]; i = (i+1) & (m_slots.size()-1)){
+            if(m_slots[i] == p){
+                return;
+            }
+        }
+        m_slots[i] = p;
+        m_size++;
+    }
+    void erase(const T *p){
+        if(m_slots.empty()){
+            return;
+        }
+        const auto mask = m_slots.size()-1;
+        auto i = p_hash(p);
+        for(; m_slots[i] != p; i = (i+1) & mask){
+            if(!m_slots[i]){
+                return;
+            }
+        }
+        // entries after a hole move into it, unless they'd go before their home slot
+        for(auto j = (i+1) & mask; m_slots[j]; j = (j+1) & mask){
+            auto home = p_hash(m_slots[j]);
+            if(((j - home) & mask) >= ((j - i) & mask)){
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i] = nullptr;
+        m_size--;
+    }
+    size_t size()const{ return m_size; }
+    Alloc get_allocator()const{ return m_slots.get_allocator(); }
+};
+
+/**
+ * Raw storage for nodes: chunks of doubling size and a free list of places.
+ * Places never move, so node pointers stay valid until the node is erased.
+ * Chunks and bookkeeping come from "Alloc", pools that exchange storage
+ * by move or swap must have equal allocators.
+ */
+template<class T, class Alloc = std::allocator<T>>
+class node_pool{
+    using Traits = std::allocator_traits<Alloc>;
+    template<class U>
+    using Vector = std::vector<U, typename Traits::template rebind_alloc<U>>;
+
+    Alloc m_alloc;
+    Vector<std::pair<T*, size_t>> m_chunks; // storage and size of each chunk
+    size_t m_used = 0;                      // places taken in the last chunk
+    size_t m_capacity = 0;
+    Vector<T*> m_free;                      // places of destroyed objects
+public:
+    explicit node_pool(const Alloc &alloc = Alloc())
+        :m_alloc(alloc), m_chunks(alloc), m_free(alloc)
+    {}
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+    node_pool(node_pool &&rhs)
+        :node_pool(rhs.m_alloc)
+    {
+        swap(rhs);
+    }
+    node_pool& operator=(node_pool &&rhs){
+        release();
+        swap(rhs);
+        return *this;
+    }
+    ~node_pool(){ release(); }
+
+    void swap(node_pool &rhs){
+        m_chunks.swap(rhs.m_chunks);
+        std::swap(m_used, rhs.m_used);
+        std::swap(m_capacity, rhs.m_capacity);
+        m_free.swap(rhs.m_free);
+    }
+    /**
+     * Place for one object, freed places are reused first
+     */
+    T* allocate(){
+        if(!m_free.empty()){
+            auto p = m_free.back();
+            m_free.pop_back();
+            return p;
+        }
+        if(m_chunks.empty() || m_used == m_chunks.back().second){
+            auto size = std::max<size_t>(64, m_capacity);
+            m_chunks.emplace_back(Traits::allocate(m_alloc, size), size);
+            m_capacity += size;
+            m_used = 0;
+        }
+        return m_chunks.back().first + m_used++;
+    }
+    /**
+     * "count" places in a row, in a chunk of their own
+     */
+    T* allocate_block(size_t count){
+        m_chunks.emplace_back(Traits::allocate(m_alloc, count), count);
+        m_capacity += count;
+        m_used = count;
+        return m_chunks.back().first;
+    }
+    /**
+     * Returns place of a destroyed object
+     */
+    void deallocate(T *p){ m_free.emplace_back(p); }
+    /**
+     * Takes back a place just given by allocate() whose object wasn't constructed, doesn't throw
+     */
+    void undo_allocate(T *p){
+        if(!m_chunks.empty() && p == m_chunks.back().first + m_used - 1){
+            m_used--;
+        }else{
+            m_free.emplace_back(p); // it was popped from m_free, capacity is there
+        }
+    }
+    /**
+     * Places in all chunks, taken or not
+     */
+    size_t capacity()const{ return m_capacity; }
+    /**
+     * Frees all chunks at once, objects in them must be destroyed already
+     */
+    void release(){
+        for(auto& chunk:m_chunks){
+            Traits::deallocate(m_alloc, chunk.first, chunk.second);
+        }
+        m_chunks.clear();
+        m_free.clear();
+        m_used = m_capacity = 0;
+    }
+};
+
+};
+
+/**
+ * Generational handle of a graph node.
+ * Stays valid across reorder, copy and erase of other nodes,
+ * a handle of an erased node is detected as stale.
+ */
+struct node_handle{
+    uint32_t m_index = ~uint32_t(0);
+    uint32_t m_generation = 0;
+
+    friend bool operator==(const node_handle &lhs, const node_handle &rhs){
+        return lhs.m_index == rhs.m_index && lhs.m_generation == rhs.m_generation;
+    }
+    friend bool operator!=(const node_handle &lhs, const node_handle &rhs){
+        return !(lhs == rhs);
+    }
+};
+
+/**
+ * Undirected or directed graph of pooled nodes, addressed by iterators or generational handles
+ * @tparam ValT node value
+ * @tparam EdgeT edge payload, e.g. weight
+ * @tparam Allocator source of nodes, edge arena, adjacency arrays and hash sets, rebound to each.
+ *      It's fixed at construction and never propagates, move from a graph
+ *      with unequal allocator copies it.
+ */
+template<class ValT, class EdgeT = no_payload, class Allocator = std::allocator<ValT>>
 class graph{
+    template<class U>
+    using rebind_t = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+    template<class U>
+    using vector_t = std::vector<U, rebind_t<U>>;
 public:
     using value_type = ValT;
+    using edge_value_type = EdgeT;
+    using allocator_type = Allocator;
+    using edge_id = uint32_t; // stable until the edge is removed, freed ids are reused
     struct node;
     struct edge;
 
-    struct edge{
-        node* m_first=nullptr, * m_second=nullptr;
+    /**
+     * Edges live in graph's arena, addressed by edge_id.
+     * Each end keeps position of it's adjacency entry, so edge removal
+     * is a swap-remove in both adjacency arrays.
+     * Directed edge goes from m_first to m_second, it's second slot is in m_second's in-adjacency.
+     */
+    struct edge:detail::edge_payload<edge_value_type>{
+        node* m_first=nullptr, * m_second=nullptr; // nullptr for a free slot
+        uint32_t m_first_slot=0, m_second_slot=0;  // positions in m_first/m_second adjacency
+    };
+    struct adjacency{
+        node* m_node;   // other end
+        edge_id m_edge;
+    };
+    using hashed_set = detail::pointer_set<node, rebind_t<const node*>>;
+    /**
+     * Frees hash set of a node with allocator the set holds
+     */
+    struct hashed_deleter{
+        void operator()(hashed_set *set)const;
     };
     struct node{
-        using Edges = std::vector<edge*>;
-        Edges m_edges={};
+        using Edges = vector_t<adjacency>;
+        Edges m_edges;
         value_type m_value;
+        size_t m_index=0; // position in graph::m_nodes
+        uint32_t m_handle=0; // index in graph::m_handles
+        bool m_sorted=false; // m_edges are ordered by (m_node, m_edge)
+        std::unique_ptr<hashed_set, hashed_deleter> m_hashed; // neighbours of a high degree node
+        Edges m_in_edges;     // directed graph only, sources of incoming edges, unordered
+        bool m_directed=false;// m_edges holds outgoing edges only
     };
 
     class iterator_base{
@@ -32,27 +332,67 @@ public:
         friend bool operator==(const iterator_base& lhs, const iterator_base& rhs){
             return lhs.m_node == rhs.m_node;
         }
+        friend bool operator!=(const iterator_base& lhs, const iterator_base& rhs){
+            return lhs.m_node != rhs.m_node;
+        }
     };
 
+    /**
+     * Breadth-first iterator, O(V+E) for a whole traversal.
+     * Traversal state is shared between copies of an iterator:
+     * visit order doubles as a queue, nodes are marked in a visited bitmap
+     * by their index, so a step neither allocates nor searches.
+     * Reaching the end of a component gives end().
+     */
     class bfs_iterator:public iterator_base{
         using Nodes = std::vector<node*>;
-        Nodes m_nodes;
+        struct state{
+            Nodes m_order;              // visit order, nodes after m_expanded are a queue
+            std::vector<bool> m_visited;// by node::m_index
+            size_t m_expanded=0;        // count of nodes whose neighbours are queued
+            void visit(node *n);
+            void expand(node *n);
+        };
+        std::shared_ptr<state> m_state;
         size_t m_nodes_idx;
     public:
         bfs_iterator(node *n);
         bfs_iterator(const bfs_iterator &it);
         bfs_iterator(bfs_iterator &&it);
+        bfs_iterator& operator=(const bfs_iterator &it);
         bfs_iterator& operator++();
         bfs_iterator operator++(int);
         bfs_iterator& operator--();
         bfs_iterator operator--(int);
     };
 
+    /**
+     * Depth-first iterator, pre-order or post-order.
+     * Uses an explicit stack of (node, next edge) frames and a visited bitmap,
+     * doesn't recurse. Like bfs_iterator, traversal state is shared
+     * between copies, so copying is cheap.
+     * Reaching the end of a component gives end().
+     */
     class dfs_iterator:public iterator_base{
-        std::vector<node*> m_nodes;
+        using Nodes = std::vector<node*>;
+        struct frame{
+            node* m_node;
+            size_t m_edge; // next edge of m_node to check
+        };
+        struct state{
+            Nodes m_order;               // visit order
+            std::vector<frame> m_stack;
+            std::vector<bool> m_visited; // by node::m_index
+            dfs_order m_mode;
+            void push(node *n);
+            bool step();                 // visits one more node, false if traversal ended
+        };
+        std::shared_ptr<state> m_state;
+        size_t m_nodes_idx;
+        dfs_order m_mode;
     public:
-        dfs_iterator(node *n);
-        dfs_iterator(const iterator_base &it);
+        dfs_iterator(node *n, dfs_order order = dfs_order::pre);
+        dfs_iterator(const iterator_base &it, dfs_order order = dfs_order::pre);
         dfs_iterator& operator++();
         dfs_iterator operator++(int);
         dfs_iterator& operator--();
@@ -62,203 +402,831 @@ public:
     using default_it = bfs_iterator;
 public:
     graph();
+    explicit graph(const Allocator &alloc);
+    /**
+     * Directed graph connects, traverses and converts to CSR along outgoing edges
+     */
+    explicit graph(direction dir, const Allocator &alloc = Allocator());
+    /**
+     * Deep copy in O(V+E): nodes are allocated in one block,
+     * pointers are remapped by node index.
+     * Allocator is select_on_container_copy_construction of rhs allocator
+     */
     graph(const graph &rhs);
+    graph(const graph &rhs, const Allocator &alloc);
+    /**
+     * Takes over nodes and edges of rhs in O(1), rhs is left empty
+     */
     graph(graph &&rhs);
+    /**
+     * O(1) if allocators are equal, copy otherwise
+     */
+    graph(graph &&rhs, const Allocator &alloc);
     ~graph();
+    graph& operator=(const graph &rhs);
+    /**
+     * O(V+E) to free current nodes, plus a copy if allocators are unequal
+     */
+    graph& operator=(graph &&rhs);
+
+    allocator_type get_allocator()const{ return m_alloc; }
+
+    /**
+     * Removes all nodes and edges in O(V+E), adjacency mode and component tracking stay
+     */
+    void clear();
 
 
     template<class Arg>
     default_it insert(Arg &&val);
 
+    /**
+     * Inserts a node connected to "it"
+     * @param edge_val payload of a new edge
+     */
     template<class Arg>
-    default_it add_adjacent(iterator_base &it, Arg &&val);
+    default_it add_adjacent(iterator_base &it, Arg &&val,
+        const edge_value_type &edge_val = edge_value_type());
 
+    /**
+     * Removes node and all it's edges, O(degree)
+     */
     void erase(iterator_base &it);
 
+    /**
+     * Adds an edge between two existing nodes
+     * @return id of a new edge
+     */
+    edge_id connect(iterator_base &one, iterator_base &two,
+        const edge_value_type &edge_val = edge_value_type());
+    /**
+     * Removes an edge in O(1)
+     * @throw std::out_of_range if there is no edge with such id
+     */
+    void disconnect(edge_id id);
+    /**
+     * @throw std::out_of_range if there is no edge with such id
+     */
+    edge_value_type& edge_value(edge_id id);
+    const edge_value_type& edge_value(edge_id id)const;
+
+    /**
+     * @return iterator to first inserted node, end() for empty graph
+     */
+    default_it begin()const;
+    default_it end()const;
+
     template<class NodeIt>
     static std::vector<NodeIt> get_adjacent(NodeIt node_it);
 
+    /**
+     * Sources of edges coming to a node, empty for an undirected graph
+     */
+    template<class NodeIt>
+    static std::vector<NodeIt> get_incoming(NodeIt node_it);
+
+    /**
+     * O(1) for a hashed node, O(log deg) for sorted ones, O(min deg) otherwise.
+     * In a directed graph checks for an edge from first node to second one.
+     */
     template<class NodeIt>
     static bool is_adjacent(NodeIt node_one_it, NodeIt node_two_it);
+    /**
+     * Nodes adjacent to both, each one once. Common successors in a directed graph.
+     * Sorted adjacencies are merged or galloped, O(deg_a + deg_b) at most
+     */
+    template<class NodeIt>
+    static std::vector<NodeIt> common_neighbors(NodeIt node_one_it, NodeIt node_two_it);
+
+    /**
+     * Switches adjacency mode, O(E log deg) for sorted modes
+     * @param hash_threshold degree from which a node gets a hash set in hashed mode
+     */
+    void set_adjacency_mode(adjacency_mode mode, size_t hash_threshold = 64);
+    adjacency_mode get_adjacency_mode()const;
+
+    size_t size()const;
+    size_t edge_count()const;
+    bool is_directed()const{ return m_directed; }
+    /**
+     * Memory footprint in O(1). Node bytes are node pool, handle and edge arenas
+     * and adjacency entries counted by size, hash sets of hashed mode are left out.
+     * Allocation counters are filled if Allocator is cont::counting_allocator, they see everything.
+     */
+    cont::container_stats stats()const;
+
+    /**
+     * Turns on tracking of connected components, builds union-find in O(V+E).
+     * insert, add_adjacent and connect update it in near O(1),
+     * erase and disconnect mark it stale, it's rebuilt by next query.
+     */
+    void enable_components();
+    /**
+     * Turns off tracking of connected components, drops union-find
+     */
+    void disable_components();
+    /**
+     * @return whether connected components are tracked
+     */
+    bool components_tracked()const;
+    /**
+     * Near O(1) with tracked components, O(V+E) otherwise.
+     * Non-const: compresses union-find paths and rebuilds it when stale
+     */
+    bool connected(const iterator_base &one, const iterator_base &two);
+    /**
+     * Near O(1) with tracked components, O(V+E) otherwise.
+     * Non-const: rebuilds union-find when stale
+     */
+    size_t component_count();
+
+    /**
+     * Moves nodes into one contiguous block in an order given by a policy,
+     * so neighbours end up close in memory. Node indices, thus to_csr() order,
+     * follow the new order. Invalidates iterators, edge ids stay valid.
+     * @return permutation, element "i" is a new index of node that had index "i"
+     */
+    std::vector<size_t> reorder(reorder_policy policy);
+    /**
+     * Builds immutable compressed sparse row copy of a graph.
+     * Node "i" of a result is i-th node in insertion order,
+     * it stays so until nodes are erased. Edge payloads are copied.
+     * Rows of a directed graph hold outgoing edges, in-rows incoming ones.
+     */
+    csr_graph<value_type, edge_value_type> to_csr()const;
+    /**
+     * Builds undirected graph of "node_count" nodes with default values, node "i" is i-th in to_csr().
+     * Nodes and adjacencies are allocated at once, O(V+E).
+     * File I/O is kept out of this header: see edge_list::load() in edge_list.hpp
+     * and save_graph() and load_mmap() in graph_file.hpp.
+     * @param keys edges (u, v) as u << 32 | v, each edge once, as edge_list::read() gives them
+     * @throw std::length_error if there are more edges than edge_id holds
+     * @throw std::out_of_range if an end of an edge isn't below node_count
+     * @throw std::invalid_argument on a loop edge (u, u)
+     */
+    static graph from_edges(size_t node_count, const std::vector<std::uint64_t> &keys,
+        const Allocator &alloc = Allocator());
+
+    /**
+     * Handle of a node, valid until the node is erased
+     */
+    node_handle handle(const iterator_base &it)const;
+    /**
+     * @return iterator to node of "h", end() if it's stale
+     */
+    default_it find(node_handle h)const;
+    bool contains(node_handle h)const;
 private:
-    std::vector<node*> m_nodes;
+    struct handle_slot{
+        node* m_node;          // nullptr if slot is free
+        uint32_t m_generation; // incremented when node is erased
+    };
+
+    using pool_type = detail::node_pool<node, rebind_t<node>>;
+
+    Allocator m_alloc;
+    vector_t<node*> m_nodes{rebind_t<node*>(m_alloc)}; // live nodes, dense
+    pool_type m_pool{rebind_t<node>(m_alloc)};
+    vector_t<handle_slot> m_handles{rebind_t<handle_slot>(m_alloc)};
+    vector_t<uint32_t> m_free_handles{rebind_t<uint32_t>(m_alloc)};
+    vector_t<edge> m_edges{rebind_t<edge>(m_alloc)};             // edge arena, indexed by edge_id
+    vector_t<edge_id> m_free_edges{rebind_t<edge_id>(m_alloc)};  // free slots of m_edges
+    bool m_components_tracked = false;
+    bool m_components_stale = false;   // union-find lost an edge or node indices changed
+    disjoint_set m_components;         // by node::m_index
+    adjacency_mode m_adjacency_mode = adjacency_mode::unordered;
+    size_t m_hash_threshold = 64;
+    bool m_directed = false;
+
+    edge_id p_make_edge(node *one, node *two, const edge_value_type &edge_val);
+    void p_check_edge(edge_id id)const;
+    void p_unlink(node *n, uint32_t slot);
+    void p_link(node *n, node *other, edge_id id, uint32_t &slot);
+    void p_move_slot(node *n, uint32_t from, uint32_t to);
+    void p_unlink_in(node *n, uint32_t slot);
+    void p_apply_adjacency_mode(node *n);
+    void p_build_components(disjoint_set &set)const;
+    disjoint_set& p_components();
+    template<class Arg>
+    node* p_new_node(Arg &&val);
+    typename node::Edges p_new_edges()const;
+    typename node::Edges p_copy_edges(const typename node::Edges &edges)const;
+    std::unique_ptr<hashed_set, hashed_deleter> p_new_hashed()const;
+    void p_free_node(node *n);
+    void p_clone(const graph &rhs);
+    void p_build(size_t node_count, const std::vector<std::uint64_t> &keys);
+    void p_steal(graph &rhs);
+    std::vector<size_t> p_order(reorder_policy policy)const;
 };
 
-template<class ValT>
-graph<ValT>::iterator_base::iterator_base(node *n){
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::iterator_base::iterator_base(node *n){
     this->m_node = n;
 }
 
-template<class ValT>
-graph<ValT>::iterator_base::iterator_base(const iterator_base &it)
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::iterator_base::iterator_base(const iterator_base &it)
     :iterator_base(it.m_node)
 {}
 
-template<class ValT>
-auto graph<ValT>::iterator_base::operator*()const
-    ->const typename graph<ValT>::value_type& 
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::iterator_base::operator*()const
+    ->const typename graph<ValT, EdgeT, Allocator>::value_type& 
 {
     return m_node->m_value;
 }
 
-template<class ValT>
-auto graph<ValT>::iterator_base::operator*()
-    ->typename graph<ValT>::value_type& 
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::iterator_base::operator*()
+    ->typename graph<ValT, EdgeT, Allocator>::value_type& 
 {
     return m_node->m_value;
 }
 
-template<class ValT>
-graph<ValT>::bfs_iterator::bfs_iterator(node *n)
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::bfs_iterator::state::visit(node *n){
+    auto index = n->m_index;
+    if(index >= m_visited.size()){
+        CONT_INSTRUMENT_GROWS(m_visited, std::max(index+1, m_visited.size()*2));
+        m_visited.resize(std::max(index+1, m_visited.size()*2));
+    }
+    m_visited[index] = true;
+    CONT_INSTRUMENT_GROWS(m_order, m_order.size()+1);
+    m_order.emplace_back(n);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::bfs_iterator::state::expand(node *n){
+    CONT_INSTRUMENT_VISIT(1 + n->m_edges.size());
+    for(const auto& adj:n->m_edges){
+        auto other_end = adj.m_node;
+        auto index = other_end->m_index;
+        if(index >= m_visited.size() || !m_visited[index]){
+            visit(other_end);
+        }
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::bfs_iterator::bfs_iterator(node *n)
     :iterator_base(n)
 {
-    this->m_nodes.emplace_back(n);
+    // state is created by first increment, so end() and
+    // iterators returned from insert don't allocate
     this->m_nodes_idx = 0;
 }
-template<class ValT>
-graph<ValT>::bfs_iterator::bfs_iterator(const bfs_iterator &it)
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::bfs_iterator::bfs_iterator(const bfs_iterator &it)
     :iterator_base(it.m_node)
 {
-    this->m_nodes = it.m_nodes;
+    this->m_state = it.m_state;
     this->m_nodes_idx = it.m_nodes_idx;
 }
-template<class ValT>
-graph<ValT>::bfs_iterator::bfs_iterator(bfs_iterator &&it)
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::bfs_iterator::bfs_iterator(bfs_iterator &&it)
     :iterator_base(it)
 {
-    this->m_nodes = std::move(it.m_nodes);
+    this->m_state = std::move(it.m_state);
     this->m_nodes_idx = std::move(it.m_nodes_idx);
 }
 
-template<class ValT>
-auto graph<ValT>::bfs_iterator::operator++()
-    ->typename graph<ValT>::bfs_iterator& 
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::bfs_iterator::operator=(const bfs_iterator &it)
+    ->typename graph<ValT, EdgeT, Allocator>::bfs_iterator&
 {
-    const node* node = *(m_nodes.begin()+m_nodes_idx);
-    const auto& edges = node->m_edges;
-    auto other_nodes_it = get_adjacent(*this);
-    std::vector<struct node*> other_nodes_ptr;
-    other_nodes_ptr.reserve(other_nodes_it.size());
-    std::transform(other_nodes_it.begin(), other_nodes_it.end(), std::back_inserter(other_nodes_ptr), 
-        [](auto &&node_it){ return node_it.m_node; });
-    m_nodes.reserve(m_nodes.size()+other_nodes_ptr.size());
-    std::copy_if(other_nodes_ptr.begin(), other_nodes_ptr.end(), std::back_inserter(m_nodes),
-        [this](auto &&node_ptr){
-            return std::find(this->m_nodes.begin(), this->m_nodes.end(), node_ptr) == m_nodes.end();
-        });
-    this->m_nodes_idx++;
-    this->m_node = *(m_nodes.begin()+m_nodes_idx);
+    this->m_node = it.m_node;
+    this->m_state = it.m_state;
+    this->m_nodes_idx = it.m_nodes_idx;
     return *this;
 }
 
-template<class ValT>
-auto graph<ValT>::bfs_iterator::operator++(int)
-    ->typename graph<ValT>::bfs_iterator
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::bfs_iterator::operator++()
+    ->typename graph<ValT, EdgeT, Allocator>::bfs_iterator& 
+{
+    CONT_INSTRUMENT_OP(graph_bfs_next);
+    if(!m_state){
+        if(!this->m_node){
+            return *this;
+        }
+        m_state = std::make_shared<state>();
+        CONT_INSTRUMENT_ALLOC();
+        m_state->visit(this->m_node);
+    }
+    auto& st = *m_state;
+    auto next_idx = m_nodes_idx+1;
+    // order is deterministic, so copies can share it: expand only nodes
+    // which weren't expanded by any copy yet
+    while(st.m_order.size() <= next_idx && st.m_expanded < st.m_order.size()){
+        st.expand(st.m_order[st.m_expanded++]);
+    }
+    CONT_INSTRUMENT_QUEUE(st.m_order.size() - st.m_expanded);
+    this->m_nodes_idx = std::min(next_idx, st.m_order.size());
+    this->m_node = (m_nodes_idx < st.m_order.size())? st.m_order[m_nodes_idx] : nullptr;
+    return *this;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::bfs_iterator::operator++(int)
+    ->typename graph<ValT, EdgeT, Allocator>::bfs_iterator
 {
     auto copy = *this;
     ++(*this);
     return copy;
 }
 
-template<class ValT>
-auto graph<ValT>::bfs_iterator::operator--()
-    ->typename graph<ValT>::bfs_iterator&
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::bfs_iterator::operator--()
+    ->typename graph<ValT, EdgeT, Allocator>::bfs_iterator&
 {
+    if(!m_state || m_nodes_idx == 0 || m_nodes_idx > m_state->m_order.size()){
+        throw std::out_of_range("empty iterator decremented");
+    }
     m_nodes_idx--;
-    if(m_nodes_idx >= m_nodes.size()){
+    this->m_node = m_state->m_order[m_nodes_idx];
+    return *this;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::bfs_iterator::operator--(int)
+    ->typename graph<ValT, EdgeT, Allocator>::bfs_iterator
+{
+    auto copy = *this;
+    --(*this);
+    return copy;
+}
+
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::dfs_iterator::state::push(node *n){
+    auto index = n->m_index;
+    if(index >= m_visited.size()){
+        CONT_INSTRUMENT_GROWS(m_visited, std::max(index+1, m_visited.size()*2));
+        m_visited.resize(std::max(index+1, m_visited.size()*2));
+    }
+    m_visited[index] = true;
+    CONT_INSTRUMENT_GROWS(m_stack, m_stack.size()+1);
+    m_stack.push_back(frame{n, 0});
+    if(m_mode == dfs_order::pre){
+        CONT_INSTRUMENT_GROWS(m_order, m_order.size()+1);
+        m_order.emplace_back(n);
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+bool graph<ValT, EdgeT, Allocator>::dfs_iterator::state::step(){
+    while(!m_stack.empty()){
+        auto& top = m_stack.back();
+        const auto& edges = top.m_node->m_edges;
+        bool pushed = false;
+        while(top.m_edge < edges.size()){
+            CONT_INSTRUMENT_VISIT(1);
+            auto other_end = edges[top.m_edge++].m_node;
+            auto index = other_end->m_index;
+            if(index >= m_visited.size() || !m_visited[index]){
+                push(other_end); // invalidates "top"
+                pushed = true;
+                break;
+            }
+        }
+        if(pushed){
+            if(m_mode == dfs_order::pre){
+                return true;
+            }
+            continue;
+        }
+        auto done = top.m_node;
+        m_stack.pop_back();
+        if(m_mode == dfs_order::post){
+            CONT_INSTRUMENT_GROWS(m_order, m_order.size()+1);
+            m_order.emplace_back(done);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::dfs_iterator::dfs_iterator(node *n, dfs_order order)
+    :iterator_base(n)
+    ,m_nodes_idx(0)
+    ,m_mode(order)
+{
+    // pre-order starts from "n" itself, so state is created by first increment.
+    // post-order starts from the deepest node, it has to be found right away
+    if(n && order == dfs_order::post){
+        m_state = std::make_shared<state>();
+        m_state->m_mode = order;
+        m_state->push(n);
+        m_state->step();
+        this->m_node = m_state->m_order.front();
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::dfs_iterator::dfs_iterator(const iterator_base &it, dfs_order order)
+    :dfs_iterator(it.m_node, order)
+{}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::dfs_iterator::operator++()
+    ->typename graph<ValT, EdgeT, Allocator>::dfs_iterator&
+{
+    CONT_INSTRUMENT_OP(graph_dfs_next);
+    if(!m_state){
+        if(!this->m_node){
+            return *this;
+        }
+        m_state = std::make_shared<state>();
+        CONT_INSTRUMENT_ALLOC();
+        m_state->m_mode = m_mode;
+        m_state->push(this->m_node);
+    }
+    auto& st = *m_state;
+    auto next_idx = m_nodes_idx+1;
+    while(st.m_order.size() <= next_idx && st.step()){
+    }
+    CONT_INSTRUMENT_QUEUE(st.m_stack.size());
+    this->m_nodes_idx = std::min(next_idx, st.m_order.size());
+    this->m_node = (m_nodes_idx < st.m_order.size())? st.m_order[m_nodes_idx] : nullptr;
+    return *this;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::dfs_iterator::operator++(int)
+    ->typename graph<ValT, EdgeT, Allocator>::dfs_iterator
+{
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::dfs_iterator::operator--()
+    ->typename graph<ValT, EdgeT, Allocator>::dfs_iterator&
+{
+    if(!m_state || m_nodes_idx == 0 || m_nodes_idx > m_state->m_order.size()){
         throw std::out_of_range("empty iterator decremented");
     }
-    this->m_node = *(m_nodes.begin()+m_nodes_idx);
+    m_nodes_idx--;
+    this->m_node = m_state->m_order[m_nodes_idx];
     return *this;
 }
 
-template<class ValT>
-auto graph<ValT>::bfs_iterator::operator--(int)
-    ->typename graph<ValT>::bfs_iterator
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::dfs_iterator::operator--(int)
+    ->typename graph<ValT, EdgeT, Allocator>::dfs_iterator
 {
     auto copy = *this;
     --(*this);
     return copy;
 }
 
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph()
+    :graph(Allocator())
+{}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(const Allocator &alloc)
+    :m_alloc(alloc)
+{}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(direction dir, const Allocator &alloc)
+    :m_alloc(alloc), m_directed(dir == direction::directed)
+{}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(const graph &rhs)
+    :graph(rhs, std::allocator_traits<Allocator>::select_on_container_copy_construction(rhs.m_alloc))
+{}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(const graph &rhs, const Allocator &alloc)
+    :m_alloc(alloc)
+{
+    p_clone(rhs);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(graph &&rhs)
+    :m_alloc(rhs.m_alloc)
+{
+    p_steal(rhs);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::graph(graph &&rhs, const Allocator &alloc)
+    :m_alloc(alloc)
+{
+    *this = std::move(rhs);
+}
 
-template<class ValT>
-graph<ValT>::graph(){
+template<class ValT, class EdgeT, class Allocator>
+graph<ValT, EdgeT, Allocator>::~graph(){
+    clear();
 }
 
-template<class ValT>
-graph<ValT>::graph(const graph &rhs){
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::operator=(const graph &rhs)
+    ->graph<ValT, EdgeT, Allocator>&
+{
+    if(this != &rhs){
+        clear();
+        p_clone(rhs);
+    }
+    return *this;
 }
 
-template<class ValT>
-graph<ValT>::graph(graph &&rhs){
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::operator=(graph &&rhs)
+    ->graph<ValT, EdgeT, Allocator>&
+{
+    if(this == &rhs){
+        return *this;
+    }
+    clear();
+    if(m_alloc == rhs.m_alloc){
+        p_steal(rhs);
+    }else{
+        // nodes of rhs can't be freed with our allocator
+        p_clone(rhs);
+        rhs.clear();
+    }
+    return *this;
 }
 
-template<class ValT>
-graph<ValT>::~graph(){
-    auto node_it = m_nodes.begin();
-    while (node_it != m_nodes.end()) {
-        auto& node = *node_it;
-        auto node_it_graph = iterator_base(node);
-        erase(node_it_graph);
-        node_it++;
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::clear(){
+    // edges live in arena, no need to unlink them one by one,
+    // places of nodes are not reused either, whole pool goes at once
+    for(auto node:m_nodes){
+        auto& slot = m_handles[node->m_handle];
+        slot.m_node = nullptr;
+        slot.m_generation++;
+        m_free_handles.emplace_back(node->m_handle);
+        node->~node();
+    }
+    m_pool.release();
+    m_nodes.clear();
+    m_edges.clear();
+    m_free_edges.clear();
+    if(m_components_tracked){
+        m_components.reset(0);
+        m_components_stale = false;
     }
 }
 
-template<class ValT>
+template<class ValT, class EdgeT, class Allocator>
 template<class Arg>
-auto graph<ValT>::insert(Arg &&val)
-    ->typename graph<ValT>::default_it
+auto graph<ValT, EdgeT, Allocator>::insert(Arg &&val)
+    ->typename graph<ValT, EdgeT, Allocator>::default_it
 {
-    auto new_node = new struct node();
-    new_node->m_value = std::forward<Arg>(std::move(val));
-    m_nodes.emplace_back(new_node);
-    return typename graph<ValT>::default_it(new_node);
+    return typename graph<ValT, EdgeT, Allocator>::default_it(p_new_node(std::forward<Arg>(val)));
 }
 
-template<class ValT>
+template<class ValT, class EdgeT, class Allocator>
 template<class Arg>
-auto graph<ValT>::add_adjacent(iterator_base &it, Arg &&val)
-    ->typename graph<ValT>::default_it
+auto graph<ValT, EdgeT, Allocator>::add_adjacent(iterator_base &it, Arg &&val,
+    const edge_value_type &edge_val)
+    ->typename graph<ValT, EdgeT, Allocator>::default_it
 {
     auto& node = it.m_node;
-    auto new_node = new struct node();
-    new_node->m_value = std::forward<Arg>(std::move(val));
-    auto edge = new struct edge();
-    edge->m_first = node;
-    edge->m_second = new_node;
-    new_node->m_edges.emplace_back(edge);
-    node->m_edges.emplace_back(edge);
-    return typename graph<ValT>::default_it(new_node);
-}
-
-template<class ValT>
-void graph<ValT>::erase(iterator_base &it){
+    auto new_node = p_new_node(std::forward<Arg>(val));
+    p_make_edge(node, new_node, edge_val);
+    return typename graph<ValT, EdgeT, Allocator>::default_it(new_node);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::erase(iterator_base &it){
     auto& node = it.m_node;
     auto& edges = node->m_edges;
-    auto edges_it = edges.begin();
-    while(edges_it != edges.end()){
-        auto& edge = *edges_it;
-        auto& other_end = (edge->m_first == node)?
-            edge->m_second : edge->m_first;
-        auto& other_end_edges = other_end->m_edges;
-        auto other_end_edge_it = other_end_edges.begin();
-        while(other_end_edge_it != other_end_edges.end()){
-            auto& other_end_edge = *other_end_edge_it;
-            if(other_end_edge == edge){
-                other_end_edge_it = other_end_edges.erase(other_end_edge_it);
-                break;
+    while(!edges.empty()){
+        disconnect(edges.back().m_edge);
+    }
+    while(!node->m_in_edges.empty()){
+        disconnect(node->m_in_edges.back().m_edge);
+    }
+    // keep m_nodes dense: last node takes place of erased one
+    m_components_stale = true;
+    auto index = node->m_index;
+    m_nodes[index] = m_nodes.back();
+    m_nodes[index]->m_index = index;
+    m_nodes.pop_back();
+    p_free_node(node);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::connect(iterator_base &one, iterator_base &two,
+    const edge_value_type &edge_val)
+    ->typename graph<ValT, EdgeT, Allocator>::edge_id
+{
+    return p_make_edge(one.m_node, two.m_node, edge_val);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_check_edge(edge_id id)const{
+    if(id >= m_edges.size() || !m_edges[id].m_first){
+        throw std::out_of_range("no such edge");
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::edge_value(edge_id id)
+    ->typename graph<ValT, EdgeT, Allocator>::edge_value_type&
+{
+    p_check_edge(id);
+    return m_edges[id].value();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::edge_value(edge_id id)const
+    ->const typename graph<ValT, EdgeT, Allocator>::edge_value_type&
+{
+    p_check_edge(id);
+    return m_edges[id].value();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::disconnect(edge_id id){
+    p_check_edge(id);
+    auto& e = m_edges[id];
+    p_unlink(e.m_first, e.m_first_slot);
+    if(m_directed){
+        p_unlink_in(e.m_second, e.m_second_slot);
+    }else{
+        // for a loop first unlink could move second entry, it's slot is updated then
+        p_unlink(e.m_second, e.m_second_slot);
+    }
+    e = edge();
+    m_free_edges.emplace_back(id);
+    // union-find can't split sets
+    m_components_stale = true;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::p_make_edge(node *one, node *two, const edge_value_type &edge_val)
+    ->typename graph<ValT, EdgeT, Allocator>::edge_id
+{
+    edge_id id;
+    if(!m_free_edges.empty()){
+        id = m_free_edges.back();
+        m_free_edges.pop_back();
+    }else{
+        id = static_cast<edge_id>(m_edges.size());
+        m_edges.emplace_back();
+    }
+    auto& e = m_edges[id];
+    e.value() = edge_val;
+    e.m_first = one;
+    e.m_second = two;
+    p_link(one, two, id, e.m_first_slot);
+    if(m_directed){
+        e.m_second_slot = static_cast<uint32_t>(two->m_in_edges.size());
+        two->m_in_edges.emplace_back(adjacency{one, id});
+    }else{
+        p_link(two, one, id, e.m_second_slot);
+    }
+    if(m_components_tracked && !m_components_stale){
+        m_components.unite(static_cast<disjoint_set::index_type>(one->m_index),
+            static_cast<disjoint_set::index_type>(two->m_index));
+    }
+    return id;
+}
+
+namespace detail{
+
+// adjacency order of sorted nodes: by neighbour, then by edge id
+template<class Adjacency>
+bool adjacency_less(const Adjacency &a, const Adjacency &b){
+    auto ka = reinterpret_cast<uintptr_t>(a.m_node), kb = reinterpret_cast<uintptr_t>(b.m_node);
+    return ka < kb || (ka == kb && a.m_edge < b.m_edge);
+}
+
+};
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_link(node *n, node *other, edge_id id, uint32_t &slot){
+    auto& edges = n->m_edges;
+    const adjacency adj{other, id};
+    if(!n->m_sorted){
+        slot = static_cast<uint32_t>(edges.size());
+        edges.emplace_back(adj);
+    }else{
+        auto pos = std::upper_bound(edges.begin(), edges.end(), adj, detail::adjacency_less<adjacency>);
+        slot = static_cast<uint32_t>(pos - edges.begin());
+        edges.insert(pos, adj);
+        for(auto i = static_cast<uint32_t>(edges.size()-1); i > slot; i--){
+            p_move_slot(n, i-1, i);
+        }
+    }
+    if(n->m_hashed){
+        n->m_hashed->insert(other);
+    }else if(m_adjacency_mode == adjacency_mode::hashed && edges.size() >= m_hash_threshold){
+        p_apply_adjacency_mode(n);
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_unlink(node *n, uint32_t slot){
+    auto& edges = n->m_edges;
+    auto removed = edges[slot].m_node;
+    if(!n->m_sorted){
+        auto last = static_cast<uint32_t>(edges.size()-1);
+        if(slot != last){
+            // last entry moves to "slot", it's edge has to know
+            edges[slot] = edges[last];
+            p_move_slot(n, last, slot);
+        }
+        edges.pop_back();
+    }else{
+        edges.erase(edges.begin() + slot);
+        for(auto i = slot; i < edges.size(); i++){
+            p_move_slot(n, i+1, i);
+        }
+    }
+    if(n->m_hashed){
+        // parallel edges to the same neighbour are next to each other in a sorted adjacency
+        bool still_adjacent = (slot < edges.size() && edges[slot].m_node == removed)
+            || (slot > 0 && edges[slot-1].m_node == removed);
+        if(!still_adjacent){
+            n->m_hashed->erase(removed);
+        }
+        if(edges.size() < m_hash_threshold/2){
+            n->m_hashed.reset();
+        }
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_unlink_in(node *n, uint32_t slot){
+    auto& edges = n->m_in_edges;
+    auto last = static_cast<uint32_t>(edges.size()-1);
+    if(slot != last){
+        edges[slot] = edges[last];
+        m_edges[edges[slot].m_edge].m_second_slot = slot;
+    }
+    edges.pop_back();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_move_slot(node *n, uint32_t from, uint32_t to){
+    // entry that was at "from" is at "to" now, it's edge has to know,
+    // out adjacency of a directed graph holds first ends only
+    auto& e = m_edges[n->m_edges[to].m_edge];
+    if(e.m_first == n && (m_directed || e.m_first_slot == from)){
+        e.m_first_slot = to;
+    }else{
+        e.m_second_slot = to;
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_apply_adjacency_mode(node *n){
+    auto& edges = n->m_edges;
+    n->m_hashed.reset();
+    n->m_sorted = (m_adjacency_mode != adjacency_mode::unordered);
+    if(n->m_sorted){
+        std::sort(edges.begin(), edges.end(), detail::adjacency_less<adjacency>);
+        for(uint32_t i=0; i<edges.size(); i++){
+            auto& e = m_edges[edges[i].m_edge];
+            // both entries of a loop are adjacent, the first one takes the first slot
+            bool loop_second = !m_directed && e.m_second == n && i > 0 && edges[i-1].m_edge == edges[i].m_edge;
+            if(e.m_first == n && !loop_second){
+                e.m_first_slot = i;
+            }else{
+                e.m_second_slot = i;
             }
         }
-        delete edge;
-        edges_it = edges.erase(edges_it);
     }
-    delete node;
+    if(m_adjacency_mode == adjacency_mode::hashed && edges.size() >= m_hash_threshold){
+        n->m_hashed = p_new_hashed();
+        for(const auto& adj:edges){
+            n->m_hashed->insert(adj.m_node);
+        }
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::set_adjacency_mode(adjacency_mode mode, size_t hash_threshold){
+    m_adjacency_mode = mode;
+    m_hash_threshold = std::max<size_t>(hash_threshold, 1);
+    for(auto n:m_nodes){
+        p_apply_adjacency_mode(n);
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::get_adjacency_mode()const
+    ->adjacency_mode
+{
+    return m_adjacency_mode;
 }
 
-template<class ValT>
+template<class ValT, class EdgeT, class Allocator>
 template<class NodeIt>
-auto graph<ValT>::get_adjacent(NodeIt node_it)
+auto graph<ValT, EdgeT, Allocator>::get_adjacent(NodeIt node_it)
     ->std::vector<NodeIt>
 {
     const auto& node = node_it.m_node;
@@ -266,21 +1234,617 @@ auto graph<ValT>::get_adjacent(NodeIt node_it)
     std::vector<NodeIt> result;
     result.reserve(edges.size());
     std::transform(edges.begin(), edges.end(), std::back_inserter(result),
-        [&node](auto &&edge){
-            return (edge->m_first == node)? edge->m_second : edge->m_first;
+        [](const adjacency &adj){
+            return NodeIt(adj.m_node);
     });
     return result;
 }
 
-template<class ValT>
+template<class ValT, class EdgeT, class Allocator>
+template<class NodeIt>
+auto graph<ValT, EdgeT, Allocator>::get_incoming(NodeIt node_it)
+    ->std::vector<NodeIt>
+{
+    const auto& edges = node_it.m_node->m_in_edges;
+    std::vector<NodeIt> result;
+    result.reserve(edges.size());
+    for(const auto& adj:edges){
+        result.emplace_back(NodeIt(adj.m_node));
+    }
+    return result;
+}
+
+template<class ValT, class EdgeT, class Allocator>
 template<class NodeIt>
-auto graph<ValT>::is_adjacent(NodeIt node_one_it, NodeIt node_two_it)
+auto graph<ValT, EdgeT, Allocator>::is_adjacent(NodeIt node_one_it, NodeIt node_two_it)
     ->bool
 {
-    auto& edges_one = node_one_it.m_node->m_edges;
-    auto& edges_two = node_two_it.m_node->m_edges;
-    return std::find_first_of(edges_one.begin(), edges_one.end(),
-        edges_two.begin(), edges_two.end()) != edges_one.end();
+    auto one = node_one_it.m_node;
+    auto two = node_two_it.m_node;
+    auto contains = [](const typename node::Edges &edges, const node *n){
+        return std::find_if(edges.begin(), edges.end(),
+            [n](const adjacency &adj){
+                return adj.m_node == n;
+        }) != edges.end();
+    };
+    if(one->m_hashed){
+        return one->m_hashed->contains(two);
+    }
+    if(one->m_directed){
+        // edge is in out adjacency of "one" and in in-adjacency of "two"
+        if(!one->m_sorted && two->m_in_edges.size() < one->m_edges.size()){
+            return contains(two->m_in_edges, one);
+        }
+    }else{
+        if(two->m_hashed){
+            return two->m_hashed->contains(one);
+        }
+        // search shorter adjacency
+        if(one->m_edges.size() > two->m_edges.size()){
+            std::swap(one, two);
+        }
+    }
+    const auto& edges = one->m_edges;
+    if(one->m_sorted){
+        auto pos = std::lower_bound(edges.begin(), edges.end(), adjacency{two, 0},
+            detail::adjacency_less<adjacency>);
+        return pos != edges.end() && pos->m_node == two;
+    }
+    return contains(edges, two);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+template<class NodeIt>
+auto graph<ValT, EdgeT, Allocator>::common_neighbors(NodeIt node_one_it, NodeIt node_two_it)
+    ->std::vector<NodeIt>
+{
+    auto one = node_one_it.m_node;
+    auto two = node_two_it.m_node;
+    std::vector<NodeIt> result;
+    auto key = [](const adjacency &adj){ return reinterpret_cast<uintptr_t>(adj.m_node); };
+    const node* last = nullptr;
+    auto emit = [&](const adjacency &adj, const adjacency&){
+        // parallel edges give repeated matches, they are next to each other
+        if(adj.m_node != last){
+            last = adj.m_node;
+            result.emplace_back(NodeIt(adj.m_node));
+        }
+    };
+    if(one->m_sorted && two->m_sorted){
+        intersect(one->m_edges.begin(), one->m_edges.end(),
+            two->m_edges.begin(), two->m_edges.end(), key, emit);
+        return result;
+    }
+    auto sorted = [](const node *n){
+        auto edges = n->m_edges;
+        std::sort(edges.begin(), edges.end(), detail::adjacency_less<adjacency>);
+        return edges;
+    };
+    auto edges_one = sorted(one), edges_two = sorted(two);
+    intersect(edges_one.begin(), edges_one.end(), edges_two.begin(), edges_two.end(), key, emit);
+    return result;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::begin()const
+    ->typename graph<ValT, EdgeT, Allocator>::default_it
+{
+    return default_it(m_nodes.empty()? nullptr : m_nodes.front());
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::end()const
+    ->typename graph<ValT, EdgeT, Allocator>::default_it
+{
+    return default_it(nullptr);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+size_t graph<ValT, EdgeT, Allocator>::size()const{
+    return m_nodes.size();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+size_t graph<ValT, EdgeT, Allocator>::edge_count()const{
+    return m_edges.size() - m_free_edges.size();
 }
 
-};
\ No newline at end of file
+template<class ValT, class EdgeT, class Allocator>
+cont::container_stats graph<ValT, EdgeT, Allocator>::stats()const{
+    cont::container_stats result;
+    result.elements = result.live_nodes = m_nodes.size();
+    result.value_bytes = m_nodes.size() * sizeof(value_type);
+    // every edge has an entry at both ends: adjacency of each end, or out- and in-adjacency
+    result.node_bytes = m_pool.capacity() * sizeof(node) - result.value_bytes
+        + m_nodes.capacity() * sizeof(node*)
+        + m_handles.capacity() * sizeof(handle_slot) + m_free_handles.capacity() * sizeof(uint32_t)
+        + m_edges.capacity() * sizeof(edge) + m_free_edges.capacity() * sizeof(edge_id)
+        + 2 * edge_count() * sizeof(adjacency);
+    cont::detail::add_counters(result, m_alloc);
+    return result;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::enable_components(){
+    m_components_tracked = true;
+    p_build_components(m_components);
+    m_components_stale = false;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::disable_components(){
+    m_components_tracked = false;
+    m_components = disjoint_set();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+bool graph<ValT, EdgeT, Allocator>::components_tracked()const{
+    return m_components_tracked;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+bool graph<ValT, EdgeT, Allocator>::connected(const iterator_base &one, const iterator_base &two){
+    using index_type = disjoint_set::index_type;
+    auto a = static_cast<index_type>(one.m_node->m_index);
+    auto b = static_cast<index_type>(two.m_node->m_index);
+    if(m_components_tracked){
+        return p_components().same(a, b);
+    }
+    disjoint_set set;
+    p_build_components(set);
+    return set.same(a, b);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+size_t graph<ValT, EdgeT, Allocator>::component_count(){
+    if(m_components_tracked){
+        return p_components().set_count();
+    }
+    disjoint_set set;
+    p_build_components(set);
+    return set.set_count();
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_build_components(disjoint_set &set)const{
+    set.reset(m_nodes.size());
+    // arena is scanned sequentially, free slots have no ends
+    for(const auto& e:m_edges){
+        if(e.m_first){
+            set.unite(static_cast<disjoint_set::index_type>(e.m_first->m_index),
+                static_cast<disjoint_set::index_type>(e.m_second->m_index));
+        }
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+disjoint_set& graph<ValT, EdgeT, Allocator>::p_components(){
+    if(m_components_stale){
+        p_build_components(m_components);
+        m_components_stale = false;
+    }
+    return m_components;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+template<class Arg>
+auto graph<ValT, EdgeT, Allocator>::p_new_node(Arg &&val)
+    ->typename graph<ValT, EdgeT, Allocator>::node*
+{
+    // everything that can throw is done before the node is committed, insert has no effect on a throw
+    const bool reuse = !m_free_handles.empty();
+    const auto handle = reuse? m_free_handles.back() : static_cast<uint32_t>(m_handles.size());
+    if(!reuse){
+        m_handles.emplace_back(handle_slot{nullptr, 1});
+    }
+    const auto index = m_nodes.size();
+    node *place = nullptr;
+    try{
+        m_nodes.emplace_back(nullptr);
+        if(m_components_tracked && !m_components_stale){
+            m_components.add();
+        }
+        place = m_pool.allocate();
+        new (place) node{p_new_edges(), value_type(std::forward<Arg>(val)), index, handle,
+            m_adjacency_mode != adjacency_mode::unordered, {}, p_new_edges(), m_directed};
+    }catch(...){
+        if(place){
+            m_pool.undo_allocate(place);
+        }
+        if(m_nodes.size() > index){
+            m_nodes.pop_back();
+            // union-find may have got an element of no node, it's rebuilt by next query
+            m_components_stale = m_components_stale || m_components_tracked;
+        }
+        if(!reuse){
+            m_handles.pop_back();
+        }
+        throw;
+    }
+    if(reuse){
+        m_free_handles.pop_back();
+    }
+    m_handles[handle].m_node = place;
+    m_nodes.back() = place;
+    return place;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_free_node(node *n){
+    auto& slot = m_handles[n->m_handle];
+    slot.m_node = nullptr;
+    slot.m_generation++;
+    m_free_handles.emplace_back(n->m_handle);
+    n->~node();
+    m_pool.deallocate(n);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::p_new_edges()const
+    ->typename node::Edges
+{
+    return typename node::Edges(rebind_t<adjacency>(m_alloc));
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::p_copy_edges(const typename node::Edges &edges)const
+    ->typename node::Edges
+{
+    return typename node::Edges(edges, rebind_t<adjacency>(m_alloc));
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::p_new_hashed()const
+    ->std::unique_ptr<hashed_set, hashed_deleter>
+{
+    using traits = std::allocator_traits<rebind_t<hashed_set>>;
+    rebind_t<hashed_set> alloc(m_alloc);
+    auto set = traits::allocate(alloc, 1);
+    traits::construct(alloc, set, rebind_t<const node*>(m_alloc));
+    return std::unique_ptr<hashed_set, hashed_deleter>(set);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::hashed_deleter::operator()(hashed_set *set)const{
+    using traits = std::allocator_traits<rebind_t<hashed_set>>;
+    rebind_t<hashed_set> alloc(set->get_allocator());
+    traits::destroy(alloc, set);
+    traits::deallocate(alloc, set, 1);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::handle(const iterator_base &it)const
+    ->node_handle
+{
+    auto n = it.m_node;
+    return node_handle{n->m_handle, m_handles[n->m_handle].m_generation};
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::find(node_handle h)const
+    ->typename graph<ValT, EdgeT, Allocator>::default_it
+{
+    return default_it(contains(h)? m_handles[h.m_index].m_node : nullptr);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+bool graph<ValT, EdgeT, Allocator>::contains(node_handle h)const{
+    return h.m_index < m_handles.size() && m_handles[h.m_index].m_generation == h.m_generation
+        && m_handles[h.m_index].m_node;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_clone(const graph &rhs){
+    m_adjacency_mode = rhs.m_adjacency_mode;
+    m_hash_threshold = rhs.m_hash_threshold;
+    m_directed = rhs.m_directed;
+    m_components_tracked = rhs.m_components_tracked;
+    m_components_stale = rhs.m_components_stale;
+    m_components = rhs.m_components;
+    m_edges = rhs.m_edges;
+    m_free_edges = rhs.m_free_edges;
+    // handles of rhs are valid for the copy
+    m_handles = rhs.m_handles;
+    m_free_handles = rhs.m_free_handles;
+    const auto n = rhs.m_nodes.size();
+    if(n == 0){
+        return;
+    }
+    m_nodes.reserve(n);
+    auto block = m_pool.allocate_block(n);
+    // node::m_index is the remapping table: copy of rhs.m_nodes[i] is block[i]
+    auto copy_of = [block](const node *n){ return block + n->m_index; };
+    // sorted adjacencies stay sorted if rhs nodes are ordered by address as well
+    bool address_order = true;
+    try{
+        // each node goes to m_nodes once constructed, so clear() can undo a throwing copy
+        for(size_t i=0; i<n; i++){
+            auto src = rhs.m_nodes[i];
+            address_order = address_order && (i == 0 || rhs.m_nodes[i-1] < src);
+            new (block + i) node{p_copy_edges(src->m_edges), src->m_value, i, src->m_handle, src->m_sorted,
+                {}, p_copy_edges(src->m_in_edges), src->m_directed};
+            m_nodes.emplace_back(block + i);
+            m_handles[src->m_handle].m_node = block + i;
+            for(auto& adj:block[i].m_edges){
+                adj.m_node = copy_of(adj.m_node);
+            }
+            for(auto& adj:block[i].m_in_edges){
+                adj.m_node = copy_of(adj.m_node);
+            }
+        }
+        for(auto& e:m_edges){
+            if(e.m_first){
+                e.m_first = copy_of(e.m_first);
+                e.m_second = copy_of(e.m_second);
+            }
+        }
+        for(size_t i=0; i<n; i++){
+            const auto src = rhs.m_nodes[i];
+            if(src->m_sorted && !address_order){
+                p_apply_adjacency_mode(m_nodes[i]);
+            }else if(src->m_hashed){
+                m_nodes[i]->m_hashed = p_new_hashed();
+                for(const auto& adj:m_nodes[i]->m_edges){
+                    m_nodes[i]->m_hashed->insert(adj.m_node);
+                }
+            }
+        }
+    }catch(...){
+        clear();
+        // slots of nodes not copied yet still point into rhs
+        m_handles.clear();
+        m_free_handles.clear();
+        throw;
+    }
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_steal(graph &rhs){
+    m_nodes = std::move(rhs.m_nodes);
+    m_pool = std::move(rhs.m_pool);
+    m_handles = std::move(rhs.m_handles);
+    m_free_handles = std::move(rhs.m_free_handles);
+    m_edges = std::move(rhs.m_edges);
+    m_free_edges = std::move(rhs.m_free_edges);
+    m_components = std::move(rhs.m_components);
+    m_components_tracked = rhs.m_components_tracked;
+    m_components_stale = rhs.m_components_stale;
+    m_directed = rhs.m_directed;
+    m_adjacency_mode = rhs.m_adjacency_mode;
+    m_hash_threshold = rhs.m_hash_threshold;
+    rhs.m_nodes.clear();
+    rhs.m_handles.clear();
+    rhs.m_free_handles.clear();
+    rhs.m_edges.clear();
+    rhs.m_free_edges.clear();
+    rhs.m_components.reset(0);
+    rhs.m_components_stale = false;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+std::vector<size_t> graph<ValT, EdgeT, Allocator>::p_order(reorder_policy policy)const{
+    const auto n = m_nodes.size();
+    auto degree = [this](size_t v){ return m_nodes[v]->m_edges.size(); };
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    if(policy == reorder_policy::degree){
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            return degree(a) > degree(b);
+        });
+        return order;
+    }
+    // bfs and rcm: order is filled as a queue, one component after another
+    std::vector<size_t> starts = order;
+    if(policy == reorder_policy::rcm){
+        std::stable_sort(starts.begin(), starts.end(), [&](size_t a, size_t b){
+            return degree(a) < degree(b);
+        });
+    }
+    std::vector<bool> visited(n);
+    std::vector<size_t> neighbours;
+    size_t tail = 0;
+    for(auto start:starts){
+        if(visited[start]){
+            continue;
+        }
+        visited[start] = true;
+        order[tail++] = start;
+        for(auto head = tail-1; head < tail; head++){
+            neighbours.clear();
+            for(const auto& adj:m_nodes[order[head]]->m_edges){
+                auto v = adj.m_node->m_index;
+                if(!visited[v]){
+                    visited[v] = true;
+                    neighbours.emplace_back(v);
+                }
+            }
+            if(policy == reorder_policy::rcm){
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&](size_t a, size_t b){
+                    return degree(a) < degree(b);
+                });
+            }
+            for(auto v:neighbours){
+                order[tail++] = v;
+            }
+        }
+    }
+    if(policy == reorder_policy::rcm){
+        std::reverse(order.begin(), order.end());
+    }
+    return order;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+std::vector<size_t> graph<ValT, EdgeT, Allocator>::reorder(reorder_policy policy){
+    const auto n = m_nodes.size();
+    auto order = p_order(policy);
+    std::vector<size_t> permutation(n);
+    for(size_t i=0; i<n; i++){
+        permutation[order[i]] = i;
+    }
+    if(n == 0){
+        return permutation;
+    }
+    // new pool holds all nodes in one block, old one is released as a whole
+    pool_type pool{rebind_t<node>(m_alloc)};
+    auto block = pool.allocate_block(n);
+    auto relocated = [&](node *old){ return block + permutation[old->m_index]; };
+    for(size_t i=0; i<n; i++){
+        auto old = m_nodes[order[i]];
+        // adjacency is copied, not moved: fresh arrays are allocated in the new order too
+        new (block + i) node{p_copy_edges(old->m_edges), std::move(old->m_value), i, old->m_handle, false,
+            {}, p_copy_edges(old->m_in_edges), old->m_directed};
+        m_handles[old->m_handle].m_node = block + i;
+    }
+    // old nodes keep their indices until freed, so they map to new places
+    for(size_t i=0; i<n; i++){
+        for(auto& adj:block[i].m_edges){
+            adj.m_node = relocated(adj.m_node);
+        }
+        for(auto& adj:block[i].m_in_edges){
+            adj.m_node = relocated(adj.m_node);
+        }
+    }
+    for(auto& e:m_edges){
+        if(e.m_first){
+            e.m_first = relocated(e.m_first);
+            e.m_second = relocated(e.m_second);
+        }
+    }
+    for(auto old:m_nodes){
+        old->~node();
+    }
+    m_pool = std::move(pool);
+    for(size_t i=0; i<n; i++){
+        m_nodes[i] = block + i;
+    }
+    if(m_adjacency_mode != adjacency_mode::unordered){
+        // sorted adjacencies are ordered by addresses, which have changed
+        for(auto node:m_nodes){
+            p_apply_adjacency_mode(node);
+        }
+    }
+    m_components_stale = true;
+    return permutation;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::to_csr()const
+    ->csr_graph<value_type, edge_value_type>
+{
+    using csr = csr_graph<value_type, edge_value_type>;
+    const bool has_payload = !std::is_empty<edge_value_type>::value;
+    std::vector<typename csr::offset_type> offsets;
+    offsets.reserve(m_nodes.size()+1);
+    offsets.emplace_back(0);
+    for(const auto node:m_nodes){
+        offsets.emplace_back(offsets.back() + node->m_edges.size());
+    }
+    std::vector<typename csr::index_type> targets(offsets.back());
+    std::vector<edge_value_type> edge_values;
+    std::vector<value_type> values;
+    values.reserve(m_nodes.size());
+    if(has_payload){
+        edge_values.reserve(targets.size());
+    }
+    std::vector<adjacency> sorted; // row ordered by target, to keep payloads along
+    for(const auto node:m_nodes){
+        auto row = targets.begin() + offsets[node->m_index];
+        if(has_payload){
+            sorted.assign(node->m_edges.begin(), node->m_edges.end());
+            std::sort(sorted.begin(), sorted.end(), [](const adjacency &a, const adjacency &b){
+                return a.m_node->m_index < b.m_node->m_index;
+            });
+            for(const auto& adj:sorted){
+                *row++ = static_cast<typename csr::index_type>(adj.m_node->m_index);
+                edge_values.emplace_back(m_edges[adj.m_edge].value());
+            }
+        }else{
+            auto it = row;
+            for(const auto& adj:node->m_edges){
+                *it++ = static_cast<typename csr::index_type>(adj.m_node->m_index);
+            }
+            std::sort(row, it);
+        }
+        values.emplace_back(node->m_value);
+    }
+    return csr(std::move(offsets), std::move(targets), std::move(values), std::move(edge_values), m_directed);
+}
+
+template<class ValT, class EdgeT, class Allocator>
+auto graph<ValT, EdgeT, Allocator>::from_edges(size_t node_count, const std::vector<std::uint64_t> &keys,
+    const Allocator &alloc)
+    ->graph<ValT, EdgeT, Allocator>
+{
+    graph result(alloc);
+    result.p_build(node_count, keys);
+    return result;
+}
+
+template<class ValT, class EdgeT, class Allocator>
+void graph<ValT, EdgeT, Allocator>::p_build(size_t node_count, const std::vector<std::uint64_t> &keys){
+    const auto n = node_count;
+    auto first = [](std::uint64_t k){ return uint32_t(k >> 32); };
+    auto second = [](std::uint64_t k){ return uint32_t(k); };
+    if(keys.size() > std::numeric_limits<edge_id>::max()){
+        throw std::length_error("too many edges for edge_id");
+    }
+    // checked before anything is allocated, so a bad key leaves graph empty
+    std::vector<uint32_t> degree(n, 0);
+    for(auto k:keys){
+        if(first(k) >= n || second(k) >= n){
+            throw std::out_of_range("edge end is not a node of a graph");
+        }
+        if(first(k) == second(k)){
+            throw std::invalid_argument("loop edges aren't taken, connect() them");
+        }
+        degree[first(k)]++;
+        degree[second(k)]++;
+    }
+    if(n == 0){
+        return;
+    }
+    m_nodes.reserve(n);
+    m_handles.reserve(n);
+    auto block = m_pool.allocate_block(n);
+    try{
+        // a node is owned by m_nodes once constructed, so clear() can undo a throwing build
+        for(size_t i=0; i<n; i++){
+            auto handle = static_cast<uint32_t>(m_handles.size());
+            auto created = new (block + i) node{p_new_edges(), value_type(), i, handle, false, {}, p_new_edges(), false};
+            m_nodes.emplace_back(created);
+            m_handles.emplace_back(handle_slot{created, 1});
+            created->m_edges.reserve(degree[i]);
+        }
+        // adjacency arrays are allocated once, with exact size
+        m_edges.resize(keys.size());
+    }catch(...){
+        clear();
+        m_handles.clear();
+        m_free_handles.clear();
+        throw;
+    }
+    for(edge_id id=0; id<keys.size(); id++){
+        auto one = block + first(keys[id]);
+        auto two = block + second(keys[id]);
+        auto& e = m_edges[id];
+        e.m_first = one;
+        e.m_second = two;
+        e.m_first_slot = static_cast<uint32_t>(one->m_edges.size());
+        e.m_second_slot = static_cast<uint32_t>(two->m_edges.size());
+        one->m_edges.emplace_back(adjacency{two, id});
+        two->m_edges.emplace_back(adjacency{one, id});
+    }
+}
+
+#if CONT_HAS_PMR
+namespace pmr{
+/**
+ * Graph whose nodes, edges and adjacency come from a std::pmr::memory_resource
+ */
+template<class ValT, class EdgeT = no_payload>
+using graph = cxx_graph::graph<ValT, EdgeT, std::pmr::polymorphic_allocator<ValT>>;
+};
+#endif
+
+};
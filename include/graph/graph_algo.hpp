@@ -0,0 +1,1097 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "csr_graph.hpp"
+#include "set_intersection.hpp"
+#include "thread_pool.hpp"
+
+namespace cxx_graph{
+namespace graph_algo{
+
+using index_type = std::uint32_t;
+
+/**
+ * Statistics of one BFS level
+ */
+struct bfs_level{
+    size_t m_frontier;          // nodes expanded on this level
+    bool m_bottom_up;           // direction of a step
+    std::chrono::nanoseconds m_time;
+};
+
+struct bfs_result{
+    using index_type = graph_algo::index_type;
+    enum : index_type{ none = std::numeric_limits<index_type>::max() };
+    std::vector<index_type> m_distance; // none for unreachable nodes
+    std::vector<index_type> m_parent;   // none for unreachable nodes, source is it's own parent
+    std::vector<bfs_level> m_levels;
+};
+
+/**
+ * Level-synchronous direction-optimizing BFS.
+ * Small frontiers are expanded top-down: frontier nodes claim their
+ * unvisited neighbours with an atomic bitmap. When frontier's edges outweigh
+ * unvisited part of a graph, step goes bottom-up: each unvisited node looks
+ * for any parent in frontier and stops at the first one.
+ * A directed graph is traversed along edges, bottom-up steps look through in-rows.
+ * Graph nodes are those of graph::to_csr().
+ * @param source index of a start node
+ * @throw std::out_of_range if source isn't a node of a graph
+ */
+template<class ValT, class EdgeT>
+bfs_result parallel_bfs(const csr_graph<ValT, EdgeT> &gr, index_type source, thread_pool &pool);
+/**
+ * Same as above, on a temporary pool of hardware concurrency size
+ */
+template<class ValT, class EdgeT>
+bfs_result parallel_bfs(const csr_graph<ValT, EdgeT> &gr, index_type source);
+
+/**
+ * Default weight of an edge: it's payload itself
+ */
+struct payload_weight{
+    template<class T>
+    const T& operator()(const T &payload)const{ return payload; }
+};
+
+template<class EdgeT, class WeightF>
+using weight_t = typename std::decay<decltype(std::declval<WeightF>()(std::declval<const EdgeT&>()))>::type;
+
+template<class DistT>
+struct sssp_result{
+    using index_type = graph_algo::index_type;
+    enum : index_type{ none = std::numeric_limits<index_type>::max() };
+    static DistT unreachable(){ return std::numeric_limits<DistT>::max(); }
+    std::vector<DistT> m_distance;   // unreachable() for unreachable nodes
+    std::vector<index_type> m_parent;// none for unreachable nodes, source is it's own parent
+};
+
+/**
+ * Single source shortest paths on a 4-ary heap with decrease-key,
+ * O((V+E) log V), every node leaves the heap once.
+ * @param weight functor giving non-negative weight of an edge payload
+ * @throw std::out_of_range if source isn't a node of a graph
+ * @throw std::invalid_argument on a negative weight
+ */
+template<class ValT, class EdgeT, class WeightF = payload_weight>
+sssp_result<weight_t<EdgeT, WeightF>> dijkstra(const csr_graph<ValT, EdgeT> &gr,
+    index_type source, WeightF weight = WeightF());
+
+/**
+ * Parallel bucketed single source shortest paths (Meyer and Sanders).
+ * Nodes with distance in [i*delta, (i+1)*delta) form bucket "i", buckets are
+ * settled in order, relaxations within a bucket run in parallel. Distance and parent
+ * of a node are updated together under a per node spin lock.
+ * Small delta gives Dijkstra-like work, large one gives Bellman-Ford-like parallelism.
+ * Buckets are kept in a ring of max weight / delta + 2 slots per worker, up to 1024,
+ * nodes farther ahead wait in an overflow list.
+ * @param delta bucket width, positive
+ * @throw std::out_of_range if source isn't a node of a graph
+ * @throw std::invalid_argument on a negative weight or non-positive delta
+ */
+template<class ValT, class EdgeT, class WeightF = payload_weight>
+sssp_result<weight_t<EdgeT, WeightF>> delta_stepping(const csr_graph<ValT, EdgeT> &gr,
+    index_type source, weight_t<EdgeT, WeightF> delta, thread_pool &pool, WeightF weight = WeightF());
+/**
+ * Same as above with payload weights, on a temporary pool of hardware concurrency size
+ */
+template<class ValT, class EdgeT>
+sssp_result<EdgeT> delta_stepping(const csr_graph<ValT, EdgeT> &gr, index_type source, EdgeT delta);
+
+/**
+ * Count of triangles in a simple graph (no parallel edges).
+ * Each triangle v < u < w is counted once, at edge (v, u), as size of
+ * intersection of higher neighbours of v and u. Rows of CSR are sorted,
+ * so higher neighbours are a suffix of a row and intersection is SIMD merge or galloping.
+ * @throw std::invalid_argument for a directed graph
+ */
+template<class ValT, class EdgeT>
+std::uint64_t triangle_count(const csr_graph<ValT, EdgeT> &gr, thread_pool &pool);
+/**
+ * Same as above, on a temporary pool of hardware concurrency size
+ */
+template<class ValT, class EdgeT>
+std::uint64_t triangle_count(const csr_graph<ValT, EdgeT> &gr);
+
+using path = std::vector<index_type>;
+/**
+ * Shortest hop paths between pairs of nodes by bidirectional BFS.
+ * Levels are expanded from the side with fewer frontier edges, until
+ * the two searches meet, so a query sees about 2*sqrt of nodes
+ * a one-sided BFS would see on an expander-like graph.
+ * In a directed graph the backward search from target goes through in-rows.
+ * Scratch arrays are kept between queries: a node is visited by a query
+ * if it's stamp holds query epoch, so no O(V) reset is needed.
+ * One searcher serves one thread at a time.
+ */
+template<class ValT, class EdgeT>
+class path_searcher{
+public:
+    explicit path_searcher(const csr_graph<ValT, EdgeT> &gr);
+
+    /**
+     * @return nodes of a shortest path from "source" to "target" both inclusive, empty if there is none
+     * @throw std::out_of_range if source or target isn't a node of a graph
+     */
+    path shortest_path(index_type source, index_type target);
+private:
+    const csr_graph<ValT, EdgeT>& m_graph;
+    std::vector<std::uint32_t> m_stamp;  // 2*epoch for forward side, 2*epoch+1 for backward one
+    std::vector<index_type> m_parent;    // next node towards root of a side that visited it
+    std::vector<index_type> m_frontier[2], m_next;
+    std::uint32_t m_epoch = 0;
+};
+
+/**
+ * Shortest hop path from "source" to "target", see path_searcher.
+ * Allocates O(V) scratch, reuse a path_searcher for many queries.
+ */
+template<class ValT, class EdgeT>
+path shortest_path(const csr_graph<ValT, EdgeT> &gr, index_type source, index_type target);
+/**
+ * Answers (source, target) queries in parallel, each worker with it's own path_searcher
+ * @return paths in order of queries
+ * @throw std::out_of_range if any query has a node not in a graph
+ */
+template<class ValT, class EdgeT>
+std::vector<path> shortest_paths(const csr_graph<ValT, EdgeT> &gr,
+    const std::vector<std::pair<index_type, index_type>> &queries, thread_pool &pool);
+/**
+ * Same as above, on a temporary pool of hardware concurrency size
+ */
+template<class ValT, class EdgeT>
+std::vector<path> shortest_paths(const csr_graph<ValT, EdgeT> &gr,
+    const std::vector<std::pair<index_type, index_type>> &queries);
+
+/**
+ * Sparse matrix-vector product over adjacency, y[v] = sum of x[u] for neighbours u of v.
+ * In a directed graph u runs over predecessors, i.e. values flow along edges.
+ * Rows are pulled in parallel, each one is a contiguous gather of x.
+ * @param y resized to node count
+ */
+template<class ValT, class EdgeT, class T>
+void spmv(const csr_graph<ValT, EdgeT> &gr, const std::vector<T> &x, std::vector<T> &y, thread_pool &pool);
+/**
+ * Same as above with weighted adjacency, y[v] = sum of weight(payload of (u, v)) * x[u]
+ */
+template<class ValT, class EdgeT, class T, class WeightF>
+void spmv(const csr_graph<ValT, EdgeT> &gr, const std::vector<T> &x, std::vector<T> &y,
+    thread_pool &pool, WeightF weight);
+
+/**
+ * Statistics of one PageRank iteration
+ */
+struct pagerank_iteration{
+    double m_error;             // L1 distance between ranks of this and previous iteration
+    std::chrono::nanoseconds m_time;
+};
+
+struct pagerank_result{
+    std::vector<double> m_rank; // sums to 1
+    std::vector<pagerank_iteration> m_iterations;
+    bool m_converged;
+};
+
+/**
+ * PageRank by pull-based power iteration.
+ * Every node keeps rank/degree of the previous iteration, a row of a node
+ * sums those of it's neighbours, so an iteration is one pass over CSR
+ * without atomics. Rank of nodes without edges is spread over all nodes.
+ * In a directed graph rank goes along edges: a node pulls through it's in-row
+ * and shares by out-degree, nodes without outgoing edges spread their rank.
+ * @param damping probability to follow an edge
+ * @param tolerance iteration stops when L1 change of ranks is below it
+ */
+template<class ValT, class EdgeT>
+pagerank_result pagerank(const csr_graph<ValT, EdgeT> &gr, thread_pool &pool,
+    double damping = 0.85, double tolerance = 1e-6, size_t max_iterations = 100);
+/**
+ * Same as above, on a temporary pool of hardware concurrency size
+ */
+template<class ValT, class EdgeT>
+pagerank_result pagerank(const csr_graph<ValT, EdgeT> &gr,
+    double damping = 0.85, double tolerance = 1e-6, size_t max_iterations = 100);
+
+/**
+ * Kahn's topological sort in O(V+E). Rows of CSR are successors,
+ * as in to_csr() of a directed graph. Ready nodes are taken in FIFO order.
+ * @throw std::invalid_argument if graph has a cycle
+ */
+template<class ValT, class EdgeT>
+std::vector<index_type> topological_sort(const csr_graph<ValT, EdgeT> &dag);
+
+/**
+ * Runs a task per node of a DAG on a thread pool, each node as soon as
+ * all it's predecessors are done. Rows of CSR are successors.
+ * Predecessor counters are atomic, a worker that releases successors
+ * goes on with one of them and hands the rest to other workers.
+ */
+class dag_executor{
+public:
+    explicit dag_executor(thread_pool &pool)
+        :m_pool(pool)
+    {}
+
+    /**
+     * @param task functor called as task(node), effects of predecessor tasks are visible to it
+     * @throw std::invalid_argument if graph has a cycle, nodes not depending on it are run anyway
+     * @throw exception of a task, no new tasks are started after it
+     */
+    template<class ValT, class EdgeT, class F>
+    void run(const csr_graph<ValT, EdgeT> &dag, F &&task);
+private:
+    thread_pool& m_pool;
+};
+
+namespace detail{
+
+/**
+ * Min-heap of nodes keyed by distance, with positions for decrease-key.
+ * Wide nodes make the heap shallow and keep children in one cache line.
+ */
+template<class KeyT, size_t Arity = 4>
+class dary_heap{
+public:
+    struct entry{
+        KeyT m_key;
+        index_type m_node;
+    };
+    explicit dary_heap(size_t nodes)
+        :m_pos(nodes, npos)
+    {}
+    bool empty()const{ return m_heap.empty(); }
+    entry pop(){
+        auto top = m_heap.front();
+        m_pos[top.m_node] = npos;
+        auto last = m_heap.back();
+        m_heap.pop_back();
+        if(!m_heap.empty()){
+            p_sift_down(0, last);
+        }
+        return top;
+    }
+    /**
+     * Inserts a node or lowers it's key, key must not grow
+     */
+    void push_or_decrease(index_type node, KeyT key){
+        auto pos = m_pos[node];
+        if(pos == npos){
+            pos = static_cast<index_type>(m_heap.size());
+            m_heap.emplace_back();
+        }
+        p_sift_up(pos, entry{key, node});
+    }
+private:
+    enum : index_type{ npos = std::numeric_limits<index_type>::max() };
+    std::vector<entry> m_heap;
+    std::vector<index_type> m_pos; // position of a node in m_heap, npos if absent
+
+    void p_place(size_t pos, const entry &e){
+        m_heap[pos] = e;
+        m_pos[e.m_node] = static_cast<index_type>(pos);
+    }
+    void p_sift_up(size_t pos, const entry &e){
+        while(pos > 0){
+            auto parent = (pos-1) / Arity;
+            if(!(e.m_key < m_heap[parent].m_key)){
+                break;
+            }
+            p_place(pos, m_heap[parent]);
+            pos = parent;
+        }
+        p_place(pos, e);
+    }
+    void p_sift_down(size_t pos, const entry &e){
+        const auto size = m_heap.size();
+        while(true){
+            auto first = pos*Arity + 1;
+            if(first >= size){
+                break;
+            }
+            auto last = std::min(first + Arity, size);
+            auto best = first;
+            for(auto c=first+1; c<last; c++){
+                if(m_heap[c].m_key < m_heap[best].m_key){
+                    best = c;
+                }
+            }
+            if(!(m_heap[best].m_key < e.m_key)){
+                break;
+            }
+            p_place(pos, m_heap[best]);
+            pos = best;
+        }
+        p_place(pos, e);
+    }
+};
+
+class atomic_bitmap{
+    std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+public:
+    explicit atomic_bitmap(size_t bits)
+        :m_words(new std::atomic<uint64_t>[(bits+63)/64])
+    {
+        for(size_t i=0; i<(bits+63)/64; i++){
+            m_words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    bool test(size_t bit)const{
+        return m_words[bit/64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit%64));
+    }
+    /**
+     * @return true if this call set the bit
+     */
+    bool set(size_t bit){
+        auto mask = uint64_t(1) << (bit%64);
+        return !(m_words[bit/64].fetch_or(mask, std::memory_order_relaxed) & mask);
+    }
+    void clear(size_t bit){
+        m_words[bit/64].fetch_and(~(uint64_t(1) << (bit%64)), std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Sum of x[i] over indices in [it, end).
+ * Four independent accumulators keep loads in flight and let compiler
+ * vectorize the gather where target has one.
+ */
+template<class T>
+T gather_sum(const index_type *it, const index_type *end, const T *x){
+    T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+    for(; end - it >= 4; it += 4){
+        s0 += x[it[0]];
+        s1 += x[it[1]];
+        s2 += x[it[2]];
+        s3 += x[it[3]];
+    }
+    for(; it != end; ++it){
+        s0 += x[*it];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+};
+
+template<class ValT, class EdgeT>
+bfs_result parallel_bfs(const csr_graph<ValT, EdgeT> &gr, index_type source, thread_pool &pool){
+    // tuning from Beamer et al. "Direction-optimizing breadth-first search"
+    const size_t alpha = 14, beta = 24;
+    const size_t grain = 1024;
+    const auto n = gr.node_count();
+    if(source >= n){
+        throw std::out_of_range("source is not a node of a graph");
+    }
+    const auto& offsets = gr.offsets();
+    const auto& targets = gr.targets();
+    const auto& in_offsets = gr.in_offsets();
+    const auto& in_sources = gr.in_sources();
+    auto degree = [&](index_type v){ return offsets[v+1] - offsets[v]; };
+
+    bfs_result result;
+    result.m_distance.assign(n, bfs_result::none);
+    result.m_parent.assign(n, bfs_result::none);
+    auto distance = result.m_distance.data();
+    auto parent = result.m_parent.data();
+    detail::atomic_bitmap visited(n), in_frontier(n);
+
+    std::vector<index_type> frontier{source};
+    std::vector<std::vector<index_type>> found(pool.size());
+    std::vector<uint64_t> found_edges(pool.size());
+    visited.set(source);
+    distance[source] = 0;
+    parent[source] = source;
+
+    uint64_t frontier_edges = degree(source);
+    uint64_t unexplored_edges = targets.size() - frontier_edges;
+    size_t prev_frontier = 0;
+    bool bottom_up = false;
+    for(index_type depth = 0; !frontier.empty(); depth++){
+        auto start = std::chrono::steady_clock::now();
+        // only growing frontier goes bottom-up, a shrinking small one goes back
+        bool growing = frontier.size() > prev_frontier;
+        if(!bottom_up && growing && frontier_edges > unexplored_edges / alpha){
+            bottom_up = true;
+        }else if(bottom_up && !growing && frontier.size() < n / beta){
+            bottom_up = false;
+        }
+        prev_frontier = frontier.size();
+        for(auto& f:found){
+            f.clear();
+        }
+        std::fill(found_edges.begin(), found_edges.end(), 0);
+
+        if(bottom_up){
+            pool.parallel_for(0, frontier.size(), grain, [&](size_t b, size_t e, size_t){
+                for(auto i=b; i<e; i++){
+                    in_frontier.set(frontier[i]);
+                }
+            });
+            // each node is checked by a single worker, nobody else claims it bottom-up
+            pool.parallel_for(0, n, grain, [&](size_t b, size_t e, size_t worker){
+                auto& out = found[worker];
+                for(auto v=b; v<e; v++){
+                    if(visited.test(v)){
+                        continue;
+                    }
+                    for(auto i=in_offsets[v]; i<in_offsets[v+1]; i++){
+                        auto u = in_sources[i];
+                        if(in_frontier.test(u)){
+                            visited.set(v);
+                            distance[v] = depth+1;
+                            parent[v] = u;
+                            out.emplace_back(static_cast<index_type>(v));
+                            found_edges[worker] += degree(static_cast<index_type>(v));
+                            break;
+                        }
+                    }
+                }
+            });
+            // next level needs a clean frontier bitmap
+            pool.parallel_for(0, frontier.size(), grain, [&](size_t b, size_t e, size_t){
+                for(auto i=b; i<e; i++){
+                    in_frontier.clear(frontier[i]);
+                }
+            });
+        }else{
+            pool.parallel_for(0, frontier.size(), grain / 16, [&](size_t b, size_t e, size_t worker){
+                auto& out = found[worker];
+                for(auto i=b; i<e; i++){
+                    auto v = frontier[i];
+                    for(auto j=offsets[v]; j<offsets[v+1]; j++){
+                        auto u = targets[j];
+                        if(!visited.test(u) && visited.set(u)){
+                            distance[u] = depth+1;
+                            parent[u] = v;
+                            out.emplace_back(u);
+                            found_edges[worker] += degree(u);
+                        }
+                    }
+                }
+            });
+        }
+
+        result.m_levels.emplace_back(bfs_level{frontier.size(), bottom_up,
+            std::chrono::steady_clock::now() - start});
+        frontier.clear();
+        frontier_edges = 0;
+        for(size_t w=0; w<found.size(); w++){
+            frontier.insert(frontier.end(), found[w].begin(), found[w].end());
+            frontier_edges += found_edges[w];
+        }
+        unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+    }
+    return result;
+}
+
+template<class ValT, class EdgeT>
+bfs_result parallel_bfs(const csr_graph<ValT, EdgeT> &gr, index_type source){
+    thread_pool pool;
+    return parallel_bfs(gr, source, pool);
+}
+
+template<class ValT, class EdgeT, class WeightF>
+sssp_result<weight_t<EdgeT, WeightF>> dijkstra(const csr_graph<ValT, EdgeT> &gr,
+    index_type source, WeightF weight)
+{
+    using dist_type = weight_t<EdgeT, WeightF>;
+    using result_type = sssp_result<dist_type>;
+    const auto n = gr.node_count();
+    if(source >= n){
+        throw std::out_of_range("source is not a node of a graph");
+    }
+    const auto& offsets = gr.offsets();
+    const auto& targets = gr.targets();
+    result_type result;
+    result.m_distance.assign(n, result_type::unreachable());
+    result.m_parent.assign(n, result_type::none);
+    auto& distance = result.m_distance;
+    auto& parent = result.m_parent;
+
+    detail::dary_heap<dist_type> heap(n);
+    distance[source] = dist_type();
+    parent[source] = source;
+    heap.push_or_decrease(source, dist_type());
+    while(!heap.empty()){
+        auto top = heap.pop();
+        auto u = top.m_node;
+        for(auto i=offsets[u]; i<offsets[u+1]; i++){
+            dist_type w = weight(gr.edge_value(i));
+            if(w < dist_type()){
+                throw std::invalid_argument("negative edge weight");
+            }
+            auto v = targets[i];
+            auto candidate = top.m_key + w;
+            if(candidate < distance[v]){
+                distance[v] = candidate;
+                parent[v] = u;
+                heap.push_or_decrease(v, candidate);
+            }
+        }
+    }
+    return result;
+}
+
+template<class ValT, class EdgeT, class WeightF>
+sssp_result<weight_t<EdgeT, WeightF>> delta_stepping(const csr_graph<ValT, EdgeT> &gr,
+    index_type source, weight_t<EdgeT, WeightF> delta, thread_pool &pool, WeightF weight)
+{
+    using dist_type = weight_t<EdgeT, WeightF>;
+    using result_type = sssp_result<dist_type>;
+    const size_t grain = 64;
+    const auto n = gr.node_count();
+    if(source >= n){
+        throw std::out_of_range("source is not a node of a graph");
+    }
+    if(!(dist_type() < delta)){
+        throw std::invalid_argument("delta has to be positive");
+    }
+    const auto& offsets = gr.offsets();
+    const auto& targets = gr.targets();
+    const auto unreachable = result_type::unreachable();
+    const auto npos = std::numeric_limits<size_t>::max();
+    auto bucket_of = [delta](dist_type d){ return static_cast<size_t>(d / delta); };
+
+    // weights are checked up front, the heaviest edge bounds how far past current bucket a relaxation lands
+    std::vector<dist_type> heaviest(pool.size(), dist_type());
+    std::atomic<bool> negative(false);
+    pool.parallel_for(0, n, 1024, [&](size_t b, size_t e, size_t worker){
+        auto heavy = heaviest[worker];
+        for(auto j=offsets[b]; j<offsets[e]; j++){
+            dist_type w = weight(gr.edge_value(j));
+            if(w < dist_type()){
+                negative.store(true, std::memory_order_relaxed);
+            }else if(heavy < w){
+                heavy = w;
+            }
+        }
+        heaviest[worker] = heavy;
+    });
+    if(negative.load()){
+        throw std::invalid_argument("negative edge weight");
+    }
+    const size_t ring_cap = 1024;
+    const auto max_weight = *std::max_element(heaviest.begin(), heaviest.end());
+    const size_t ring = max_weight / delta < dist_type(ring_cap - 2) ? bucket_of(max_weight) + 2 : ring_cap;
+
+    result_type result;
+    result.m_distance.resize(n);
+    result.m_parent.assign(n, result_type::none);
+    auto& parent = result.m_parent;
+    std::unique_ptr<std::atomic<dist_type>[]> distance(new std::atomic<dist_type>[n]);
+    std::unique_ptr<std::atomic<bool>[]> locked(new std::atomic<bool>[n]); // guards distance and parent of a node
+    pool.parallel_for(0, n, 4096, [&](size_t b, size_t e, size_t){
+        for(auto v=b; v<e; v++){
+            distance[v].store(unreachable, std::memory_order_relaxed);
+            locked[v].store(false, std::memory_order_relaxed);
+        }
+    });
+    distance[source].store(dist_type(), std::memory_order_relaxed);
+    parent[source] = source;
+
+    // bins[worker][bucket % ring]: nodes whose distance dropped into a bucket of [bucket, bucket+ring),
+    // far[worker]: ones past that window. Both may repeat nodes or be stale
+    std::vector<std::vector<std::vector<index_type>>> bins(pool.size(), std::vector<std::vector<index_type>>(ring));
+    std::vector<std::vector<index_type>> far(pool.size());
+    std::vector<size_t> far_min(pool.size(), npos); // lowest bucket put into far, may be stale
+    std::vector<index_type> frontier{source};
+    size_t bucket = 0;
+    auto lowest = [&]{
+        for(size_t k=0; k<ring; k++){
+            for(const auto& own:bins){
+                if(!own[(bucket+k) % ring].empty()){
+                    return bucket+k;
+                }
+            }
+        }
+        return npos;
+    };
+    while(true){
+        pool.parallel_for(0, frontier.size(), grain, [&](size_t b, size_t e, size_t worker){
+            auto& own = bins[worker];
+            for(auto i=b; i<e; i++){
+                auto u = frontier[i];
+                auto du = distance[u].load(std::memory_order_relaxed);
+                if(bucket_of(du) != bucket){
+                    continue; // moved to a later bucket by a newer relaxation
+                }
+                for(auto j=offsets[u]; j<offsets[u+1]; j++){
+                    auto v = targets[j];
+                    auto candidate = du + weight(gr.edge_value(j));
+                    if(!(candidate < distance[v].load(std::memory_order_relaxed))){
+                        continue;
+                    }
+                    // parent is set with distance, so it's the node that gave the final distance first
+                    while(locked[v].exchange(true, std::memory_order_acquire)){}
+                    bool relaxed = candidate < distance[v].load(std::memory_order_relaxed);
+                    if(relaxed){
+                        distance[v].store(candidate, std::memory_order_relaxed);
+                        parent[v] = u;
+                    }
+                    locked[v].store(false, std::memory_order_release);
+                    if(relaxed){
+                        auto target = bucket_of(candidate);
+                        if(target - bucket < ring){
+                            own[target % ring].emplace_back(v);
+                        }else{
+                            far[worker].emplace_back(v);
+                            far_min[worker] = std::min(far_min[worker], target);
+                        }
+                    }
+                }
+            }
+        });
+        // relaxations never go below current bucket, so the next one is the lowest non-empty in the window
+        auto next = lowest();
+        auto far_next = *std::min_element(far_min.begin(), far_min.end());
+        if(far_next != npos && (next == npos || far_next - bucket < ring)){
+            // far nodes enter the window once it reaches them, an empty window jumps to the lowest of them.
+            // Nodes settled since they were put aside are dropped
+            auto base = bucket;
+            if(next == npos){
+                base = npos;
+                for(const auto& own:far){
+                    for(auto v:own){
+                        auto target = bucket_of(distance[v].load(std::memory_order_relaxed));
+                        if(target > bucket && target < base){
+                            base = target;
+                        }
+                    }
+                }
+            }
+            for(size_t worker=0; worker<far.size(); worker++){
+                auto& own = far[worker];
+                auto kept = own.begin();
+                far_min[worker] = npos;
+                for(auto v:own){
+                    auto target = bucket_of(distance[v].load(std::memory_order_relaxed));
+                    if(target <= bucket){
+                        continue;
+                    }
+                    if(target - base < ring){
+                        bins[worker][target % ring].emplace_back(v);
+                    }else{
+                        *kept++ = v;
+                        far_min[worker] = std::min(far_min[worker], target);
+                    }
+                }
+                own.erase(kept, own.end());
+            }
+            if(base != npos){
+                bucket = base;
+                next = lowest();
+            }
+        }
+        if(next == npos){
+            break;
+        }
+        bucket = next;
+        frontier.clear();
+        for(auto& own:bins){
+            auto& slot = own[bucket % ring];
+            frontier.insert(frontier.end(), slot.begin(), slot.end());
+            slot.clear();
+        }
+    }
+
+    auto& dist_out = result.m_distance;
+    pool.parallel_for(0, n, 4096, [&](size_t b, size_t e, size_t){
+        for(auto v=b; v<e; v++){
+            dist_out[v] = distance[v].load(std::memory_order_relaxed);
+        }
+    });
+    return result;
+}
+
+template<class ValT, class EdgeT>
+sssp_result<EdgeT> delta_stepping(const csr_graph<ValT, EdgeT> &gr, index_type source, EdgeT delta){
+    thread_pool pool;
+    return delta_stepping(gr, source, delta, pool);
+}
+
+template<class ValT, class EdgeT>
+std::uint64_t triangle_count(const csr_graph<ValT, EdgeT> &gr, thread_pool &pool){
+    if(gr.is_directed()){
+        throw std::invalid_argument("triangles are counted in undirected graphs");
+    }
+    const auto& offsets = gr.offsets();
+    const auto targets = gr.targets().data();
+    // row of "v" past neighbours not greater than "bound"
+    auto higher = [&](index_type v, index_type bound){
+        return std::upper_bound(targets + offsets[v], targets + offsets[v+1], bound);
+    };
+    std::vector<std::uint64_t> counts(pool.size());
+    pool.parallel_for(0, gr.node_count(), 256, [&](size_t b, size_t e, size_t worker){
+        std::uint64_t count = 0;
+        for(auto v = index_type(b); v < e; v++){
+            auto row_end = targets + offsets[v+1];
+            for(auto it = higher(v, v); it != row_end; ++it){
+                auto u = *it;
+                auto u_higher = higher(u, u);
+                auto u_end = targets + offsets[u+1];
+                count += intersection_size(it+1, size_t(row_end - (it+1)), u_higher, size_t(u_end - u_higher));
+            }
+        }
+        counts[worker] += count;
+    });
+    std::uint64_t total = 0;
+    for(auto c:counts){
+        total += c;
+    }
+    return total;
+}
+
+template<class ValT, class EdgeT>
+std::uint64_t triangle_count(const csr_graph<ValT, EdgeT> &gr){
+    thread_pool pool;
+    return triangle_count(gr, pool);
+}
+
+template<class ValT, class EdgeT>
+path_searcher<ValT, EdgeT>::path_searcher(const csr_graph<ValT, EdgeT> &gr)
+    :m_graph(gr), m_stamp(gr.node_count(), 0), m_parent(gr.node_count())
+{}
+
+template<class ValT, class EdgeT>
+auto path_searcher<ValT, EdgeT>::shortest_path(index_type source, index_type target)
+    ->path
+{
+    const auto n = m_graph.node_count();
+    if(source >= n || target >= n){
+        throw std::out_of_range("source or target is not a node of a graph");
+    }
+    if(source == target){
+        return path{source};
+    }
+    if(++m_epoch == std::numeric_limits<std::uint32_t>::max()/2){
+        // stamps of old epochs could match again
+        std::fill(m_stamp.begin(), m_stamp.end(), 0);
+        m_epoch = 1;
+    }
+    // rows of forward side and in-rows of backward one, the same for an undirected graph
+    const typename csr_graph<ValT, EdgeT>::offset_type* offsets_of[2] = {m_graph.offsets().data(), m_graph.in_offsets().data()};
+    const index_type* targets_of[2] = {m_graph.targets().data(), m_graph.in_sources().data()};
+    const std::uint32_t stamp[2] = {2*m_epoch, 2*m_epoch+1};
+    m_stamp[source] = stamp[0];
+    m_stamp[target] = stamp[1];
+    m_parent[source] = source;
+    m_parent[target] = target;
+    m_frontier[0].assign(1, source);
+    m_frontier[1].assign(1, target);
+    std::uint64_t frontier_edges[2] = {m_graph.degree(source), m_graph.in_degree(target)};
+    while(!m_frontier[0].empty() && !m_frontier[1].empty()){
+        // whole level of one side: first meeting is on a shortest path
+        const int side = frontier_edges[0] <= frontier_edges[1]? 0 : 1;
+        const auto offsets = offsets_of[side];
+        const auto targets = targets_of[side];
+        m_next.clear();
+        std::uint64_t next_edges = 0;
+        for(auto u:m_frontier[side]){
+            for(auto it = targets + offsets[u], end = targets + offsets[u+1]; it != end; ++it){
+                auto w = *it;
+                if(m_stamp[w] == stamp[side]){
+                    continue;
+                }
+                if(m_stamp[w] == stamp[1-side]){
+                    // u is on the side of "side" root, w on the other one
+                    path forward, backward;
+                    auto from = side == 0? u : w, to = side == 0? w : u;
+                    for(auto v = from; ; v = m_parent[v]){
+                        forward.emplace_back(v);
+                        if(v == source){
+                            break;
+                        }
+                    }
+                    std::reverse(forward.begin(), forward.end());
+                    for(auto v = to; ; v = m_parent[v]){
+                        forward.emplace_back(v);
+                        if(v == target){
+                            break;
+                        }
+                    }
+                    return forward;
+                }
+                m_stamp[w] = stamp[side];
+                m_parent[w] = u;
+                m_next.emplace_back(w);
+                next_edges += offsets[w+1] - offsets[w];
+            }
+        }
+        m_frontier[side].swap(m_next);
+        frontier_edges[side] = next_edges;
+    }
+    return path();
+}
+
+template<class ValT, class EdgeT>
+path shortest_path(const csr_graph<ValT, EdgeT> &gr, index_type source, index_type target){
+    return path_searcher<ValT, EdgeT>(gr).shortest_path(source, target);
+}
+
+template<class ValT, class EdgeT>
+std::vector<path> shortest_paths(const csr_graph<ValT, EdgeT> &gr,
+    const std::vector<std::pair<index_type, index_type>> &queries, thread_pool &pool)
+{
+    // checked up front, so no query runs if any of them is bad
+    for(const auto& q:queries){
+        if(q.first >= gr.node_count() || q.second >= gr.node_count()){
+            throw std::out_of_range("source or target is not a node of a graph");
+        }
+    }
+    std::vector<path> result(queries.size());
+    // searchers are made by workers that get any query
+    std::vector<std::unique_ptr<path_searcher<ValT, EdgeT>>> searchers(pool.size());
+    pool.parallel_for(0, queries.size(), 16, [&](size_t b, size_t e, size_t worker){
+        auto& searcher = searchers[worker];
+        if(!searcher){
+            searcher.reset(new path_searcher<ValT, EdgeT>(gr));
+        }
+        for(auto i=b; i<e; i++){
+            result[i] = searcher->shortest_path(queries[i].first, queries[i].second);
+        }
+    });
+    return result;
+}
+
+template<class ValT, class EdgeT>
+std::vector<path> shortest_paths(const csr_graph<ValT, EdgeT> &gr,
+    const std::vector<std::pair<index_type, index_type>> &queries)
+{
+    thread_pool pool;
+    return shortest_paths(gr, queries, pool);
+}
+
+template<class ValT, class EdgeT, class T>
+void spmv(const csr_graph<ValT, EdgeT> &gr, const std::vector<T> &x, std::vector<T> &y, thread_pool &pool){
+    const auto& offsets = gr.in_offsets();
+    const auto targets = gr.in_sources().data();
+    y.resize(gr.node_count());
+    pool.parallel_for(0, gr.node_count(), 1024, [&](size_t b, size_t e, size_t){
+        for(auto v=b; v<e; v++){
+            y[v] = detail::gather_sum(targets + offsets[v], targets + offsets[v+1], x.data());
+        }
+    });
+}
+
+template<class ValT, class EdgeT, class T, class WeightF>
+void spmv(const csr_graph<ValT, EdgeT> &gr, const std::vector<T> &x, std::vector<T> &y,
+    thread_pool &pool, WeightF weight)
+{
+    const auto& offsets = gr.in_offsets();
+    const auto targets = gr.in_sources().data();
+    y.resize(gr.node_count());
+    pool.parallel_for(0, gr.node_count(), 1024, [&](size_t b, size_t e, size_t){
+        for(auto v=b; v<e; v++){
+            T sum = T();
+            for(auto o=offsets[v]; o<offsets[v+1]; o++){
+                sum += T(weight(gr.edge_value(gr.in_edge(o)))) * x[targets[o]];
+            }
+            y[v] = sum;
+        }
+    });
+}
+
+template<class ValT, class EdgeT>
+pagerank_result pagerank(const csr_graph<ValT, EdgeT> &gr, thread_pool &pool,
+    double damping, double tolerance, size_t max_iterations)
+{
+    const size_t grain = 1024;
+    const auto n = gr.node_count();
+    pagerank_result result;
+    result.m_converged = false;
+    if(n == 0){
+        result.m_converged = true;
+        return result;
+    }
+    const auto& offsets = gr.offsets();
+    const auto& in_offsets = gr.in_offsets();
+    const auto in_sources = gr.in_sources().data();
+    auto& rank = result.m_rank;
+    rank.assign(n, 1.0/n);
+    // share of rank a node gives to each neighbour, in two generations
+    std::vector<double> share(n), next_share(n);
+    double dangling = 0; // rank of nodes without edges
+    for(size_t v=0; v<n; v++){
+        auto degree = offsets[v+1] - offsets[v];
+        if(degree){
+            share[v] = rank[v] / degree;
+        }else{
+            dangling += rank[v];
+        }
+    }
+    // sums per chunk, added in order to keep results independent of scheduling
+    const auto chunks = (n + grain - 1) / grain;
+    std::vector<double> chunk_error(chunks), chunk_dangling(chunks);
+    for(size_t i=0; i<max_iterations; i++){
+        auto start = std::chrono::steady_clock::now();
+        const double base = (1 - damping + damping * dangling) / n;
+        pool.parallel_for(0, n, grain, [&](size_t b, size_t e, size_t){
+            // a pool may run the whole range at once, it's still summed by chunks
+            for(auto chunk = b; chunk < e; chunk += grain){
+                double error = 0, lost = 0;
+                for(auto v = chunk; v < std::min(chunk + grain, e); v++){
+                    auto row = in_sources + in_offsets[v], row_end = in_sources + in_offsets[v+1];
+                    auto new_rank = base + damping * detail::gather_sum(row, row_end, share.data());
+                    error += std::abs(new_rank - rank[v]);
+                    rank[v] = new_rank;
+                    if(auto degree = offsets[v+1] - offsets[v]){
+                        next_share[v] = new_rank / degree;
+                    }else{
+                        lost += new_rank;
+                    }
+                }
+                chunk_error[chunk / grain] = error;
+                chunk_dangling[chunk / grain] = lost;
+            }
+        });
+        share.swap(next_share);
+        double error = 0;
+        dangling = 0;
+        for(size_t c=0; c<chunks; c++){
+            error += chunk_error[c];
+            dangling += chunk_dangling[c];
+        }
+        result.m_iterations.emplace_back(pagerank_iteration{error,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)});
+        if(error < tolerance){
+            result.m_converged = true;
+            break;
+        }
+    }
+    return result;
+}
+
+template<class ValT, class EdgeT>
+pagerank_result pagerank(const csr_graph<ValT, EdgeT> &gr, double damping, double tolerance, size_t max_iterations){
+    thread_pool pool;
+    return pagerank(gr, pool, damping, tolerance, max_iterations);
+}
+
+template<class ValT, class EdgeT>
+std::vector<index_type> topological_sort(const csr_graph<ValT, EdgeT> &dag){
+    const auto n = dag.node_count();
+    const auto& offsets = dag.offsets();
+    const auto& targets = dag.targets();
+    std::vector<index_type> pending(n, 0); // predecessors not yet in order
+    for(auto v:targets){
+        pending[v]++;
+    }
+    // order doubles as a queue, nodes after "head" are not expanded yet
+    std::vector<index_type> order;
+    order.reserve(n);
+    for(index_type v=0; v<n; v++){
+        if(pending[v] == 0){
+            order.emplace_back(v);
+        }
+    }
+    for(size_t head=0; head<order.size(); head++){
+        auto v = order[head];
+        for(auto o=offsets[v]; o<offsets[v+1]; o++){
+            if(--pending[targets[o]] == 0){
+                order.emplace_back(targets[o]);
+            }
+        }
+    }
+    if(order.size() != n){
+        throw std::invalid_argument("graph has a cycle");
+    }
+    return order;
+}
+
+template<class ValT, class EdgeT, class F>
+void dag_executor::run(const csr_graph<ValT, EdgeT> &dag, F &&task){
+    const auto n = dag.node_count();
+    const auto& offsets = dag.offsets();
+    const auto targets = dag.targets().data();
+    std::unique_ptr<std::atomic<index_type>[]> pending(new std::atomic<index_type>[n]);
+    {
+        std::vector<index_type> in_degree(n, 0);
+        for(auto o=offsets[0]; o<offsets[n]; o++){
+            in_degree[targets[o]]++;
+        }
+        for(size_t v=0; v<n; v++){
+            pending[v].store(in_degree[v], std::memory_order_relaxed);
+        }
+    }
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<index_type> ready;
+    for(index_type v=0; v<n; v++){
+        if(pending[v].load(std::memory_order_relaxed) == 0){
+            ready.emplace_back(v);
+        }
+    }
+    size_t running = 0, done = 0;
+    std::exception_ptr error;
+    m_pool.run([&](size_t){
+        std::vector<index_type> released;
+        index_type v = 0;
+        bool have = false; // "v" is released by previous task of this worker
+        while(true){
+            if(!have){
+                std::unique_lock<std::mutex> lock(mutex);
+                // nothing ready and nothing running means nothing will be
+                wake.wait(lock, [&]{ return !ready.empty() || running == 0 || error; });
+                if(ready.empty() || error){
+                    return;
+                }
+                v = ready.back();
+                ready.pop_back();
+                running++;
+            }
+            try{
+                task(v);
+            }catch(...){
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!error){
+                    error = std::current_exception();
+                }
+                running--;
+                wake.notify_all();
+                return;
+            }
+            released.clear();
+            for(auto o=offsets[v]; o<offsets[v+1]; o++){
+                if(pending[targets[o]].fetch_sub(1, std::memory_order_acq_rel) == 1){
+                    released.emplace_back(targets[o]);
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            done++;
+            have = !released.empty() && !error;
+            if(have){
+                v = released.back();
+                released.pop_back();
+                ready.insert(ready.end(), released.begin(), released.end());
+                for(size_t i=0; i<released.size(); i++){
+                    wake.notify_one();
+                }
+            }else{
+                ready.insert(ready.end(), released.begin(), released.end());
+                if(--running == 0 || error){
+                    wake.notify_all();
+                }
+            }
+        }
+    });
+    if(error){
+        std::rethrow_exception(error);
+    }
+    if(done != n){
+        throw std::invalid_argument("graph has a cycle");
+    }
+}
+
+};
+};
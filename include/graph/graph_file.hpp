@@ -0,0 +1,414 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csr_graph.hpp"
+
+namespace cxx_graph{
+
+/**
+ * Binary graph file, native byte order:
+ * header, then offsets, targets, node values and edge values sections,
+ * each section starts at a 64 byte boundary.
+ * Header and every section carry a checksum.
+ */
+namespace graph_file{
+
+constexpr char magic[8] = {'C', 'X', 'X', 'G', 'R', 'A', 'P', 'H'};
+constexpr std::uint32_t version = 2;
+constexpr std::uint32_t byte_order = 0x01020304; // reads differently on a foreign byte order
+constexpr size_t alignment = 64;
+
+enum section_id{ offsets_section, targets_section, values_section, edge_values_section, section_count };
+constexpr std::uint64_t directed_flag = 1; // header flag: rows hold outgoing edges only
+
+struct section{
+    std::uint64_t m_pos;      // from file start
+    std::uint64_t m_size;     // in bytes
+    std::uint64_t m_checksum;
+};
+
+struct header{
+    char m_magic[8];
+    std::uint32_t m_version;
+    std::uint32_t m_byte_order;
+    std::uint32_t m_value_size;      // sizeof node value
+    std::uint32_t m_edge_value_size; // sizeof edge value, 0 for empty payload
+    std::uint64_t m_node_count;
+    std::uint64_t m_adjacency_count;
+    std::uint64_t m_flags;
+    section m_sections[section_count];
+    std::uint64_t m_checksum;        // of all fields above
+};
+
+/**
+ * Word-at-a-time 64 bit hash, not cryptographic
+ */
+inline std::uint64_t checksum(const void *data, size_t size){
+    const std::uint64_t k1 = 0x9e3779b97f4a7c15ull, k2 = 0xc2b2ae3d27d4eb4full;
+    auto bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t h = size * k1;
+    auto mix = [&](std::uint64_t w){
+        h ^= w * k2;
+        h = (h << 31) | (h >> 33);
+        h *= k1;
+    };
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8){
+        std::uint64_t w;
+        std::memcpy(&w, bytes + i, 8);
+        mix(w);
+    }
+    if(i < size){
+        std::uint64_t w = 0;
+        std::memcpy(&w, bytes + i, size - i);
+        mix(w);
+    }
+    return h ^ (h >> 29);
+}
+
+inline std::uint64_t header_checksum(const header &h){
+    return checksum(&h, offsetof(header, m_checksum));
+}
+
+/**
+ * Header with section positions and sizes, checksums are left zero
+ * @param edge_value_size 0 for empty payload
+ * @param flags header flags, e.g. directed_flag
+ */
+inline header make_header(std::uint32_t value_size, std::uint32_t edge_value_size,
+    std::uint64_t node_count, std::uint64_t adjacency_count, std::uint64_t flags = 0)
+{
+    header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.m_magic, magic, sizeof(h.m_magic));
+    h.m_version = version;
+    h.m_byte_order = byte_order;
+    h.m_value_size = value_size;
+    h.m_edge_value_size = edge_value_size;
+    h.m_node_count = node_count;
+    h.m_adjacency_count = adjacency_count;
+    h.m_flags = flags;
+    const std::uint64_t sizes[section_count] = {
+        (node_count + 1) * sizeof(std::uint64_t),
+        adjacency_count * sizeof(std::uint32_t),
+        node_count * value_size,
+        adjacency_count * edge_value_size
+    };
+    auto align = [](std::uint64_t pos){
+        return (pos + alignment - 1) / alignment * alignment;
+    };
+    std::uint64_t pos = align(sizeof(h));
+    for(size_t i=0; i<section_count; i++){
+        h.m_sections[i].m_pos = pos;
+        h.m_sections[i].m_size = sizes[i];
+        pos = align(pos + sizes[i]);
+    }
+    return h;
+}
+
+};
+
+/**
+ * Read-only CSR graph backed by a memory-mapped graph file.
+ * Opening checks the header and the first and last offset, O(1), pages are loaded on first access.
+ * Damage inside sections is found by verify().
+ * Same queries as csr_graph.
+ */
+template<class ValT, class EdgeT = no_payload>
+class mapped_graph{
+    static_assert(std::is_trivially_copyable<ValT>::value, "node values are stored as raw bytes");
+    static_assert(std::is_trivially_copyable<EdgeT>::value, "edge values are stored as raw bytes");
+public:
+    using value_type = ValT;
+    using edge_value_type = EdgeT;
+    using index_type = typename csr_graph<ValT, EdgeT>::index_type;
+    using offset_type = typename csr_graph<ValT, EdgeT>::offset_type;
+    using neighbors_range = typename csr_graph<ValT, EdgeT>::neighbors_range;
+
+    /**
+     * @throw std::runtime_error if file can't be mapped or isn't a graph file of these types
+     */
+    explicit mapped_graph(const std::string &path);
+    mapped_graph(mapped_graph &&rhs);
+    mapped_graph& operator=(mapped_graph &&rhs);
+    mapped_graph(const mapped_graph&) = delete;
+    mapped_graph& operator=(const mapped_graph&) = delete;
+    ~mapped_graph();
+
+    size_t node_count()const{ return m_header->m_node_count; }
+    /**
+     * Rows of a directed graph hold outgoing edges, in-rows are built by to_csr()
+     */
+    bool is_directed()const{ return m_header->m_flags & graph_file::directed_flag; }
+    /**
+     * @return count of stored adjacencies, undirected edge is counted twice, directed one once
+     */
+    size_t edge_count()const{ return m_header->m_adjacency_count; }
+    size_t degree(index_type v)const{ return m_offsets[v+1] - m_offsets[v]; }
+    neighbors_range neighbors(index_type v)const{
+        return neighbors_range(m_targets + m_offsets[v], m_targets + m_offsets[v+1]);
+    }
+    const value_type& value(index_type v)const{ return m_values[v]; }
+    const edge_value_type& edge_value(offset_type offset)const;
+    /**
+     * In a directed graph checks for an edge from "a" to "b"
+     */
+    bool is_adjacent(index_type a, index_type b)const;
+
+    const offset_type* offsets()const{ return m_offsets; }
+    const index_type* targets()const{ return m_targets; }
+    const value_type* values()const{ return m_values; }
+    /**
+     * Checks checksums of all sections, reads whole file
+     */
+    bool verify()const;
+    /**
+     * Copies graph into memory
+     */
+    csr_graph<value_type, edge_value_type> to_csr()const;
+private:
+    void* m_map = nullptr;
+    size_t m_size = 0;
+    const graph_file::header* m_header = nullptr;
+    const offset_type* m_offsets = nullptr;
+    const index_type* m_targets = nullptr;
+    const value_type* m_values = nullptr;
+    const edge_value_type* m_edge_values = nullptr;
+
+    void p_unmap();
+    const void* p_section(graph_file::section_id id, size_t expected_size)const;
+};
+
+/**
+ * Writes graph file, sections go with one write each.
+ * File is written under a temporary name and renamed, so readers never see a partial file.
+ * @throw std::runtime_error on I/O error
+ */
+template<class ValT, class EdgeT>
+void save_csr(const csr_graph<ValT, EdgeT> &gr, const std::string &path);
+/**
+ * Writes a graph with to_csr(), e.g. cxx_graph::graph, as a graph file.
+ * Nodes are numbered like in to_csr().
+ * @throw std::runtime_error on I/O error
+ */
+template<class Graph>
+void save_graph(const Graph &gr, const std::string &path);
+/**
+ * Maps a graph file written by save_graph() as a read-only view of Graph types in O(1)
+ * @throw std::runtime_error if file can't be mapped or doesn't match value types
+ */
+template<class Graph>
+mapped_graph<typename Graph::value_type, typename Graph::edge_value_type> load_mmap(const std::string &path);
+
+template<class ValT, class EdgeT>
+mapped_graph<ValT, EdgeT>::mapped_graph(const std::string &path){
+    auto fail = [&](const char *what){
+        p_unmap();
+        throw std::runtime_error(path + ": " + what);
+    };
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        fail("can't open");
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(graph_file::header)){
+        ::close(fd);
+        fail("not a graph file");
+    }
+    m_size = size_t(st.st_size);
+    auto map = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED){
+        fail("can't map");
+    }
+    m_map = map;
+    m_header = static_cast<const graph_file::header*>(m_map);
+    const auto& h = *m_header;
+    if(std::memcmp(h.m_magic, graph_file::magic, sizeof(graph_file::magic)) != 0){
+        fail("not a graph file");
+    }
+    if(h.m_version != graph_file::version || h.m_byte_order != graph_file::byte_order
+        || (h.m_flags & ~graph_file::directed_flag))
+    {
+        fail("unsupported version or byte order");
+    }
+    if(h.m_checksum != graph_file::header_checksum(h)){
+        fail("header checksum mismatch");
+    }
+    const size_t edge_value_size = std::is_empty<edge_value_type>::value? 0 : sizeof(edge_value_type);
+    if(h.m_value_size != sizeof(value_type) || h.m_edge_value_size != edge_value_size){
+        fail("value types don't match");
+    }
+    const auto n = h.m_node_count, m = h.m_adjacency_count;
+    m_offsets = static_cast<const offset_type*>(p_section(graph_file::offsets_section, (n+1)*sizeof(offset_type)));
+    m_targets = static_cast<const index_type*>(p_section(graph_file::targets_section, m*sizeof(index_type)));
+    m_values = static_cast<const value_type*>(p_section(graph_file::values_section, n*sizeof(value_type)));
+    auto edge_values = p_section(graph_file::edge_values_section, m*edge_value_size);
+    if(!m_offsets || !m_targets || !m_values || !edge_values){
+        fail("sections are out of file");
+    }
+    // rows are bounded by these two, inner offsets are checked by verify()
+    if(m_offsets[0] != 0 || m_offsets[n] != m){
+        fail("offsets don't match adjacency count");
+    }
+    if(edge_value_size){
+        m_edge_values = static_cast<const edge_value_type*>(edge_values);
+    }
+}
+
+template<class ValT, class EdgeT>
+mapped_graph<ValT, EdgeT>::mapped_graph(mapped_graph &&rhs){
+    *this = std::move(rhs);
+}
+
+template<class ValT, class EdgeT>
+auto mapped_graph<ValT, EdgeT>::operator=(mapped_graph &&rhs)
+    ->mapped_graph&
+{
+    if(this != &rhs){
+        p_unmap();
+        std::swap(m_map, rhs.m_map);
+        std::swap(m_size, rhs.m_size);
+        std::swap(m_header, rhs.m_header);
+        std::swap(m_offsets, rhs.m_offsets);
+        std::swap(m_targets, rhs.m_targets);
+        std::swap(m_values, rhs.m_values);
+        std::swap(m_edge_values, rhs.m_edge_values);
+    }
+    return *this;
+}
+
+template<class ValT, class EdgeT>
+mapped_graph<ValT, EdgeT>::~mapped_graph(){
+    p_unmap();
+}
+
+template<class ValT, class EdgeT>
+void mapped_graph<ValT, EdgeT>::p_unmap(){
+    if(m_map){
+        ::munmap(m_map, m_size);
+    }
+    m_map = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_offsets = nullptr;
+    m_targets = nullptr;
+    m_values = nullptr;
+    m_edge_values = nullptr;
+}
+
+template<class ValT, class EdgeT>
+const void* mapped_graph<ValT, EdgeT>::p_section(graph_file::section_id id, size_t expected_size)const{
+    const auto& s = m_header->m_sections[id];
+    if(s.m_size != expected_size || s.m_pos % graph_file::alignment != 0
+        || s.m_pos > m_size || s.m_size > m_size - s.m_pos)
+    {
+        return nullptr;
+    }
+    return static_cast<const char*>(m_map) + s.m_pos;
+}
+
+template<class ValT, class EdgeT>
+auto mapped_graph<ValT, EdgeT>::edge_value(offset_type offset)const
+    ->const edge_value_type&
+{
+    static const edge_value_type empty{};
+    return m_edge_values? m_edge_values[offset] : empty;
+}
+
+template<class ValT, class EdgeT>
+bool mapped_graph<ValT, EdgeT>::is_adjacent(index_type a, index_type b)const{
+    if(!is_directed() && degree(a) > degree(b)){
+        std::swap(a, b);
+    }
+    auto row = neighbors(a);
+    return std::binary_search(row.begin(), row.end(), b);
+}
+
+template<class ValT, class EdgeT>
+bool mapped_graph<ValT, EdgeT>::verify()const{
+    for(const auto& s:m_header->m_sections){
+        if(graph_file::checksum(static_cast<const char*>(m_map) + s.m_pos, s.m_size) != s.m_checksum){
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class ValT, class EdgeT>
+auto mapped_graph<ValT, EdgeT>::to_csr()const
+    ->csr_graph<value_type, edge_value_type>
+{
+    const auto n = node_count(), m = edge_count();
+    return csr_graph<value_type, edge_value_type>(
+        std::vector<offset_type>(m_offsets, m_offsets + n + 1),
+        std::vector<index_type>(m_targets, m_targets + m),
+        std::vector<value_type>(m_values, m_values + n),
+        m_edge_values? std::vector<edge_value_type>(m_edge_values, m_edge_values + m)
+            : std::vector<edge_value_type>(),
+        is_directed());
+}
+
+template<class ValT, class EdgeT>
+void save_csr(const csr_graph<ValT, EdgeT> &gr, const std::string &path){
+    static_assert(std::is_trivially_copyable<ValT>::value, "node values are stored as raw bytes");
+    static_assert(std::is_trivially_copyable<EdgeT>::value, "edge values are stored as raw bytes");
+    static_assert(sizeof(typename csr_graph<ValT, EdgeT>::offset_type) == sizeof(std::uint64_t)
+        && sizeof(typename csr_graph<ValT, EdgeT>::index_type) == sizeof(std::uint32_t), "file layout");
+    const bool has_payload = !std::is_empty<EdgeT>::value;
+    const void* data[graph_file::section_count] = {
+        gr.offsets().data(), gr.targets().data(), gr.values().data(),
+        has_payload? gr.edge_values().data() : nullptr
+    };
+    auto h = graph_file::make_header(sizeof(ValT), has_payload? sizeof(EdgeT) : 0,
+        gr.node_count(), gr.edge_count(), gr.is_directed()? graph_file::directed_flag : 0);
+    for(size_t i=0; i<graph_file::section_count; i++){
+        auto& s = h.m_sections[i];
+        s.m_checksum = graph_file::checksum(data[i], s.m_size);
+    }
+    h.m_checksum = graph_file::header_checksum(h);
+
+    const auto tmp_path = path + ".tmp";
+    auto file = std::fopen(tmp_path.c_str(), "wb");
+    if(!file){
+        throw std::runtime_error(tmp_path + ": can't open for writing");
+    }
+    // sections are big, buffering them would only add a copy
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    const char zeros[graph_file::alignment] = {};
+    bool ok = std::fwrite(&h, sizeof(h), 1, file) == 1;
+    std::uint64_t written = sizeof(h);
+    for(size_t i=0; i<graph_file::section_count && ok; i++){
+        const auto& s = h.m_sections[i];
+        ok = std::fwrite(zeros, 1, s.m_pos - written, file) == s.m_pos - written
+            && (s.m_size == 0 || std::fwrite(data[i], 1, s.m_size, file) == s.m_size);
+        written = s.m_pos + s.m_size;
+    }
+    ok = (std::fclose(file) == 0) && ok;
+    if(!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0){
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error(path + ": write failed");
+    }
+}
+
+template<class Graph>
+void save_graph(const Graph &gr, const std::string &path){
+    save_csr(gr.to_csr(), path);
+}
+
+template<class Graph>
+mapped_graph<typename Graph::value_type, typename Graph::edge_value_type> load_mmap(const std::string &path){
+    return mapped_graph<typename Graph::value_type, typename Graph::edge_value_type>(path);
+}
+
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace cxx_graph{
+
+/**
+ * Lists whose sizes differ more than this many times are intersected by galloping
+ */
+constexpr size_t gallop_ratio = 32;
+
+/**
+ * Intersection of two sorted ranges, compared by key(element).
+ * Similar sizes are merged, skewed ones are galloped: each element of a
+ * short range is found in a long one by exponential and binary search,
+ * O(n log(m/n)).
+ * @param emit functor called as emit(element of first range, element of second one) for each match
+ */
+template<class It1, class It2, class Key, class F>
+void intersect(It1 a, It1 a_end, It2 b, It2 b_end, Key key, F &&emit){
+    auto na = size_t(std::distance(a, a_end)), nb = size_t(std::distance(b, b_end));
+    if(na * gallop_ratio < nb || nb * gallop_ratio < na){
+        bool swapped = na > nb;
+        auto gallop = [&](auto small, auto small_end, auto large, auto large_end){
+            for(; small != small_end && large != large_end; ++small){
+                auto k = key(*small);
+                // exponential search for a range that holds k, then binary search in it
+                size_t step = 1;
+                auto lo = large;
+                auto left = size_t(std::distance(large, large_end));
+                while(step < left && key(*std::next(lo, step)) < k){
+                    step *= 2;
+                }
+                auto hi = std::next(lo, std::min(step+1, left));
+                large = std::lower_bound(lo, hi, k, [&](const auto &e, const auto &val){
+                    return key(e) < val;
+                });
+                if(large != large_end && !(k < key(*large))){
+                    if(swapped){
+                        emit(*large, *small);
+                    }else{
+                        emit(*small, *large);
+                    }
+                }
+            }
+        };
+        if(swapped){
+            gallop(b, b_end, a, a_end);
+        }else{
+            gallop(a, a_end, b, b_end);
+        }
+        return;
+    }
+    while(a != a_end && b != b_end){
+        auto ka = key(*a), kb = key(*b);
+        if(ka < kb){
+            ++a;
+        }else if(kb < ka){
+            ++b;
+        }else{
+            emit(*a, *b);
+            ++a;
+            ++b;
+        }
+    }
+}
+
+/**
+ * Size of intersection of two sorted arrays without duplicates.
+ * Similar sizes are compared four by four with SSE2 where available,
+ * skewed ones are galloped.
+ */
+inline size_t intersection_size(const std::uint32_t *a, size_t na, const std::uint32_t *b, size_t nb){
+    size_t count = 0;
+    auto identity = [](std::uint32_t x){ return x; };
+    auto counter = [&count](std::uint32_t, std::uint32_t){ count++; };
+    if(na * gallop_ratio < nb || nb * gallop_ratio < na){
+        intersect(a, a + na, b, b + nb, identity, counter);
+        return count;
+    }
+    size_t i = 0, j = 0;
+#ifdef __SSE2__
+    // every element of a block of "a" is compared with all rotations of a block of "b"
+    while(i + 4 <= na && j + 4 <= nb){
+        auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        auto eq = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+        auto a_max = a[i+3], b_max = b[j+3];
+        if(a_max <= b_max){
+            i += 4;
+        }
+        if(b_max <= a_max){
+            j += 4;
+        }
+    }
+#endif
+    intersect(a + i, a + na, b + j, b + nb, identity, counter);
+    return count;
+}
+
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cxx_graph{
+
+/**
+ * Fixed set of worker threads for fork-join loops.
+ * Calling thread takes part in every job as worker 0,
+ * so a pool of size 1 runs everything inline.
+ */
+class thread_pool{
+public:
+    /**
+     * @param threads count of workers including calling thread, 0 means hardware concurrency
+     */
+    explicit thread_pool(size_t threads = 0);
+    ~thread_pool();
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    size_t size()const{ return m_workers.size()+1; }
+
+    /**
+     * Calls job(worker) on every worker, returns when all calls are done.
+     * If calls throw, the first exception is rethrown after all of them are done
+     */
+    void run(const std::function<void(size_t)> &job);
+    /**
+     * Splits [begin, end) into chunks of "grain" elements, which workers take dynamically
+     * @param f functor called as f(chunk_begin, chunk_end, worker)
+     */
+    template<class F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F &&f);
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+    const std::function<void(size_t)>* m_job = nullptr;
+    size_t m_generation = 0; // incremented for each job
+    size_t m_pending = 0;    // workers still running current job
+    std::exception_ptr m_error; // first exception of current job
+    bool m_stop = false;
+
+    void p_work(size_t worker);
+    void p_call(const std::function<void(size_t)> &job, size_t worker);
+};
+
+inline thread_pool::thread_pool(size_t threads){
+    if(threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threads-1);
+    for(size_t i=1; i<threads; i++){
+        m_workers.emplace_back([this, i]{ p_work(i); });
+    }
+}
+
+inline thread_pool::~thread_pool(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(auto& worker:m_workers){
+        worker.join();
+    }
+}
+
+inline void thread_pool::run(const std::function<void(size_t)> &job){
+    if(m_workers.empty()){
+        job(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_pending = m_workers.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+    p_call(job, 0);
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]{ return m_pending == 0; });
+        m_job = nullptr;
+        std::swap(error, m_error);
+    }
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
+inline void thread_pool::p_call(const std::function<void(size_t)> &job, size_t worker){
+    try{
+        job(worker);
+    }catch(...){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_error){
+            m_error = std::current_exception();
+        }
+    }
+}
+
+inline void thread_pool::p_work(size_t worker){
+    size_t seen = 0;
+    while(true){
+        const std::function<void(size_t)>* job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seen]{ return m_stop || m_generation != seen; });
+            if(m_stop){
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+        p_call(*job, worker);
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            last = (--m_pending == 0);
+        }
+        if(last){
+            m_done.notify_one();
+        }
+    }
+}
+
+template<class F>
+void thread_pool::parallel_for(size_t begin, size_t end, size_t grain, F &&f){
+    if(begin >= end){
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    if(end - begin <= grain || m_workers.empty()){
+        f(begin, end, size_t(0));
+        return;
+    }
+    std::atomic<size_t> next(begin);
+    run([&](size_t worker){
+        while(true){
+            auto chunk = next.fetch_add(grain, std::memory_order_relaxed);
+            if(chunk >= end){
+                return;
+            }
+            f(chunk, std::min(chunk+grain, end), worker);
+        }
+    });
+}
+
+};
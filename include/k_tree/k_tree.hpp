@@ -27,6 +27,10 @@ SOFTWARE.
 #include <iterator>
 #include <memory>
 #include <queue>
+#include <type_traits>
+#include "../common/instrument.hpp"
+#include "../common/pmr.hpp"
+#include "../common/stats.hpp"
 
 namespace cont {
 
@@ -87,9 +91,11 @@ static bool is_right_to(const It& lhs, const It& rhs);
 
 template<class T, class Allocator = std::allocator<T>>
 class tree {
-    Allocator p_alloc /**< allocator for values */;
+    Allocator p_alloc /**< allocator for values and nodes */;
     struct node;
     using nodeptr = node*;
+    using node_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+    using node_allocator_traits_t = std::allocator_traits<node_allocator_t>;
 
     /**
      * Node struct for k_tree
@@ -284,6 +290,8 @@ public:
 private:
     nodeptr root, /**< Begin of a tree, has value */
         foot;     /**< End of a tree, hasn't value */
+    size_t p_nodes = 0,  /**< Count of allocated nodes, for stats() */
+        p_values = 0;    /**< Count of allocated values, for stats() */
 
     /**
      * Function that is used like a constructor
@@ -294,15 +302,28 @@ private:
      */
     template<class... Args>
     auto p_node_allocate(bool allocate, Args&&... args) -> nodeptr {
-        nodeptr n = new node();
+        node_allocator_t node_alloc(p_alloc);
+        nodeptr n = node_allocator_traits_t::allocate(node_alloc, 1);
+        node_allocator_traits_t::construct(node_alloc, n);
         n->parent = nullptr;
         n->left = n->right = nullptr;
         n->child_begin = n->child_end = nullptr;
         n->value = nullptr;
         if (allocate) {
-            n->value = p_alloc.allocate(1);
-            allocator_traits_t::construct(p_alloc, n->value, std::forward<Args>(args)...);
+            try {
+                n->value = allocator_traits_t::allocate(p_alloc, 1);
+                allocator_traits_t::construct(p_alloc, n->value, std::forward<Args>(args)...);
+            } catch (...) {
+                if (n->value) {
+                    allocator_traits_t::deallocate(p_alloc, n->value, 1);
+                }
+                node_allocator_traits_t::destroy(node_alloc, n);
+                node_allocator_traits_t::deallocate(node_alloc, n, 1);
+                throw;
+            }
+            ++p_values;
         }
+        ++p_nodes;
         return n;
     }
 
@@ -316,9 +337,13 @@ private:
         }
         if (n->value) {
             allocator_traits_t::destroy(p_alloc, n->value);
-            p_alloc.deallocate(n->value, 1);
+            allocator_traits_t::deallocate(p_alloc, n->value, 1);
+            --p_values;
         }
-        delete n;
+        node_allocator_t node_alloc(p_alloc);
+        node_allocator_traits_t::destroy(node_alloc, n);
+        node_allocator_traits_t::deallocate(node_alloc, n, 1);
+        --p_nodes;
     }
 
     void p_init() {
@@ -343,30 +368,43 @@ private:
         p_node_deallocate(end);
     }
 
+    static auto p_source(T* value, std::false_type) -> const T& { return *value; }
+    static auto p_source(T* value, std::true_type) -> T&& { return std::move(*value); }
+
+    /**
+     * Copies rhs structure and values into an empty or moved from tree
+     * @tparam Move whether values are moved out of rhs instead of copied
+     */
+    template<bool Move = false>
     void p_transfer(const tree<T, Allocator>& rhs) {
+        std::integral_constant<bool, Move> move;
+        if (!foot) { // moved from, has no sentinel
+            p_init();
+        }
         if (rhs.empty()) {
             return;
         }
         auto it = df_iterator(rhs.end());
         it--;
         auto prev_dist = tree_algo::depth_between(it, rhs.begin());
-        std::deque<std::pair<nodeptr, size_t>> queue;
+        using queue_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<nodeptr, size_t>>;
+        std::deque<std::pair<nodeptr, size_t>, queue_allocator_t> queue{queue_allocator_t(p_alloc)};
         while (it != rhs.begin()) {
-            auto tmp = p_node_allocate(true, *it.n->value);
+            auto tmp = p_node_allocate(true, p_source(it.n->value, move));
             auto it_dist = tree_algo::depth_between(it, rhs.begin());
             if (it_dist < prev_dist) { // we moved up
                 tmp->child_begin = queue.back().first;
                 auto bak = tmp->child_begin;
-                while (!queue.empty() && queue.back().second != it_dist) {
+                // shallower entries are right neighbours of ancestors, they stay
+                while (!queue.empty() && queue.back().second > it_dist) {
                     auto n = queue.back().first;
                     bak = n;
                     n->parent = tmp;
                     queue.pop_back();
                 }
                 tmp->child_end = bak;
-                tmp->right = queue.back().first;
-                queue.back().first->left = tmp;
-            } else if (it_dist == prev_dist && !queue.empty()) {
+            }
+            if (!queue.empty() && queue.back().second == it_dist) {
                 tmp->right = queue.back().first;
                 queue.back().first->left = tmp;
             }
@@ -374,7 +412,10 @@ private:
             prev_dist = it_dist;
             it--;
         }
-        set_root<df_iterator>(*it.n->value);
+        set_root<df_iterator>(p_source(it.n->value, move));
+        if (queue.empty()) { // root only
+            return;
+        }
         root->child_begin = queue.back().first;
         auto bak = root->child_begin;
         while (!queue.empty()) {
@@ -388,6 +429,7 @@ private:
 
 public:
     using allocator_t = Allocator;
+    using allocator_type = Allocator;
     using allocator_traits_t = std::allocator_traits<Allocator>;
     using value_type = T;
     using reference = value_type&;
@@ -402,28 +444,38 @@ public:
     /**
      * Default constructor
      * @param args parameter pack for a root. May be empty
-     * @param alloc allocator for values
+     * @param alloc allocator for values and nodes
      */
     template<class... Args>
     tree(Args&&... args, Allocator alloc = Allocator());
 
     /**
      * Constructor
-     * @param alloc allocator for values
+     * @param alloc allocator for values and nodes
      * @param args parameter pack for a root. May be empty
      */
     template<class... Args>
     tree(const Allocator& alloc, Args&&... args);
 
     /**
-     * Copy constructor, copies tree structire and values
+     * Copy constructor, copies tree structire and values.
+     * Allocator is select_on_container_copy_construction of rhs allocator
      */
     tree(const tree<T, Allocator>& rhs);
+    /**
+     * Copy constructor with another allocator
+     */
+    tree(const tree<T, Allocator>& rhs, const Allocator& alloc);
     /**
      * Move constructor, moves entire tree
      * NOTE: move constructor is far more optimized
      */
     tree(tree<T, Allocator>&& rhs);
+    /**
+     * Move constructor with another allocator,
+     * takes rhs nodes if allocators are equal, moves values one by one otherwise
+     */
+    tree(tree<T, Allocator>&& rhs, const Allocator& alloc);
     /**
      * Destructor
      */
@@ -437,8 +489,18 @@ public:
      * Assign move operator, clears current tree,
      * copies rhs structure and values.
      * NOTE: move assigment is far more optimized
+     * Allocator never propagates: with unequal allocators values are moved one by one
      */
     auto operator=(tree<T, Allocator>&& rhs) -> tree&;
+    /**
+     * @return allocator of values and nodes
+     */
+    auto get_allocator() const -> allocator_type;
+    /**
+     * Memory footprint in O(1), allocation counters are filled
+     * if Allocator is cont::counting_allocator
+     */
+    auto stats() const -> container_stats;
     /**
      * Checks if tree is empty.
      * If root's address equals foot's address, return true.
@@ -570,30 +632,38 @@ tree<T, Allocator>::df_iterator::df_iterator(const iterator_base& rhs)
 
 template<class T, class Allocator>
 auto tree<T, Allocator>::df_iterator::operator++() -> df_iterator& {
+    CONT_INSTRUMENT_OP(tree_df_next);
     if (this->n->child_begin) {
         this->n = this->n->child_begin;
     } else {
         while (!this->n->right) {
             this->n = this->n->parent;
+            CONT_INSTRUMENT_CLIMB();
             if (!this->n) {
                 return *this;
             }
+            CONT_INSTRUMENT_VISIT(1);
         }
         this->n = this->n->right;
     }
+    CONT_INSTRUMENT_VISIT(1);
     return *this;
 }
 
 template<class T, class Allocator>
 auto tree<T, Allocator>::df_iterator::operator--() -> df_iterator& {
+    CONT_INSTRUMENT_OP(tree_df_prev);
     if (this->n->left) {
         this->n = this->n->left;
         while (this->n->child_end) {
             this->n = this->n->child_end;
+            CONT_INSTRUMENT_VISIT(1);
         }
     } else {
         this->n = this->n->parent;
+        CONT_INSTRUMENT_CLIMB();
     }
+    CONT_INSTRUMENT_VISIT(1);
     return *this;
 }
 
@@ -661,10 +731,13 @@ tree<T, Allocator>::bf_iterator::bf_iterator(
 
 template<class T, class Allocator>
 auto tree<T, Allocator>::bf_iterator::operator++() -> bf_iterator& {
+    CONT_INSTRUMENT_OP(tree_bf_next);
     if (this->n->right) {
         if (this->n->parent && this->n->right) { // it's not foot
             this->n = this->n->right;
             q.emplace(this->n);
+            CONT_INSTRUMENT_VISIT(1);
+            CONT_INSTRUMENT_QUEUE(q.size());
             return *this;
         } else {
             this->end = this->n->right; // save foot
@@ -675,12 +748,15 @@ auto tree<T, Allocator>::bf_iterator::operator++() -> bf_iterator& {
     do {
         top = q.front();
         q.pop();
+        CONT_INSTRUMENT_VISIT(1);
     } while (!top->child_begin && !q.empty());
     if (!top->child_begin) {
         this->n = end;
     } else {
         this->n = top->child_begin;
         q.emplace(this->n);
+        CONT_INSTRUMENT_VISIT(1);
+        CONT_INSTRUMENT_QUEUE(q.size());
     }
     return *this;
 }
@@ -709,7 +785,11 @@ tree<T, Allocator>::tree(const Allocator& alloc, Args&&... args)
 
 template<class T, class Allocator>
 tree<T, Allocator>::tree(const tree<T, Allocator>& rhs)
-    : tree(rhs.p_alloc) {
+    : tree(rhs, allocator_traits_t::select_on_container_copy_construction(rhs.p_alloc)) {}
+
+template<class T, class Allocator>
+tree<T, Allocator>::tree(const tree<T, Allocator>& rhs, const Allocator& alloc)
+    : tree(alloc) {
     p_transfer(rhs);
 }
 
@@ -718,8 +798,17 @@ tree<T, Allocator>::tree(tree<T, Allocator>&& rhs)
     : p_alloc(rhs.p_alloc) {
     this->root = rhs.root;
     this->foot = rhs.foot;
+    this->p_nodes = rhs.p_nodes;
+    this->p_values = rhs.p_values;
     rhs.root = nullptr;
     rhs.foot = nullptr;
+    rhs.p_nodes = rhs.p_values = 0;
+}
+
+template<class T, class Allocator>
+tree<T, Allocator>::tree(tree<T, Allocator>&& rhs, const Allocator& alloc)
+    : tree(alloc) {
+    *this = std::move(rhs);
 }
 
 template<class T, class Allocator>
@@ -729,6 +818,9 @@ tree<T, Allocator>::~tree() {
 
 template<class T, class Allocator>
 auto tree<T, Allocator>::operator=(const tree<T, Allocator>& rhs) -> tree<T, Allocator>& {
+    if (this == &rhs) {
+        return *this;
+    }
     clear();
     p_transfer(rhs);
     return *this;
@@ -736,14 +828,43 @@ auto tree<T, Allocator>::operator=(const tree<T, Allocator>& rhs) -> tree<T, All
 
 template<class T, class Allocator>
 auto tree<T, Allocator>::operator=(tree<T, Allocator>&& rhs) -> tree<T, Allocator>& {
+    if (this == &rhs) {
+        return *this;
+    }
+    if (!(p_alloc == rhs.p_alloc)) {
+        // nodes of rhs can't be freed with our allocator
+        clear();
+        p_transfer<true>(rhs);
+        rhs.clear();
+        return *this;
+    }
     p_erase_children(root, foot);
     this->root = rhs.root;
     this->foot = rhs.foot;
+    this->p_nodes = rhs.p_nodes;
+    this->p_values = rhs.p_values;
     rhs.root = nullptr;
     rhs.foot = nullptr;
+    rhs.p_nodes = rhs.p_values = 0;
     return *this;
 }
 
+template<class T, class Allocator>
+auto tree<T, Allocator>::get_allocator() const -> allocator_type {
+    return p_alloc;
+}
+
+template<class T, class Allocator>
+auto tree<T, Allocator>::stats() const -> container_stats {
+    container_stats result;
+    result.elements = p_values;
+    result.live_nodes = p_nodes;
+    result.node_bytes = p_nodes * sizeof(node);
+    result.value_bytes = p_values * sizeof(T);
+    detail::add_counters(result, p_alloc);
+    return result;
+}
+
 template<class T, class Allocator>
 auto tree<T, Allocator>::empty() const -> bool {
     return this->root == this->foot;
@@ -798,6 +919,7 @@ auto tree<T, Allocator>::set_root(Args&&... args) -> It {
         allocator_traits_t::destroy(p_alloc, this->root->value);
     } else {
         this->root->value = allocator_traits_t::allocate(p_alloc, 1);
+        ++p_values;
     }
     allocator_traits_t::construct(p_alloc, this->root->value, std::forward<Args>(args)...);
     return It(this->root);
@@ -969,4 +1091,14 @@ template<class It>
 auto tree_algo::is_right_to(const It& lhs, const It& rhs) -> bool {
     return tree_algo::breadth_between(lhs, rhs) != 0;
 }
+
+#if CONT_HAS_PMR
+namespace pmr {
+/**
+ * Tree whose values and nodes come from a std::pmr::memory_resource
+ */
+template<class T>
+using tree = cont::tree<T, std::pmr::polymorphic_allocator<T>>;
+}; // namespace pmr
+#endif
 }; // namespace cont
@@ -0,0 +1,845 @@
+#pragma once
+/***
+MIT License
+
+Copyright (c) 2020 0xBYTESHIFT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+***/
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include "../common/pmr.hpp"
+#include "../common/stats.hpp"
+
+namespace cont {
+
+/**
+ * Doubly-linked list with compact contiguous storage.
+ * Nodes live in one buffer and are linked with 32-bit indices,
+ * values are stored inline. Erased slots are reused via free-list.
+ * Iterators are indices, so they stay valid when buffer grows.
+ */
+template<class T, class Allocator = std::allocator<T>>
+class index_list {
+public:
+    using index_type = std::uint32_t;
+    static constexpr index_type npos = std::numeric_limits<index_type>::max(); /**< Index of end of a list */
+
+private:
+    static constexpr index_type free_mark = npos - 1; /**< "left" of a free slot */
+
+    struct node {
+        index_type left,  /**< Left neighbour of a node */
+            right;        /**< Right neighbour of a node, next free slot for a free one */
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; /**< Inline value */
+
+        auto value() -> T* { return reinterpret_cast<T*>(&storage); }
+        auto value() const -> const T* { return reinterpret_cast<const T*>(&storage); }
+    };
+    using node_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+    using node_allocator_traits_t = std::allocator_traits<node_allocator_t>;
+
+    Allocator p_alloc /**< allocator for values and nodes buffer */;
+    node* p_nodes;          /**< Buffer of nodes */
+    index_type p_capacity,  /**< Count of slots in buffer */
+        p_used,             /**< Count of slots that were ever used */
+        p_free,             /**< Head of free-list */
+        p_first,            /**< First node of a list */
+        p_last;             /**< Last node of a list */
+    std::size_t p_count;    /**< Count of values */
+
+public:
+    /**
+     * Iterator base class
+     */
+    class iterator_base {
+    protected:
+        friend class index_list;
+        /**
+         * Protected constructor
+         * @param l list of an iterator
+         * @param n index of a node
+         */
+        iterator_base(const index_list* l, index_type n);
+        const index_list* l; /**< List of an iterator */
+
+    public:
+        index_type n; /**< Index of a node of an iterator */
+        using allocator_t = Allocator;
+        using self_type = iterator_base;
+        using value_type = T;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using difference_type = size_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        /**
+         * Copy constructor
+         * @param rhs rvalue of a copying
+         */
+        iterator_base(const iterator_base& rhs);
+        /**
+         * Dereference operator
+         * @return reference of a node value
+         */
+        auto operator*() -> reference;
+        /**
+         * Const-dereference operator
+         * @return const-reference of a node value
+         */
+        auto operator*() const -> const_reference;
+        /**
+         * Equal operator
+         * @param rhs rvalue to compare to
+         */
+        auto operator==(const iterator_base& rhs) const -> bool;
+        /**
+         * Non-equal operator
+         * @param rhs rvalue to compare to
+         */
+        auto operator!=(const iterator_base& rhs) const -> bool;
+    };
+
+    /**
+     * Forward iterator class
+     */
+    class iterator : public iterator_base {
+    public:
+        /**
+         * Constructor
+         * @param l list of an iterator
+         * @param n index of a node
+         */
+        iterator(const index_list* l, index_type n);
+        /**
+         * Copy Constructor
+         * @param rhs rvalue of a copying
+         */
+        iterator(const iterator_base& rhs);
+        /**
+         * Prefix increment operator
+         * @return reference to current iterator
+         */
+        auto operator++() -> iterator&;
+        /**
+         * Postfix increment operator
+         * @return copy of current iterator
+         */
+        auto operator++(int) -> iterator;
+        /**
+         * Prefix decrement operator
+         * @return reference to current iterator
+         */
+        auto operator--() -> iterator&;
+        /**
+         * Postfix decrement operator
+         * @return copy of current iterator
+         */
+        auto operator--(int) -> iterator;
+    };
+
+    /**
+     * Reverse iterator class
+     */
+    class reverse_iterator : public iterator_base {
+    public:
+        /**
+         * Constructor
+         * @param l list of an iterator
+         * @param n index of a node
+         */
+        reverse_iterator(const index_list* l, index_type n);
+        /**
+         * Copy Constructor
+         * @param rhs rvalue of a copying
+         */
+        reverse_iterator(const iterator_base& rhs);
+        /**
+         * Prefix increment operator
+         * @return reference to current iterator
+         */
+        auto operator++() -> reverse_iterator&;
+        /**
+         * Postfix increment operator
+         * @return copy of current iterator
+         */
+        auto operator++(int) -> reverse_iterator;
+        /**
+         * Prefix decrement operator
+         * @return reference to current iterator
+         */
+        auto operator--() -> reverse_iterator&;
+        /**
+         * Postfix decrement operator
+         * @return copy of current iterator
+         */
+        auto operator--(int) -> reverse_iterator;
+    };
+
+private:
+    void p_init() {
+        p_nodes = nullptr;
+        p_capacity = p_used = 0;
+        p_free = p_first = p_last = npos;
+        p_count = 0;
+    }
+
+    /**
+     * Moves live values to "nodes", frees current buffer
+     * @param nodes new buffer of given capacity, at least p_used slots
+     * @param capacity count of slots in "nodes"
+     */
+    void p_move_nodes(node* nodes, index_type capacity) {
+        node_allocator_t node_alloc(p_alloc);
+        for (index_type i = 0; i < p_used; ++i) {
+            auto& from = p_nodes[i];
+            auto& to = nodes[i];
+            to.left = from.left;
+            to.right = from.right;
+            if (from.left != free_mark) {
+                allocator_traits_t::construct(p_alloc, to.value(), std::move_if_noexcept(*from.value()));
+                allocator_traits_t::destroy(p_alloc, from.value());
+            }
+        }
+        if (p_nodes) {
+            node_allocator_traits_t::deallocate(node_alloc, p_nodes, p_capacity);
+        }
+        p_nodes = nodes;
+        p_capacity = capacity;
+    }
+
+    /**
+     * Moves live values to a new buffer of given capacity
+     * @param capacity count of slots in a new buffer
+     */
+    void p_reallocate(index_type capacity) {
+        node_allocator_t node_alloc(p_alloc);
+        p_move_nodes(node_allocator_traits_t::allocate(node_alloc, capacity), capacity);
+    }
+
+    /**
+     * Takes a slot from free-list or from the end of buffer,
+     * constructs value in it
+     * @param args parameter pack for value
+     * @return index of a slot, it's not linked
+     */
+    template<class... Args>
+    auto p_node_allocate(Args&&... args) -> index_type {
+        index_type n;
+        if (p_free != npos) {
+            n = p_free;
+            p_free = p_nodes[n].right;
+        } else if (p_used == p_capacity) {
+            // value is constructed in a new buffer before the old one is freed, args may refer into it
+            if (p_capacity >= free_mark / 2) {
+                throw std::length_error("index_list: too many values");
+            }
+            auto capacity = static_cast<index_type>(p_capacity ? p_capacity * 2 : 16);
+            node_allocator_t node_alloc(p_alloc);
+            node* nodes = node_allocator_traits_t::allocate(node_alloc, capacity);
+            n = p_used;
+            try {
+                allocator_traits_t::construct(p_alloc, nodes[n].value(), std::forward<Args>(args)...);
+            } catch (...) {
+                node_allocator_traits_t::deallocate(node_alloc, nodes, capacity);
+                throw;
+            }
+            p_move_nodes(nodes, capacity);
+            p_used++;
+            p_nodes[n].left = p_nodes[n].right = npos;
+            ++p_count;
+            return n;
+        } else {
+            n = p_used++;
+        }
+        try {
+            allocator_traits_t::construct(p_alloc, p_nodes[n].value(), std::forward<Args>(args)...);
+        } catch (...) {
+            p_nodes[n].left = free_mark;
+            p_nodes[n].right = p_free;
+            p_free = n;
+            throw;
+        }
+        p_nodes[n].left = p_nodes[n].right = npos;
+        ++p_count;
+        return n;
+    }
+
+    /**
+     * Destroys value, returns slot to free-list
+     * @param n index of a slot, it has to be unlinked
+     */
+    void p_node_deallocate(index_type n) {
+        allocator_traits_t::destroy(p_alloc, p_nodes[n].value());
+        p_nodes[n].left = free_mark;
+        p_nodes[n].right = p_free;
+        p_free = n;
+        --p_count;
+    }
+
+    /**
+     * Links unlinked node "n" between "left" and "right"
+     */
+    void p_link(index_type left, index_type n, index_type right) {
+        p_nodes[n].left = left;
+        p_nodes[n].right = right;
+        if (left == npos) {
+            p_first = n;
+        } else {
+            p_nodes[left].right = n;
+        }
+        if (right == npos) {
+            p_last = n;
+        } else {
+            p_nodes[right].left = n;
+        }
+    }
+
+    void p_free_buffer() {
+        clear();
+        if (p_nodes) {
+            node_allocator_t node_alloc(p_alloc);
+            node_allocator_traits_t::deallocate(node_alloc, p_nodes, p_capacity);
+        }
+        p_init();
+    }
+
+    void p_steal(index_list& rhs) {
+        p_nodes = rhs.p_nodes;
+        p_capacity = rhs.p_capacity;
+        p_used = rhs.p_used;
+        p_free = rhs.p_free;
+        p_first = rhs.p_first;
+        p_last = rhs.p_last;
+        p_count = rhs.p_count;
+        rhs.p_init();
+    }
+
+    void p_transfer(const index_list& rhs) {
+        reserve(rhs.size());
+        for (auto it = rhs.begin(); it != rhs.end(); ++it) {
+            insert_before(end(), *it);
+        }
+    }
+
+    /**
+     * Moves values of rhs one by one, for allocators that can't take over rhs buffer
+     */
+    void p_transfer_values(index_list& rhs) {
+        reserve(rhs.size());
+        for (auto it = rhs.begin(); it != rhs.end(); ++it) {
+            insert_before(end(), std::move(*it));
+        }
+    }
+
+public:
+    using allocator_t = Allocator;
+    using allocator_type = Allocator;
+    using allocator_traits_t = std::allocator_traits<Allocator>;
+    using value_type = T;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * Default constructor
+     * @param count count of nodes to pre-allocate
+     * @param val the value to initialize elements of the container with
+     * @param alloc allocator for values and nodes
+     */
+    index_list(size_t count = 0, const T& val = T(), const Allocator& alloc = Allocator());
+    /**
+     * Empty list which allocates everything from alloc
+     */
+    explicit index_list(const Allocator& alloc);
+    /**
+     * Copy constructor, copies list values, result is compacted.
+     * Allocator is select_on_container_copy_construction of rhs allocator
+     */
+    index_list(const index_list<T, Allocator>& rhs);
+    /**
+     * Copy constructor with another allocator
+     */
+    index_list(const index_list<T, Allocator>& rhs, const Allocator& alloc);
+    /**
+     * Move constructor, takes over buffer of rhs
+     */
+    index_list(index_list<T, Allocator>&& rhs);
+    /**
+     * Move constructor with another allocator,
+     * takes rhs buffer if allocators are equal, moves values one by one otherwise
+     */
+    index_list(index_list<T, Allocator>&& rhs, const Allocator& alloc);
+    /**
+     * Destructor
+     */
+    ~index_list();
+    /**
+     * Assign copy operator, clears current list, copies rhs values
+     */
+    auto operator=(const index_list<T, Allocator>& rhs) -> index_list&;
+    /**
+     * Assign move operator, frees current buffer, takes over buffer of rhs.
+     * Allocator never propagates: with unequal allocators values are moved one by one
+     */
+    auto operator=(index_list<T, Allocator>&& rhs) -> index_list&;
+    /**
+     * @return allocator of values and nodes
+     */
+    auto get_allocator() const -> allocator_type;
+    /**
+     * Memory footprint in O(1): values live inside nodes, so node bytes are the whole buffer
+     * but values. Allocation counters are filled if Allocator is cont::counting_allocator
+     */
+    auto stats() const -> container_stats;
+    /**
+     * Checks if list is empty.
+     */
+    auto empty() const -> bool;
+    /**
+     * Clears current list, buffer is kept for reuse
+     */
+    void clear();
+    /**
+     * Reserves buffer for given count of values
+     * @param count count of values
+     * @throws std::length_error if count doesn't fit index_type
+     */
+    void reserve(size_type count);
+    /**
+     * @return count of values buffer can hold without reallocation
+     */
+    auto capacity() const -> size_type;
+    /**
+     * Erases node of given iterator, it's slot is reused by next insert
+     * @param it iterator to erase
+     * @return next iterator of given iterator
+     */
+    template<class It>
+    auto erase(const It& it) -> It;
+    /**
+     * Erases nodes between given iterators
+     * @param it0 begin of range
+     * @param it1 end of range
+     * @return next iterator of end
+     */
+    template<class It>
+    auto erase(const It& it0, const It& it1) -> It;
+    /**
+     * Inserts value constructed with provided args after provided iterator
+     * @param it iterator to insert value after
+     * @param args parameter pack for construction of a value
+     * @return iterator to inserted value
+     * */
+    template<class It, class... Args>
+    auto insert(const It& it, Args&&... args) -> It;
+    /**
+     * Inserts value constructed with provided args before provided iterator
+     * @param it iterator to insert value before
+     * @param args parameter pack for construction of a value
+     * @return iterator to inserted value
+     */
+    template<class It, class... Args>
+    auto insert_before(const It& it, Args&&... args) -> It;
+    /**
+     * @return iterator to head of a list
+     */
+    template<class It = iterator>
+    auto begin() const -> It;
+    /**
+     * @return iterator to end of a list
+     */
+    template<class It = iterator>
+    auto end() const -> It;
+    /**
+     * @return size of a list
+     */
+    auto size() const -> size_type;
+    /**
+     * Equals operator
+     * Checks if rhs values are equeal to current list's.
+     * @param rhs list to check equality
+     * @return Equality. "true" if lists are equal. "false" otherwise.
+     */
+    auto operator==(const index_list<T, Allocator>& rhs) const -> bool;
+    /**
+     * Non-equals operator
+     * Checks if rhs values are not equeal to current list's.
+     * @param rhs list to check non-equality
+     * @return Non-equality. "true" if lists are non-equal.
+     *      "false" otherwise.
+     */
+    auto operator!=(const index_list<T, Allocator>& rhs) const -> bool;
+};
+
+template<class T, class Allocator>
+constexpr typename index_list<T, Allocator>::index_type index_list<T, Allocator>::npos;
+
+template<class T, class Allocator>
+constexpr typename index_list<T, Allocator>::index_type index_list<T, Allocator>::free_mark;
+
+//*** iterator_base ***
+template<class T, class Allocator>
+index_list<T, Allocator>::iterator_base::iterator_base(const index_list* l, index_type n) {
+    this->l = l;
+    this->n = n;
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::iterator_base::iterator_base(const iterator_base& rhs) {
+    this->l = rhs.l;
+    this->n = rhs.n;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator_base::operator*() -> reference {
+    return *l->p_nodes[n].value();
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator_base::operator*() const -> const_reference {
+    return *l->p_nodes[n].value();
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator_base::operator==(const iterator_base& rhs) const -> bool {
+    return this->n == rhs.n;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator_base::operator!=(const iterator_base& rhs) const -> bool {
+    return this->n != rhs.n;
+}
+
+//*** iterator ***
+template<class T, class Allocator>
+index_list<T, Allocator>::iterator::iterator(const index_list* l, index_type n)
+    : iterator_base(l, n) {}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::iterator::iterator(const iterator_base& rhs)
+    : iterator_base(rhs) {}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator::operator++() -> iterator& {
+    this->n = this->l->p_nodes[this->n].right;
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator::operator--() -> iterator& {
+    this->n = (this->n == npos) ? this->l->p_last : this->l->p_nodes[this->n].left;
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator::operator++(int) -> iterator {
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::iterator::operator--(int) -> iterator {
+    auto copy = *this;
+    --(*this);
+    return copy;
+}
+
+//*** reverse_iterator ***
+template<class T, class Allocator>
+index_list<T, Allocator>::reverse_iterator::reverse_iterator(const index_list* l, index_type n)
+    : iterator_base(l, n) {}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::reverse_iterator::reverse_iterator(const iterator_base& rhs)
+    : iterator_base(rhs) {}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::reverse_iterator::operator++() -> reverse_iterator& {
+    this->n = this->l->p_nodes[this->n].left;
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::reverse_iterator::operator--() -> reverse_iterator& {
+    this->n = (this->n == npos) ? this->l->p_first : this->l->p_nodes[this->n].right;
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::reverse_iterator::operator++(int) -> reverse_iterator {
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::reverse_iterator::operator--(int) -> reverse_iterator {
+    auto copy = *this;
+    --(*this);
+    return copy;
+}
+
+/*** index_list ***/
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(size_t count, const T& val, const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+    reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        insert_before(end(), val);
+    }
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(const index_list<T, Allocator>& rhs)
+    : p_alloc(allocator_traits_t::select_on_container_copy_construction(rhs.p_alloc)) {
+    p_init();
+    p_transfer(rhs);
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(const index_list<T, Allocator>& rhs, const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+    p_transfer(rhs);
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(index_list<T, Allocator>&& rhs)
+    : p_alloc(rhs.p_alloc) {
+    p_steal(rhs);
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::index_list(index_list<T, Allocator>&& rhs, const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+    *this = std::move(rhs);
+}
+
+template<class T, class Allocator>
+index_list<T, Allocator>::~index_list() {
+    p_free_buffer();
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::operator=(const index_list<T, Allocator>& rhs) -> index_list<T, Allocator>& {
+    if (this != &rhs) {
+        clear();
+        p_transfer(rhs);
+    }
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::operator=(index_list<T, Allocator>&& rhs) -> index_list<T, Allocator>& {
+    if (this == &rhs) {
+        return *this;
+    }
+    if (p_alloc == rhs.p_alloc) {
+        p_free_buffer();
+        p_steal(rhs);
+    } else {
+        clear();
+        p_transfer_values(rhs);
+        rhs.clear();
+    }
+    return *this;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::get_allocator() const -> allocator_type {
+    return p_alloc;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::stats() const -> container_stats {
+    container_stats result;
+    result.elements = p_count;
+    result.live_nodes = p_count;
+    result.value_bytes = p_count * sizeof(T);
+    result.node_bytes = std::size_t(p_capacity) * sizeof(node) - result.value_bytes;
+    detail::add_counters(result, p_alloc);
+    return result;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::empty() const -> bool {
+    return p_count == 0;
+}
+
+template<class T, class Allocator>
+void index_list<T, Allocator>::clear() {
+    for (index_type i = 0; i < p_used; ++i) {
+        if (p_nodes[i].left != free_mark) {
+            allocator_traits_t::destroy(p_alloc, p_nodes[i].value());
+        }
+    }
+    p_used = 0;
+    p_free = p_first = p_last = npos;
+    p_count = 0;
+}
+
+template<class T, class Allocator>
+void index_list<T, Allocator>::reserve(size_type count) {
+    if (count > p_capacity) {
+        if (count >= free_mark) {
+            throw std::length_error("index_list: reserve above max size");
+        }
+        p_reallocate(static_cast<index_type>(count));
+    }
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::capacity() const -> size_type {
+    return p_capacity;
+}
+
+template<class T, class Allocator>
+template<class It>
+auto index_list<T, Allocator>::erase(const It& it) -> It {
+    if (it == end<It>()) {
+        return end<It>();
+    }
+    It bak = it;
+    ++bak;
+    auto& n = p_nodes[it.n];
+    if (n.left == npos) {
+        p_first = n.right;
+    } else {
+        p_nodes[n.left].right = n.right;
+    }
+    if (n.right == npos) {
+        p_last = n.left;
+    } else {
+        p_nodes[n.right].left = n.left;
+    }
+    p_node_deallocate(it.n);
+    return bak;
+}
+
+template<class T, class Allocator>
+template<class It>
+auto index_list<T, Allocator>::erase(const It& it0, const It& it1) -> It {
+    if (it0 == end<It>()) {
+        return end<It>();
+    }
+    auto it = it0;
+    while (it != it1) {
+        it = erase(it);
+    }
+    it = erase(it);
+    return it;
+}
+
+template<class T, class Allocator>
+template<class It, class... Args>
+auto index_list<T, Allocator>::insert(const It& it, Args&&... args) -> It {
+    auto tmp = p_node_allocate(std::forward<Args>(args)...);
+    if (p_first == npos) { //if list is empty, it becomes the only node
+        p_link(npos, tmp, npos);
+    } else {
+        assert(it != end());
+        p_link(it.n, tmp, p_nodes[it.n].right);
+    }
+    return It(this, tmp);
+}
+
+template<class T, class Allocator>
+template<class It, class... Args>
+auto index_list<T, Allocator>::insert_before(const It& it, Args&&... args) -> It {
+    auto tmp = p_node_allocate(std::forward<Args>(args)...);
+    if (p_first == npos) { //if list is empty, it becomes the only node
+        p_link(npos, tmp, npos);
+    } else if (it.n == npos) {
+        p_link(p_last, tmp, npos);
+    } else {
+        p_link(p_nodes[it.n].left, tmp, it.n);
+    }
+    return It(this, tmp);
+}
+
+template<class T, class Allocator>
+template<class It>
+auto index_list<T, Allocator>::begin() const -> It {
+    return It(this, p_first);
+}
+
+template<class T, class Allocator>
+template<class It>
+auto index_list<T, Allocator>::end() const -> It {
+    return It(this, npos);
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::size() const -> size_type {
+    return p_count;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::operator==(const index_list<T, Allocator>& rhs) const -> bool {
+    if (size() != rhs.size()) {
+        return false;
+    }
+    auto lhs_it = begin();
+    auto rhs_it = rhs.begin();
+    while (rhs_it != rhs.end()) {
+        if (*rhs_it != *lhs_it) {
+            return false;
+        }
+        ++lhs_it;
+        ++rhs_it;
+    }
+    return true;
+}
+
+template<class T, class Allocator>
+auto index_list<T, Allocator>::operator!=(const index_list<T, Allocator>& rhs) const -> bool {
+    return !(*this == rhs);
+}
+
+#if CONT_HAS_PMR
+namespace pmr {
+/**
+ * Index list whose values and nodes buffer come from a std::pmr::memory_resource
+ */
+template<class T>
+using index_list = cont::index_list<T, std::pmr::polymorphic_allocator<T>>;
+}; // namespace pmr
+#endif
+}; // namespace cont
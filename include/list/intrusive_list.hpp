@@ -0,0 +1,574 @@
+#pragma once
+/***
+MIT License
+
+Copyright (c) 2020 0xBYTESHIFT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+***/
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace cont {
+
+/**
+ * Hook for intrusive_list, has to be a member of a stored type.
+ * Links of a list live inside of a hook,
+ * so insert and erase of an intrusive_list never allocate.
+ */
+struct list_hook {
+    list_hook* left = nullptr;  /**< Left neighbour of a hook */
+    list_hook* right = nullptr; /**< Right neighbour of a hook */
+
+    list_hook() = default;
+    /**
+     * Copy constructor, links are not copied
+     */
+    list_hook(const list_hook&) {}
+    /**
+     * Assign copy operator, links are not copied
+     */
+    auto operator=(const list_hook&) -> list_hook& { return *this; }
+    /**
+     * Checks if hook is linked into a list
+     */
+    auto is_linked() const -> bool { return left != nullptr; }
+};
+
+/**
+ * Intrusive doubly-linked list.
+ * Doesn't own it's values: objects are linked with "Hook" member,
+ * list doesn't allocate, copy or destroy them.
+ * Object has to outlive it's membership in a list.
+ * @tparam T type of values
+ * @tparam Hook pointer to list_hook member of T
+ */
+template<class T, list_hook T::*Hook>
+class intrusive_list {
+    using nodeptr = list_hook*;
+
+    /**
+     * @return object that owns given hook
+     */
+    static auto p_owner(nodeptr n) -> T* {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(n) - p_offset());
+    }
+
+    /**
+     * @return offset of a hook member inside of T
+     */
+    static auto p_offset() -> std::ptrdiff_t {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type probe;
+        auto obj = reinterpret_cast<T*>(&probe);
+        return reinterpret_cast<char*>(&(obj->*Hook)) - reinterpret_cast<char*>(obj);
+    }
+
+public:
+    /**
+     * Iterator base class
+     */
+    class iterator_base {
+    protected:
+        friend class intrusive_list;
+        /**
+         * Protected constructor
+         * @param n hook for an iterator
+         */
+        iterator_base(nodeptr n);
+
+    public:
+        nodeptr n; /**< Hook of an iterator */
+        using self_type = iterator_base;
+        using value_type = T;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using difference_type = size_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        /**
+         * Copy constructor
+         * @param rhs rvalue of a copying
+         */
+        iterator_base(const iterator_base& rhs);
+        /**
+         * Dereference operator
+         * @return reference of an object
+         */
+        auto operator*() -> reference;
+        /**
+         * Const-dereference operator
+         * @return const-reference of an object
+         */
+        auto operator*() const -> const_reference;
+        /**
+         * Member access operator
+         * @return pointer to an object
+         */
+        auto operator->() -> pointer;
+        /**
+         * Const member access operator
+         * @return const pointer to an object
+         */
+        auto operator->() const -> const_pointer;
+        /**
+         * Equal operator
+         * @param rhs rvalue to compare to
+         */
+        auto operator==(const iterator_base& rhs) const -> bool;
+        /**
+         * Non-equal operator
+         * @param rhs rvalue to compare to
+         */
+        auto operator!=(const iterator_base& rhs) const -> bool;
+    };
+
+    /**
+     * Forward iterator class
+     */
+    class iterator : public iterator_base {
+    public:
+        /**
+         * Constructor
+         * @param n hook for an iterator
+         */
+        iterator(nodeptr n);
+        /**
+         * Copy Constructor
+         * @param rhs rvalue of a copying
+         */
+        iterator(const iterator_base& rhs);
+        /**
+         * Prefix increment operator
+         * @return reference to current iterator
+         */
+        auto operator++() -> iterator&;
+        /**
+         * Postfix increment operator
+         * @return copy of current iterator
+         */
+        auto operator++(int) -> iterator;
+        /**
+         * Prefix decrement operator
+         * @return reference to current iterator
+         */
+        auto operator--() -> iterator&;
+        /**
+         * Postfix decrement operator
+         * @return copy of current iterator
+         */
+        auto operator--(int) -> iterator;
+    };
+
+    /**
+     * Reverse iterator class
+     */
+    class reverse_iterator : public iterator_base {
+    public:
+        /**
+         * Constructor
+         * @param n hook for an iterator
+         */
+        reverse_iterator(nodeptr n);
+        /**
+         * Copy Constructor
+         * @param rhs rvalue of a copying
+         */
+        reverse_iterator(const iterator_base& rhs);
+        /**
+         * Prefix increment operator
+         * @return reference to current iterator
+         */
+        auto operator++() -> reverse_iterator&;
+        /**
+         * Postfix increment operator
+         * @return copy of current iterator
+         */
+        auto operator++(int) -> reverse_iterator;
+        /**
+         * Prefix decrement operator
+         * @return reference to current iterator
+         */
+        auto operator--() -> reverse_iterator&;
+        /**
+         * Postfix decrement operator
+         * @return copy of current iterator
+         */
+        auto operator--(int) -> reverse_iterator;
+    };
+
+private:
+    list_hook p_root; /**< Sentinel hook, end of a list. List is circular around it */
+    size_t p_size;    /**< Count of linked objects */
+
+    void p_init() {
+        p_root.left = p_root.right = &p_root;
+        p_size = 0;
+    }
+
+    /**
+     * Links hook "n" between "left" and "left->right"
+     */
+    void p_link_after(nodeptr left, nodeptr n) {
+        assert(!n->is_linked());
+        n->left = left;
+        n->right = left->right;
+        left->right->left = n;
+        left->right = n;
+        ++p_size;
+    }
+
+    /**
+     * Takes over all objects of rhs, leaves rhs empty
+     */
+    void p_steal(intrusive_list& rhs) {
+        if (rhs.empty()) {
+            p_init();
+            return;
+        }
+        p_root.left = rhs.p_root.left;
+        p_root.right = rhs.p_root.right;
+        p_root.left->right = &p_root;
+        p_root.right->left = &p_root;
+        p_size = rhs.p_size;
+        rhs.p_init();
+    }
+
+public:
+    using value_type = T;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * Default constructor, creates empty list
+     */
+    intrusive_list();
+    /**
+     * Copying is prohibited, object can be linked into one list at a time
+     */
+    intrusive_list(const intrusive_list& rhs) = delete;
+    /**
+     * Move constructor, takes over all objects of rhs
+     */
+    intrusive_list(intrusive_list&& rhs);
+    /**
+     * Destructor, unlinks all objects
+     */
+    ~intrusive_list();
+    /**
+     * Copying is prohibited, object can be linked into one list at a time
+     */
+    auto operator=(const intrusive_list& rhs) -> intrusive_list& = delete;
+    /**
+     * Assign move operator, unlinks current objects,
+     * takes over all objects of rhs
+     */
+    auto operator=(intrusive_list&& rhs) -> intrusive_list&;
+    /**
+     * Checks if list is empty.
+     */
+    auto empty() const -> bool;
+    /**
+     * Unlinks all objects, objects are not destroyed
+     */
+    void clear();
+    /**
+     * Unlinks object of given iterator, object is not destroyed
+     * @param it iterator to erase
+     * @return next iterator of given iterator
+     */
+    template<class It>
+    auto erase(const It& it) -> It;
+    /**
+     * Unlinks objects between given iterators, including both of them
+     * @param it0 begin of range
+     * @param it1 end of range
+     * @return next iterator of end
+     */
+    template<class It>
+    auto erase(const It& it0, const It& it1) -> It;
+    /**
+     * Links object after provided iterator.
+     * If iterator is end(), object becomes first.
+     * @param it iterator to insert object after
+     * @param obj object to link, must not be linked already
+     * @return iterator to inserted object
+     */
+    template<class It>
+    auto insert(const It& it, T& obj) -> It;
+    /**
+     * Links object before provided iterator
+     * @param it iterator to insert object before
+     * @param obj object to link, must not be linked already
+     * @return iterator to inserted object
+     */
+    template<class It>
+    auto insert_before(const It& it, T& obj) -> It;
+    /**
+     * Makes iterator from an object linked into this list, O(1)
+     * @param obj linked object
+     * @return iterator to object
+     */
+    template<class It = iterator>
+    auto iterator_to(T& obj) const -> It;
+    /**
+     * @return iterator to first object of a list
+     */
+    template<class It = iterator>
+    auto begin() const -> It;
+    /**
+     * @return iterator to sentinel of a list
+     */
+    template<class It = iterator>
+    auto end() const -> It;
+    /**
+     * @return count of linked objects
+     */
+    auto size() const -> size_type;
+};
+
+//*** iterator_base ***
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::iterator_base::iterator_base(nodeptr n) {
+    this->n = n;
+}
+
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::iterator_base::iterator_base(const iterator_base& rhs) {
+    this->n = rhs.n;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator*() -> reference {
+    return *p_owner(n);
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator*() const -> const_reference {
+    return *p_owner(n);
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator->() -> pointer {
+    return p_owner(n);
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator->() const -> const_pointer {
+    return p_owner(n);
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator==(const iterator_base& rhs) const -> bool {
+    return this->n == rhs.n;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator_base::operator!=(const iterator_base& rhs) const -> bool {
+    return this->n != rhs.n;
+}
+
+//*** iterator ***
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::iterator::iterator(nodeptr n)
+    : iterator_base(n) {}
+
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::iterator::iterator(const iterator_base& rhs)
+    : iterator_base(rhs) {}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator::operator++() -> iterator& {
+    this->n = this->n->right;
+    return *this;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator::operator--() -> iterator& {
+    this->n = this->n->left;
+    return *this;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator::operator++(int) -> iterator {
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::iterator::operator--(int) -> iterator {
+    auto copy = *this;
+    --(*this);
+    return copy;
+}
+
+//*** reverse_iterator ***
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::reverse_iterator::reverse_iterator(nodeptr n)
+    : iterator_base(n) {}
+
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::reverse_iterator::reverse_iterator(const iterator_base& rhs)
+    : iterator_base(rhs) {}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::reverse_iterator::operator++() -> reverse_iterator& {
+    this->n = this->n->left;
+    return *this;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::reverse_iterator::operator--() -> reverse_iterator& {
+    this->n = this->n->right;
+    return *this;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::reverse_iterator::operator++(int) -> reverse_iterator {
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::reverse_iterator::operator--(int) -> reverse_iterator {
+    auto copy = *this;
+    --(*this);
+    return copy;
+}
+
+/*** intrusive_list ***/
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::intrusive_list() {
+    p_init();
+}
+
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::intrusive_list(intrusive_list&& rhs) {
+    p_steal(rhs);
+}
+
+template<class T, list_hook T::*Hook>
+intrusive_list<T, Hook>::~intrusive_list() {
+    clear();
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::operator=(intrusive_list&& rhs) -> intrusive_list& {
+    if (this != &rhs) {
+        clear();
+        p_steal(rhs);
+    }
+    return *this;
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::empty() const -> bool {
+    return p_root.right == &p_root;
+}
+
+template<class T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::clear() {
+    auto n = p_root.right;
+    while (n != &p_root) {
+        auto bak = n->right;
+        n->left = n->right = nullptr;
+        n = bak;
+    }
+    p_init();
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::erase(const It& it) -> It {
+    auto n = it.n;
+    if (n == &p_root) {
+        return end<It>();
+    }
+    It bak = it;
+    ++bak;
+    n->left->right = n->right;
+    n->right->left = n->left;
+    n->left = n->right = nullptr;
+    --p_size;
+    return bak;
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::erase(const It& it0, const It& it1) -> It {
+    if (it0 == end<It>()) {
+        return end<It>();
+    }
+    auto it = it0;
+    while (it != it1) {
+        it = erase(it);
+    }
+    it = erase(it);
+    return it;
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::insert(const It& it, T& obj) -> It {
+    auto n = &(obj.*Hook);
+    p_link_after(it.n, n);
+    return It(n);
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::insert_before(const It& it, T& obj) -> It {
+    auto n = &(obj.*Hook);
+    p_link_after(it.n->left, n);
+    return It(n);
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::iterator_to(T& obj) const -> It {
+    assert((obj.*Hook).is_linked());
+    return It(&(obj.*Hook));
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::begin() const -> It {
+    return It(p_root.right);
+}
+
+template<class T, list_hook T::*Hook>
+template<class It>
+auto intrusive_list<T, Hook>::end() const -> It {
+    return It(const_cast<nodeptr>(&p_root));
+}
+
+template<class T, list_hook T::*Hook>
+auto intrusive_list<T, Hook>::size() const -> size_type {
+    return p_size;
+}
+}; // namespace cont
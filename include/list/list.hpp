@@ -22,24 +22,68 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ***/
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <deque>
+#include <functional>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../common/instrument.hpp"
+#include "../common/pmr.hpp"
+#include "../common/stats.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CONT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define CONT_PREFETCH(addr)
+#endif
 
 namespace cont {
 
 template<class T, class Allocator = std::allocator<T>>
 class list {
-    Allocator p_alloc /**< allocator for values */;
+    Allocator p_alloc /**< allocator for values, nodes and index */;
     struct node;
+    struct skip_link;
+    struct skip_tower;
     using nodeptr = node*;
+    template<class U>
+    using rebind_t = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+    using node_allocator_t = rebind_t<node>;
+    using node_allocator_traits_t = std::allocator_traits<node_allocator_t>;
+    using tower_allocator_t = rebind_t<skip_tower>;
+    using tower_allocator_traits_t = std::allocator_traits<tower_allocator_t>;
+    using links_t = std::vector<skip_link, rebind_t<skip_link>>;
 
     struct node {
         nodeptr left, /**< Left neighbour of a node */
             right;    /**< Right neighbour of a node */
         T* value;     /**< Templated value of a node */
+        skip_tower* tower; /**< Skip-list levels of a node in indexed mode, may be nullptr */
+    };
+
+    /**
+     * Link of a skip-list level.
+     * nullptr "next" is tail of a list, nullptr "prev" is header of an index.
+     */
+    struct skip_link {
+        skip_tower* next, /**< Next tower on this level */
+            *prev;        /**< Previous tower on this level */
+        size_t span;      /**< Count of nodes from this tower to next one */
+    };
+
+    /**
+     * Skip-list levels of a node, links[0] is level over the list itself
+     */
+    struct skip_tower {
+        nodeptr owner; /**< Node of a tower */
+        links_t links; /**< Links of levels */
     };
 
 public:
@@ -171,6 +215,13 @@ public:
 private:
     nodeptr head, /**< Head of a list, has value */
         tail;     /**< Tail of a list, hasn't value */
+    size_t p_count = 0;                    /**< Count of values */
+    bool p_indexed = false;                /**< Whether skip-list index is maintained */
+    links_t p_index_head = links_t(p_alloc); /**< Header of an index, one link per level */
+    std::uint64_t p_index_seed = 0x9E3779B97F4A7C15ull; /**< State of a tower height generator */
+    static constexpr size_t p_index_max_height = 16;     /**< Max count of index levels */
+    size_t p_towers = 0,      /**< Count of allocated towers, for stats() */
+        p_tower_links = 0;    /**< Count of links in allocated towers, for stats() */
 
     /**
      * Function that is used like a constructor
@@ -181,12 +232,24 @@ private:
      */
     template<class... Args>
     auto p_node_allocate(bool allocate, Args&&... args) -> nodeptr {
-        nodeptr n = new node();
+        node_allocator_t node_alloc(p_alloc);
+        nodeptr n = node_allocator_traits_t::allocate(node_alloc, 1);
+        node_allocator_traits_t::construct(node_alloc, n);
         n->left = n->right = nullptr;
         n->value = nullptr;
+        n->tower = nullptr;
         if (allocate) {
-            n->value = p_alloc.allocate(1);
-            allocator_traits_t::construct(p_alloc, n->value, std::forward<Args>(args)...);
+            try {
+                n->value = allocator_traits_t::allocate(p_alloc, 1);
+                allocator_traits_t::construct(p_alloc, n->value, std::forward<Args>(args)...);
+            } catch (...) {
+                if (n->value) {
+                    allocator_traits_t::deallocate(p_alloc, n->value, 1);
+                }
+                node_allocator_traits_t::destroy(node_alloc, n);
+                node_allocator_traits_t::deallocate(node_alloc, n, 1);
+                throw;
+            }
         }
         return n;
     }
@@ -201,14 +264,233 @@ private:
         }
         if (n->value) {
             allocator_traits_t::destroy(p_alloc, n->value);
-            p_alloc.deallocate(n->value, 1);
+            allocator_traits_t::deallocate(p_alloc, n->value, 1);
+        }
+        p_tower_deallocate(n->tower);
+        node_allocator_t node_alloc(p_alloc);
+        node_allocator_traits_t::destroy(node_alloc, n);
+        node_allocator_traits_t::deallocate(node_alloc, n, 1);
+    }
+
+    /**
+     * @param owner node of a tower
+     * @param height count of levels
+     * @return tower with zeroed links
+     */
+    auto p_tower_allocate(nodeptr owner, size_t height) -> skip_tower* {
+        tower_allocator_t tower_alloc(p_alloc);
+        auto t = tower_allocator_traits_t::allocate(tower_alloc, 1);
+        try {
+            tower_allocator_traits_t::construct(tower_alloc, t, skip_tower{owner, links_t(height, skip_link(), p_alloc)});
+        } catch (...) {
+            tower_allocator_traits_t::deallocate(tower_alloc, t, 1);
+            throw;
         }
-        delete n;
+        ++p_towers;
+        p_tower_links += height;
+        return t;
+    }
+
+    void p_tower_deallocate(skip_tower* t) {
+        if (!t) {
+            return;
+        }
+        --p_towers;
+        p_tower_links -= t->links.size();
+        tower_allocator_t tower_alloc(p_alloc);
+        tower_allocator_traits_t::destroy(tower_alloc, t);
+        tower_allocator_traits_t::deallocate(tower_alloc, t, 1);
     }
 
     void p_init() {
         head = p_node_allocate(false);
         tail = head;
+        p_count = 0;
+    }
+
+    /**
+     * @return count of levels for a new tower, geometric with p = 1/4
+     */
+    auto p_index_height() -> size_t {
+        p_index_seed ^= p_index_seed << 13;
+        p_index_seed ^= p_index_seed >> 7;
+        p_index_seed ^= p_index_seed << 17;
+        auto bits = p_index_seed;
+        size_t height = 0;
+        while ((bits & 3) == 0 && height < p_index_max_height) {
+            ++height;
+            bits >>= 2;
+        }
+        return height;
+    }
+
+    /**
+     * @return link of a tower on a level, nullptr tower is a header
+     */
+    auto p_index_link(skip_tower* t, size_t level) -> skip_link& {
+        return t ? t->links[level] : p_index_head[level];
+    }
+
+    /**
+     * @return link of a tower on a level, nullptr tower is a header
+     */
+    auto p_index_link(const skip_tower* t, size_t level) const -> const skip_link& {
+        return t ? t->links[level] : p_index_head[level];
+    }
+
+    /**
+     * Finds closest towers left from a node on each level.
+     * Walks left on the list until first tower, then goes
+     * left and up through towers. Expected O(log n).
+     * Positions count from header: header is 0, head is 1, tail is size + 1.
+     * @param x node to locate, may be tail
+     * @param pred closest tower strictly left from x on each level,
+     *      p_index_max_height elements
+     * @param dist distance from each tower of pred to x,
+     *      p_index_max_height elements
+     * @return position of x
+     */
+    auto p_index_locate(nodeptr x, skip_tower** pred, size_t* dist) const -> size_t {
+        const auto levels = p_index_head.size();
+        size_t d = 1;
+        nodeptr y = (x == head) ? nullptr : x->left;
+        while (y && !y->tower) {
+            y = y->left;
+            ++d;
+        }
+        if (!y) { // header reached, d is a position of x
+            std::fill(pred, pred + levels, nullptr);
+            std::fill(dist, dist + levels, d);
+            return d;
+        }
+        skip_tower* t = y->tower;
+        for (size_t level = 0;; ++level) {
+            // climb to a tower which is high enough for this level,
+            // on the last iteration climbs to header
+            while (t && t->links.size() <= level) {
+                auto prev = t->links[level - 1].prev;
+                d += p_index_link(prev, level - 1).span;
+                t = prev;
+            }
+            if (level == levels) {
+                break;
+            }
+            pred[level] = t;
+            dist[level] = d;
+        }
+        return d;
+    }
+
+    /**
+     * Updates index after node was linked into the list
+     * @param x linked node
+     */
+    void p_index_insert(nodeptr x) {
+        skip_tower* pred[p_index_max_height];
+        size_t dist[p_index_max_height];
+        const auto pos = p_index_locate(x, pred, dist);
+        const auto height = p_index_height();
+        const auto levels = p_index_head.size();
+        for (size_t level = levels; level < height; ++level) {
+            // header spans the whole list before x was inserted
+            p_index_head.push_back(skip_link{nullptr, nullptr, p_count});
+            pred[level] = nullptr;
+            dist[level] = pos;
+        }
+        if (height) {
+            x->tower = p_tower_allocate(x, height);
+        }
+        for (size_t level = 0; level < p_index_head.size(); ++level) {
+            auto& link = p_index_link(pred[level], level);
+            if (level < height) {
+                auto& own = x->tower->links[level];
+                own.next = link.next;
+                own.prev = pred[level];
+                own.span = link.span + 1 - dist[level];
+                if (own.next) {
+                    own.next->links[level].prev = x->tower;
+                }
+                link.next = x->tower;
+                link.span = dist[level];
+            } else {
+                ++link.span;
+            }
+        }
+    }
+
+    /**
+     * Updates index before node is unlinked from the list
+     * @param x node to unlink
+     */
+    void p_index_erase(nodeptr x) {
+        skip_tower* pred[p_index_max_height];
+        size_t dist[p_index_max_height];
+        p_index_locate(x, pred, dist);
+        const auto height = x->tower ? x->tower->links.size() : 0;
+        for (size_t level = 0; level < p_index_head.size(); ++level) {
+            auto& link = p_index_link(pred[level], level);
+            if (level < height) {
+                auto& own = x->tower->links[level];
+                link.next = own.next;
+                link.span += own.span - 1;
+                if (own.next) {
+                    own.next->links[level].prev = pred[level];
+                }
+            } else {
+                --link.span;
+            }
+        }
+        while (!p_index_head.empty() && !p_index_head.back().next) {
+            p_index_head.pop_back();
+        }
+        p_tower_deallocate(x->tower);
+        x->tower = nullptr;
+    }
+
+    /**
+     * Drops all towers of an index
+     */
+    void p_index_clear() {
+        for (auto n = head; n && n != tail; n = n->right) {
+            p_tower_deallocate(n->tower);
+            n->tower = nullptr;
+        }
+        p_index_head.clear();
+    }
+
+    /**
+     * Builds index from scratch in one pass, O(n)
+     */
+    void p_index_build() {
+        p_index_clear();
+        std::vector<skip_tower*, rebind_t<skip_tower*>> last{rebind_t<skip_tower*>(p_alloc)};
+        std::vector<size_t, rebind_t<size_t>> last_pos{rebind_t<size_t>(p_alloc)};
+        size_t pos = 1;
+        for (auto n = head; n != tail; n = n->right, ++pos) {
+            const auto height = p_index_height();
+            if (!height) {
+                continue;
+            }
+            n->tower = p_tower_allocate(n, height);
+            for (size_t level = 0; level < height; ++level) {
+                if (level == p_index_head.size()) {
+                    p_index_head.push_back(skip_link{nullptr, nullptr, 0});
+                    last.push_back(nullptr);
+                    last_pos.push_back(0);
+                }
+                auto& link = p_index_link(last[level], level);
+                link.next = n->tower;
+                link.span = pos - last_pos[level];
+                n->tower->links[level].prev = last[level];
+                last[level] = n->tower;
+                last_pos[level] = pos;
+            }
+        }
+        for (size_t level = 0; level < p_index_head.size(); ++level) {
+            auto& link = p_index_link(last[level], level);
+            link.next = nullptr;
+            link.span = p_count + 1 - last_pos[level];
+        }
     }
 
     void p_erase(nodeptr beg, nodeptr end) {
@@ -222,7 +504,141 @@ private:
         }
     }
 
+    /**
+     * Merges two sorted nullptr-terminated chains linked by "right" pointers.
+     * Left pointers are not maintained, see p_relink.
+     * Stable: equal values of "lhs" go first.
+     * @param lhs first sorted chain
+     * @param rhs second sorted chain
+     * @param comp comparator for values
+     * @return head of a merged chain
+     */
+    template<class Compare>
+    static auto p_merge(nodeptr lhs, nodeptr rhs, Compare& comp) -> nodeptr {
+        node dummy;
+        nodeptr last = &dummy;
+        while (lhs && rhs) {
+            if (comp(*rhs->value, *lhs->value)) {
+                last->right = rhs;
+                rhs = rhs->right;
+            } else {
+                last->right = lhs;
+                lhs = lhs->right;
+            }
+            last = last->right;
+        }
+        last->right = lhs ? lhs : rhs;
+        return dummy.right;
+    }
+
+    /**
+     * Bottom-up merge sort of a chain linked by "right" pointers.
+     * bins[i] holds sorted run of 2^i nodes, so no allocation is needed.
+     * @param first head of a chain
+     * @param last node after the end of a chain, nullptr or tail
+     * @param comp comparator for values
+     * @return head of a sorted nullptr-terminated chain
+     */
+    template<class Compare>
+    static auto p_sort_chain(nodeptr first, nodeptr last, Compare& comp) -> nodeptr {
+        nodeptr bins[64] = {};
+        size_t fill = 0;
+        while (first != last) {
+            nodeptr carry = first;
+            first = first->right;
+            carry->right = nullptr;
+            size_t i = 0;
+            for (; i < fill && bins[i]; ++i) {
+                carry = p_merge(bins[i], carry, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = carry;
+            if (i == fill) {
+                ++fill;
+            }
+        }
+        nodeptr result = nullptr;
+        for (size_t i = 0; i < fill; ++i) {
+            if (bins[i]) {
+                result = p_merge(bins[i], result, comp);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Restores list structure from a nullptr-terminated chain:
+     * sets head, left pointers and links last node to tail
+     * @param first head of a chain, must not be nullptr
+     */
+    void p_relink(nodeptr first) {
+        head = first;
+        first->left = nullptr;
+        auto n = first;
+        while (n->right) {
+            n->right->left = n;
+            n = n->right;
+        }
+        n->right = tail;
+        tail->left = n;
+    }
+
+    /**
+     * Walks list from head to tail, calls "f" for each value
+     * @param f functor to call with a value reference
+     */
+    template<class F>
+    void p_walk(F&& f) const {
+        for (nodeptr n = head; n != tail; n = n->right) {
+            f(*n->value);
+        }
+    }
+
+    /**
+     * Fills "out" with values in a single pass: two cursors walk from head
+     * and tail towards each other and write to both ends of the vector,
+     * so two independent chains of loads are in flight instead of one.
+     * Slots are made up front, that's free only for trivial values.
+     */
+    void p_gather(std::vector<T>& out, std::true_type) const {
+        out.resize(p_count);
+        if (head == tail) {
+            return;
+        }
+        nodeptr fwd = head, bwd = tail->left;
+        size_t front = 0, back = p_count - 1;
+        while (true) {
+            out[front] = *fwd->value;
+            if (fwd == bwd) {
+                break;
+            }
+            out[back] = *bwd->value;
+            if (fwd->right == bwd) {
+                break;
+            }
+            fwd = fwd->right;
+            bwd = bwd->left;
+            ++front;
+            --back;
+            CONT_PREFETCH(fwd->right);
+            CONT_PREFETCH(bwd->left);
+        }
+    }
+    /**
+     * Fills "out" with values from head to tail, for values that can't be made up front
+     */
+    void p_gather(std::vector<T>& out, std::false_type) const {
+        out.reserve(p_count);
+        p_walk([&out](const T& val) { out.emplace_back(val); });
+    }
+
+    /**
+     * Copies values of rhs to the end, a moved from list gets it's sentinel back first
+     */
     void p_transfer(const list<T, Allocator>& rhs) {
+        if (!tail) {
+            p_init();
+        }
         if (rhs.empty()) {
             return;
         }
@@ -233,8 +649,21 @@ private:
         }
     }
 
+    /**
+     * Moves values of rhs one by one, for allocators that can't take over rhs nodes
+     */
+    void p_transfer_values(list<T, Allocator>& rhs) {
+        if (!tail) {
+            p_init();
+        }
+        for (auto n = rhs.head; n && n != rhs.tail; n = n->right) {
+            insert_before(end(), std::move(*n->value));
+        }
+    }
+
 public:
     using allocator_t = Allocator;
+    using allocator_type = Allocator;
     using allocator_traits_t = std::allocator_traits<Allocator>;
     using value_type = T;
     using reference = value_type&;
@@ -248,18 +677,32 @@ public:
      * Default constructor
      * @param count count of nodes to pre-allocate
      * @param val the value to initialize elements of the container with
-     * @param alloc allocator for values
+     * @param alloc allocator for values, nodes and index
      */
     list(size_t count = 0, const T& val = T(), const Allocator& alloc = Allocator());
     /**
-     * Copy constructor, copies list structire and values
+     * Empty list which allocates everything from alloc
+     */
+    explicit list(const Allocator& alloc);
+    /**
+     * Copy constructor, copies list structire and values.
+     * Allocator is select_on_container_copy_construction of rhs allocator
      */
     list(const list<T, Allocator>& rhs);
+    /**
+     * Copy constructor with another allocator
+     */
+    list(const list<T, Allocator>& rhs, const Allocator& alloc);
     /**
      * Move constructor, moves entire list
      * NOTE: move constructor is far more optimized
      */
     list(list<T, Allocator>&& rhs);
+    /**
+     * Move constructor with another allocator,
+     * takes rhs nodes if allocators are equal, moves values one by one otherwise
+     */
+    list(list<T, Allocator>&& rhs, const Allocator& alloc);
     /**
      * Destructor
      */
@@ -273,8 +716,18 @@ public:
      * Assign move operator, clears current list,
      * copies rhs structure and values.
      * NOTE: move assigment is far more optimized
+     * Allocator never propagates: with unequal allocators values are moved one by one
      */
     auto operator=(list<T, Allocator>&& rhs) -> list&;
+    /**
+     * @return allocator of values, nodes and index
+     */
+    auto get_allocator() const -> allocator_type;
+    /**
+     * Memory footprint in O(1), index towers count as nodes.
+     * Allocation counters are filled if Allocator is cont::counting_allocator
+     */
+    auto stats() const -> container_stats;
     /**
      * Checks if list is empty.
      * If head's address equals tail's address, return true.
@@ -336,9 +789,104 @@ public:
     template<class It = iterator>
     auto end() -> It;
     /**
-     * @return size of a list, difference of begin() and end()
+     * @return size of a list, O(1)
      */
     auto size() const -> size_type;
+    /**
+     * Turns on indexed mode, builds index in O(n).
+     * In indexed mode list maintains skip-list levels with spans over nodes,
+     * which gives O(log n) nth, index_of, insert_at and erase_at.
+     * insert, insert_before and erase become O(log n) too.
+     */
+    void enable_index();
+    /**
+     * Turns off indexed mode, drops index
+     */
+    void disable_index();
+    /**
+     * @return whether list is in indexed mode
+     */
+    auto indexed() const -> bool;
+    /**
+     * Gives iterator to k-th value.
+     * O(log n) in indexed mode, O(k) otherwise.
+     * @param k position of value
+     * @return iterator to k-th value, end() if k >= size()
+     */
+    template<class It = iterator>
+    auto nth(size_type k) const -> It;
+    /**
+     * Gives position of an iterator.
+     * O(log n) in indexed mode, O(n) otherwise.
+     * @param it iterator to locate
+     * @return position of an iterator, size() for end()
+     */
+    template<class It>
+    auto index_of(const It& it) const -> size_type;
+    /**
+     * Inserts value constructed with provided args at position k
+     * @param k position of a new value, k <= size()
+     * @param args parameter pack for construction of a value
+     * @return iterator to inserted value
+     */
+    template<class... Args>
+    auto insert_at(size_type k, Args&&... args) -> iterator;
+    /**
+     * Erases value at position k
+     * @param k position of a value, k < size()
+     * @return iterator to next value
+     */
+    auto erase_at(size_type k) -> iterator;
+    /**
+     * Calls "f" for each value from head to tail
+     * @param f functor to call with a value reference
+     * @return f
+     */
+    template<class F>
+    auto for_each(F f) -> F;
+    /**
+     * Calls "f" for each value from head to tail
+     * @param f functor to call with a const value reference
+     * @return f
+     */
+    template<class F>
+    auto for_each(F f) const -> F;
+    /**
+     * Copies values to output iterator
+     * @param out output iterator
+     * @return output iterator past the last copied value
+     */
+    template<class OutIt>
+    auto copy_to(OutIt out) const -> OutIt;
+    /**
+     * Gathers values into contiguous storage, one allocation of size().
+     * Trivial values are gathered walking from both ends at once, so it's faster than copy_to.
+     * Use it to run vectorized kernels over values of a list.
+     * @return vector with copies of values
+     */
+    auto to_vector() const -> std::vector<T>;
+    /**
+     * Sorts list with bottom-up merge sort.
+     * Only "left" and "right" pointers of nodes are relinked:
+     * no allocations, no value copies or moves, iterators stay valid.
+     * Sort is stable.
+     * @param comp comparator for values, must not throw
+     */
+    template<class Compare = std::less<T>>
+    void sort(Compare comp = Compare());
+    /**
+     * Sorts list in parallel.
+     * List is split into per-thread runs, each run is sorted like sort() does,
+     * then runs are merged pairwise. Falls back to sort() for short lists.
+     * Sort is stable.
+     * @param comp comparator for values, must not throw and must be
+     *      safe to call concurrently
+     * @param threads count of threads to use, 0 means hardware concurrency
+     * @throw std::system_error if a thread can't be started, list keeps all values
+     *      in unspecified order then
+     */
+    template<class Compare = std::less<T>>
+    void parallel_sort(Compare comp = Compare(), size_type threads = 0);
     /**
      * Equals operator
      * Checks if rhs values are equeal to current list's.
@@ -356,6 +904,9 @@ public:
     auto operator!=(const list<T, Allocator>& rhs) const -> bool;
 };
 
+template<class T, class Allocator>
+constexpr size_t list<T, Allocator>::p_index_max_height;
+
 //*** iterator_base ***
 template<class T, class Allocator>
 list<T, Allocator>::iterator_base::iterator_base(nodeptr n) {
@@ -398,12 +949,16 @@ list<T, Allocator>::iterator::iterator(const iterator_base& rhs)
 
 template<class T, class Allocator>
 auto list<T, Allocator>::iterator::operator++() -> iterator& {
+    CONT_INSTRUMENT_OP(list_next);
+    CONT_INSTRUMENT_VISIT(1);
     this->n = this->n->right;
     return *this;
 }
 
 template<class T, class Allocator>
 auto list<T, Allocator>::iterator::operator--() -> iterator& {
+    CONT_INSTRUMENT_OP(list_prev);
+    CONT_INSTRUMENT_VISIT(1);
     this->n = this->n->left;
     return *this;
 }
@@ -466,11 +1021,24 @@ list<T, Allocator>::list(size_t count, const T& val, const Allocator& alloc)
     }
 }
 
+template<class T, class Allocator>
+list<T, Allocator>::list(const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+}
+
 template<class T, class Allocator>
 list<T, Allocator>::list(const list<T, Allocator>& rhs)
-    : p_alloc(rhs.p_alloc) {
+    : list(rhs, allocator_traits_t::select_on_container_copy_construction(rhs.p_alloc)) {}
+
+template<class T, class Allocator>
+list<T, Allocator>::list(const list<T, Allocator>& rhs, const Allocator& alloc)
+    : p_alloc(alloc) {
     p_init();
     *this = rhs;
+    if (rhs.p_indexed) {
+        enable_index();
+    }
 }
 
 template<class T, class Allocator>
@@ -478,8 +1046,24 @@ list<T, Allocator>::list(list<T, Allocator>&& rhs)
     : p_alloc(rhs.p_alloc) {
     this->head = rhs.head;
     this->tail = rhs.tail;
+    this->p_count = rhs.p_count;
+    this->p_indexed = rhs.p_indexed;
+    this->p_index_head = std::move(rhs.p_index_head);
+    this->p_towers = rhs.p_towers;
+    this->p_tower_links = rhs.p_tower_links;
     rhs.head = nullptr;
     rhs.tail = nullptr;
+    rhs.p_count = 0;
+    rhs.p_indexed = false;
+    rhs.p_index_head.clear();
+    rhs.p_towers = rhs.p_tower_links = 0;
+}
+
+template<class T, class Allocator>
+list<T, Allocator>::list(list<T, Allocator>&& rhs, const Allocator& alloc)
+    : p_alloc(alloc) {
+    p_init();
+    *this = std::move(rhs);
 }
 
 template<class T, class Allocator>
@@ -490,6 +1074,9 @@ list<T, Allocator>::~list() {
 
 template<class T, class Allocator>
 auto list<T, Allocator>::operator=(const list<T, Allocator>& rhs) -> list<T, Allocator>& {
+    if (this == &rhs) {
+        return *this;
+    }
     clear();
     p_transfer(rhs);
     return *this;
@@ -497,14 +1084,54 @@ auto list<T, Allocator>::operator=(const list<T, Allocator>& rhs) -> list<T, All
 
 template<class T, class Allocator>
 auto list<T, Allocator>::operator=(list<T, Allocator>&& rhs) -> list<T, Allocator>& {
+    if (this == &rhs) {
+        return *this;
+    }
+    if (!(p_alloc == rhs.p_alloc)) {
+        // nodes of rhs can't be freed with our allocator
+        clear();
+        p_transfer_values(rhs);
+        rhs.clear();
+        if (rhs.p_indexed != p_indexed) {
+            rhs.p_indexed ? enable_index() : disable_index();
+        }
+        return *this;
+    }
     p_erase(head, tail);
+    p_node_deallocate(tail);
     this->head = rhs.head;
     this->tail = rhs.tail;
+    this->p_count = rhs.p_count;
+    this->p_indexed = rhs.p_indexed;
+    this->p_index_head = std::move(rhs.p_index_head);
+    this->p_towers = rhs.p_towers;
+    this->p_tower_links = rhs.p_tower_links;
     rhs.head = nullptr;
     rhs.tail = nullptr;
+    rhs.p_count = 0;
+    rhs.p_indexed = false;
+    rhs.p_index_head.clear();
+    rhs.p_towers = rhs.p_tower_links = 0;
     return *this;
 }
 
+template<class T, class Allocator>
+auto list<T, Allocator>::get_allocator() const -> allocator_type {
+    return p_alloc;
+}
+
+template<class T, class Allocator>
+auto list<T, Allocator>::stats() const -> container_stats {
+    container_stats result;
+    result.elements = p_count;
+    result.live_nodes = p_count + (tail ? 1 : 0);
+    result.node_bytes = result.live_nodes * sizeof(node) + p_towers * sizeof(skip_tower)
+        + (p_tower_links + p_index_head.capacity()) * sizeof(skip_link);
+    result.value_bytes = p_count * sizeof(T);
+    detail::add_counters(result, p_alloc);
+    return result;
+}
+
 template<class T, class Allocator>
 auto list<T, Allocator>::empty() const -> bool {
     return this->head == this->tail;
@@ -514,6 +1141,11 @@ template<class T, class Allocator>
 void list<T, Allocator>::clear() {
     p_erase(head, tail);
     head = tail;
+    if (tail) {
+        tail->left = nullptr;
+    }
+    p_count = 0;
+    p_index_head.clear();
 }
 
 template<class T, class Allocator>
@@ -524,6 +1156,9 @@ auto list<T, Allocator>::erase(const It& it) -> It {
         return end<It>();
     }
     It bak = It(n->right);
+    if (p_indexed) {
+        p_index_erase(n);
+    }
     if (it == begin<It>()) {
         this->head = n->right;
         n->right->left = nullptr;
@@ -532,6 +1167,7 @@ auto list<T, Allocator>::erase(const It& it) -> It {
         n->left->right = n->right;
     }
     p_node_deallocate(n);
+    --p_count;
     return bak;
 }
 
@@ -564,6 +1200,10 @@ auto list<T, Allocator>::insert(const It& it, Args&&... args) -> It {
         it.n->right = tmp;
         tmp->left = it.n;
     }
+    ++p_count;
+    if (p_indexed) {
+        p_index_insert(tmp);
+    }
     return It(tmp);
 }
 
@@ -587,6 +1227,10 @@ auto list<T, Allocator>::insert_before(const It& it, Args&&... args) -> It {
             it.n->left = tmp;
         }
     }
+    ++p_count;
+    if (p_indexed) {
+        p_index_insert(tmp);
+    }
     return It(tmp);
 }
 
@@ -616,15 +1260,238 @@ auto list<T, Allocator>::end() -> It {
 
 template<class T, class Allocator>
 auto list<T, Allocator>::size() const -> size_type {
-    size_type result = 0;
-    auto it = begin();
-    while (it != end()) {
-        ++it;
-        ++result;
+    return p_count;
+}
+
+template<class T, class Allocator>
+void list<T, Allocator>::enable_index() {
+    if (p_indexed) {
+        return;
+    }
+    p_indexed = true;
+    p_index_build();
+}
+
+template<class T, class Allocator>
+void list<T, Allocator>::disable_index() {
+    p_index_clear();
+    p_indexed = false;
+}
+
+template<class T, class Allocator>
+auto list<T, Allocator>::indexed() const -> bool {
+    return p_indexed;
+}
+
+template<class T, class Allocator>
+template<class It>
+auto list<T, Allocator>::nth(size_type k) const -> It {
+    if (k >= p_count) {
+        return end<It>();
+    }
+    const auto target = k + 1;
+    size_t pos = 0;
+    skip_tower* t = nullptr;
+    for (size_t level = p_index_head.size(); level-- > 0;) {
+        while (true) {
+            auto& link = t ? t->links[level] : p_index_head[level];
+            if (!link.next || pos + link.span > target) {
+                break;
+            }
+            pos += link.span;
+            t = link.next;
+        }
+    }
+    nodeptr n = head;
+    if (t) {
+        n = t->owner;
+    } else {
+        pos = 1;
+    }
+    for (; pos < target; ++pos) {
+        n = n->right;
+    }
+    return It(n);
+}
+
+template<class T, class Allocator>
+template<class It>
+auto list<T, Allocator>::index_of(const It& it) const -> size_type {
+    if (it.n == tail) {
+        return p_count;
     }
+    if (!p_indexed) {
+        size_type result = 0;
+        for (auto n = head; n != it.n; n = n->right) {
+            ++result;
+        }
+        return result;
+    }
+    skip_tower* pred[p_index_max_height];
+    size_t dist[p_index_max_height];
+    return p_index_locate(it.n, pred, dist) - 1;
+}
+
+template<class T, class Allocator>
+template<class... Args>
+auto list<T, Allocator>::insert_at(size_type k, Args&&... args) -> iterator {
+    assert(k <= p_count);
+    return insert_before(nth(k), std::forward<Args>(args)...);
+}
+
+template<class T, class Allocator>
+auto list<T, Allocator>::erase_at(size_type k) -> iterator {
+    assert(k < p_count);
+    return erase(nth(k));
+}
+
+template<class T, class Allocator>
+template<class F>
+auto list<T, Allocator>::for_each(F f) -> F {
+    p_walk([&f](T& val) { f(val); });
+    return f;
+}
+
+template<class T, class Allocator>
+template<class F>
+auto list<T, Allocator>::for_each(F f) const -> F {
+    p_walk([&f](const T& val) { f(val); });
+    return f;
+}
+
+template<class T, class Allocator>
+template<class OutIt>
+auto list<T, Allocator>::copy_to(OutIt out) const -> OutIt {
+    p_walk([&out](const T& val) {
+        *out = val;
+        ++out;
+    });
+    return out;
+}
+
+template<class T, class Allocator>
+auto list<T, Allocator>::to_vector() const -> std::vector<T> {
+    std::vector<T> result;
+    p_gather(result, std::is_trivially_default_constructible<T>());
     return result;
 }
 
+template<class T, class Allocator>
+template<class Compare>
+void list<T, Allocator>::sort(Compare comp) {
+    if (head == tail || head->right == tail) {
+        return;
+    }
+    p_relink(p_sort_chain(head, tail, comp));
+    if (p_indexed) {
+        p_index_build();
+    }
+}
+
+template<class T, class Allocator>
+template<class Compare>
+void list<T, Allocator>::parallel_sort(Compare comp, size_type threads) {
+    const size_type min_run = 1 << 14;
+    if (threads == 0) {
+        threads = std::max<size_type>(1, std::thread::hardware_concurrency());
+    }
+    const auto count = size();
+    threads = std::min(threads, count / min_run);
+    if (threads < 2) {
+        sort(comp);
+        return;
+    }
+    std::vector<nodeptr> runs(threads);
+    std::vector<std::future<nodeptr>> futures;
+    futures.reserve(threads);
+    // cut list into nullptr-terminated runs of equal length
+    auto n = head;
+    for (size_type i = 0; i < threads; ++i) {
+        runs[i] = n;
+        auto len = (i + 1 == threads) ? count - (count / threads) * i : count / threads;
+        for (size_type j = 1; j < len; ++j) {
+            n = n->right;
+        }
+        auto next = n->right;
+        n->right = nullptr;
+        n = next;
+    }
+    auto run_sort = [&comp](nodeptr first) {
+        auto c = comp;
+        return p_sort_chain(first, nullptr, c);
+    };
+    auto run_merge = [&comp](nodeptr lhs, nodeptr rhs) {
+        auto c = comp;
+        return p_merge(lhs, rhs, c);
+    };
+    // if a thread can't be started, runs are chained back in a row, so list stays whole if not sorted
+    auto restore = [this, &runs]() {
+        nodeptr first = nullptr, last = nullptr;
+        for (auto run : runs) {
+            if (!run) {
+                continue;
+            }
+            if (last) {
+                last->right = run;
+            } else {
+                first = run;
+            }
+            last = run;
+            while (last->right) {
+                last = last->right;
+            }
+        }
+        p_relink(first);
+        if (p_indexed) {
+            p_index_build();
+        }
+    };
+    try {
+        for (size_type i = 1; i < runs.size(); ++i) {
+            futures.emplace_back(std::async(std::launch::async, run_sort, runs[i]));
+        }
+    } catch (...) {
+        for (size_type i = 0; i < futures.size(); ++i) {
+            runs[i + 1] = futures[i].get();
+        }
+        restore();
+        throw;
+    }
+    runs[0] = run_sort(runs[0]);
+    for (size_type i = 1; i < runs.size(); ++i) {
+        runs[i] = futures[i - 1].get();
+    }
+    // merge neighbouring runs pairwise, keeping their order for stability
+    while (runs.size() > 1) {
+        std::vector<nodeptr> merged((runs.size() + 1) / 2);
+        futures.clear();
+        try {
+            for (size_type i = 2; i + 1 < runs.size(); i += 2) {
+                futures.emplace_back(std::async(std::launch::async, run_merge, runs[i], runs[i + 1]));
+            }
+        } catch (...) {
+            for (size_type i = 0; i < futures.size(); ++i) {
+                runs[2 * i + 2] = futures[i].get();
+                runs[2 * i + 3] = nullptr;
+            }
+            restore();
+            throw;
+        }
+        merged[0] = run_merge(runs[0], runs[1]);
+        for (size_type i = 0; i < futures.size(); ++i) {
+            merged[i + 1] = futures[i].get();
+        }
+        if (runs.size() % 2) {
+            merged.back() = runs.back();
+        }
+        runs = std::move(merged);
+    }
+    p_relink(runs[0]);
+    if (p_indexed) {
+        p_index_build();
+    }
+}
+
 template<class T, class Allocator>
 auto list<T, Allocator>::operator==(const list<T, Allocator>& rhs) const -> bool {
     auto lhs_it = begin();
@@ -649,4 +1516,14 @@ template<class T, class Allocator>
 auto list<T, Allocator>::operator!=(const list<T, Allocator>& rhs) const -> bool {
     return !(*this == rhs);
 }
+
+#if CONT_HAS_PMR
+namespace pmr {
+/**
+ * List whose values, nodes and index come from a std::pmr::memory_resource
+ */
+template<class T>
+using list = cont::list<T, std::pmr::polymorphic_allocator<T>>;
+}; // namespace pmr
+#endif
 }; // namespace cont
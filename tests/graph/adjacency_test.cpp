@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+
+using graph = cxx_graph::graph<int>;
+using cxx_graph::adjacency_mode;
+
+std::vector<int> values(const std::vector<graph::bfs_iterator> &nodes){
+    std::vector<int> result;
+    for(auto& it:nodes){
+        result.emplace_back(*it);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int main(){
+    for(auto mode:{adjacency_mode::unordered, adjacency_mode::sorted, adjacency_mode::hashed}){
+        // hub with parallel edges and a loop, small threshold to exercise hash sets
+        graph gr;
+        gr.set_adjacency_mode(mode, 4);
+        assert(gr.get_adjacency_mode() == mode);
+        std::vector<graph::bfs_iterator> nodes;
+        for(int i=0; i<10; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        std::vector<graph::edge_id> spokes;
+        for(int i=1; i<10; i++){
+            spokes.emplace_back(gr.connect(nodes[0], nodes[i]));
+        }
+        auto parallel = gr.connect(nodes[0], nodes[3]);
+        auto loop = gr.connect(nodes[0], nodes[0]);
+        gr.connect(nodes[2], nodes[3]);
+        gr.connect(nodes[3], nodes[4]);
+        gr.connect(nodes[2], nodes[4]);
+
+        assert(graph::is_adjacent(nodes[0], nodes[5]));
+        assert(graph::is_adjacent(nodes[5], nodes[0]));
+        assert(graph::is_adjacent(nodes[0], nodes[0]));
+        assert(!graph::is_adjacent(nodes[5], nodes[6]));
+        assert(values(graph::common_neighbors(nodes[2], nodes[3])) == (std::vector<int>{0, 4}));
+        // loop makes hub a neighbour of itself
+        assert(values(graph::common_neighbors(nodes[0], nodes[2])) == (std::vector<int>{0, 3, 4}));
+        assert(graph::common_neighbors(nodes[5], nodes[6]) == (std::vector<graph::bfs_iterator>{nodes[0]}));
+
+        // parallel edge keeps adjacency after one of them goes
+        gr.disconnect(spokes[2]);
+        assert(graph::is_adjacent(nodes[0], nodes[3]));
+        gr.disconnect(parallel);
+        assert(!graph::is_adjacent(nodes[0], nodes[3]));
+        gr.disconnect(loop);
+        assert(!graph::is_adjacent(nodes[0], nodes[0]));
+        // shrink hub below threshold and grow back
+        for(int i=4; i<10; i++){
+            gr.disconnect(spokes[i-1]);
+        }
+        assert(!graph::is_adjacent(nodes[0], nodes[9]));
+        assert(graph::is_adjacent(nodes[0], nodes[1]));
+        for(int i=4; i<10; i++){
+            gr.connect(nodes[i], nodes[0]);
+        }
+        assert(graph::is_adjacent(nodes[9], nodes[0]));
+        gr.erase(nodes[3]);
+        assert(values(graph::common_neighbors(nodes[0], nodes[2])) == (std::vector<int>{4}));
+        // mode switch and reorder keep answers
+        gr.set_adjacency_mode(adjacency_mode::hashed, 2);
+        gr.reorder(cxx_graph::reorder_policy::rcm);
+        auto csr = gr.to_csr();
+        size_t adjacent = 0;
+        std::vector<graph::bfs_iterator> all;
+        for(auto it = graph::bfs_iterator(gr.begin()); it != gr.end(); ++it){
+            all.emplace_back(it);
+        }
+        for(auto& a:all){
+            for(auto& b:all){
+                adjacent += graph::is_adjacent(a, b);
+            }
+        }
+        assert(adjacent == csr.edge_count());
+        gr.set_adjacency_mode(adjacency_mode::unordered);
+        assert(gr.edge_count() == csr.edge_count()/2);
+    }
+    {
+        // random graph: modes agree, triangles match brute force
+        const int size = 300;
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<int> dist(0, size-1);
+        std::set<std::pair<int, int>> pairs;
+        while(pairs.size() < 3000){
+            auto a = dist(gen), b = dist(gen);
+            if(a != b){
+                pairs.emplace(std::min(a, b), std::max(a, b));
+            }
+        }
+        graph plain, hashed;
+        hashed.set_adjacency_mode(adjacency_mode::hashed, 16);
+        std::vector<graph::bfs_iterator> plain_nodes, hashed_nodes;
+        for(int i=0; i<size; i++){
+            plain_nodes.emplace_back(plain.insert(i));
+            hashed_nodes.emplace_back(hashed.insert(i));
+        }
+        for(auto& p:pairs){
+            plain.connect(plain_nodes[p.first], plain_nodes[p.second]);
+            hashed.connect(hashed_nodes[p.first], hashed_nodes[p.second]);
+        }
+        for(int i=0; i<200; i++){
+            auto a = dist(gen), b = dist(gen);
+            assert(graph::is_adjacent(plain_nodes[a], plain_nodes[b]) == graph::is_adjacent(hashed_nodes[a], hashed_nodes[b]));
+            assert(values(graph::common_neighbors(plain_nodes[a], plain_nodes[b]))
+                == values(graph::common_neighbors(hashed_nodes[a], hashed_nodes[b])));
+        }
+        uint64_t expected = 0;
+        for(auto& p:pairs){
+            for(int w=p.second+1; w<size; w++){
+                expected += pairs.count({p.first, w}) && pairs.count({p.second, w});
+            }
+        }
+        cxx_graph::thread_pool pool(3);
+        assert(cxx_graph::graph_algo::triangle_count(plain.to_csr(), pool) == expected);
+        assert(cxx_graph::graph_algo::triangle_count(hashed.to_csr()) == expected);
+    }
+    std::cout << "adjacency test done\n";
+    return 0;
+};
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "graph.hpp"
+#include "test_allocator.hpp"
+
+using alloc = arena_allocator<int>;
+using graph = cxx_graph::graph<int, int, alloc>;
+
+/**
+ * Ring of "n" nodes with chords from node 0, so node 0 has a hash set
+ * @return handle of node 1
+ */
+cxx_graph::node_handle fill(graph &gr, int n){
+    // scratch from arena 0 too, the test counts every global new
+    std::vector<graph::default_it, arena_allocator<graph::default_it>> nodes(alloc(0));
+    nodes.reserve(n);
+    for(int i=0; i<n; i++){
+        nodes.emplace_back(gr.insert(i));
+    }
+    for(int i=0; i<n; i++){
+        gr.connect(nodes[i], nodes[(i+1) % n], i);
+        if(i > 1 && i+1 < n){
+            gr.connect(nodes[0], nodes[i], -i);
+        }
+    }
+    return gr.handle(nodes[1]);
+}
+
+int main(){
+    {
+        graph gr(alloc(1));
+        gr.set_adjacency_mode(cxx_graph::adjacency_mode::hashed, 8);
+        const auto news = global_news;
+        auto second = fill(gr, 100);
+        auto h = gr.handle(gr.begin());
+        auto victim = gr.find(second);
+        gr.erase(victim);
+        assert(gr.size() == 99 && arena_live[1] > 0);
+
+        graph copy(gr, alloc(2));
+        assert(copy.size() == 99 && copy.edge_count() == gr.edge_count());
+        assert(copy.get_allocator() == alloc(2) && arena_live[2] > 0);
+        // unequal allocators copy, equal ones take over nodes
+        graph moved(std::move(copy), alloc(1));
+        assert(moved.size() == 99 && copy.size() == 0 && *moved.find(h) == 0);
+        graph same(alloc(1));
+        same = std::move(moved);
+        assert(same.size() == 99 && same.edge_count() == gr.edge_count());
+        graph directed(cxx_graph::direction::directed, alloc(3));
+        fill(directed, 10);
+        directed = std::move(same);
+        assert(directed.size() == 99 && !directed.is_directed());
+        assert(global_news == news);
+
+        // reorder and traversals use scratch memory, nodes still come from the arena
+        gr.reorder(cxx_graph::reorder_policy::rcm);
+        assert(*gr.find(h) == 0 && gr.edge_count() == directed.edge_count());
+    }
+    assert(arena_live[0] == 0 && arena_live[1] == 0 && arena_live[2] == 0 && arena_live[3] == 0);
+#if CONT_HAS_PMR
+    {
+        // every byte comes from a buffer, upstream refuses to allocate
+        static char buffer[1 << 18];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        const auto news = global_news;
+        cxx_graph::pmr::graph<int> gr(&arena);
+        auto a = gr.insert(1);
+        for(int i=0; i<500; i++){
+            auto b = gr.insert(i);
+            gr.connect(a, b);
+        }
+        gr.set_adjacency_mode(cxx_graph::adjacency_mode::hashed);
+        cxx_graph::pmr::graph<int> copy(gr, &arena);
+        assert(copy.size() == 501 && copy.edge_count() == 500);
+        assert(global_news == news);
+    }
+#endif
+    std::cout << "allocator test done\n";
+    return 0;
+};
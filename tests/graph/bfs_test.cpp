@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+auto bfs_order(graph::bfs_iterator it, const graph& gr){
+    std::vector<int> result;
+    while(it != gr.end()){
+        result.emplace_back(*it);
+        ++it;
+    }
+    return result;
+}
+
+int main(){
+    {
+        /*  0 - 1 - 3
+            |   |
+            2   5
+            |
+            4
+        */
+        graph gr;
+        assert(gr.begin() == gr.end());
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.add_adjacent(it_0, 1);
+        auto it_2 = gr.add_adjacent(it_0, 2);
+        gr.add_adjacent(it_1, 3);
+        gr.add_adjacent(it_2, 4);
+        gr.add_adjacent(it_1, 5);
+        assert(bfs_order(gr.begin(), gr) == (std::vector<int>{0, 1, 2, 3, 5, 4}));
+        assert(bfs_order(it_2, gr) == (std::vector<int>{2, 0, 4, 1, 3, 5}));
+
+        // copies share traversal, but have their own positions
+        auto it = gr.begin();
+        ++it;
+        auto copy = it++;
+        assert(*copy == 1);
+        assert(*it == 2);
+        ++it;
+        ++it;
+        ++copy;
+        assert(*copy == 2);
+        assert(*it == 5);
+        --it;
+        assert(*it == 3);
+        while(it != gr.end()){
+            ++it;
+        }
+        --it;
+        assert(*it == 4);
+        bool thrown = false;
+        try{
+            auto first = gr.begin();
+            ++first;
+            --first;
+            --first;
+        }catch(const std::out_of_range&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // small star with a long tail: traversal is linear,
+        // quadratic one would take minutes
+        graph gr;
+        const int size = 200000;
+        auto center = gr.insert(0);
+        for(int i=1; i<100; i++){
+            gr.add_adjacent(center, i);
+        }
+        auto tail = gr.add_adjacent(center, 100);
+        for(int i=101; i<size; i++){
+            tail = gr.add_adjacent(tail, i);
+        }
+        size_t count = 0;
+        for(auto it = gr.begin(); it != gr.end(); ++it){
+            count++;
+        }
+        assert(count == size);
+    }
+    std::cout << "bfs test done\n";
+    return 0;
+};
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+
+int main(){
+    {
+        cxx_graph::disjoint_set set(4);
+        assert(set.set_count() == 4);
+        assert(set.unite(0, 1));
+        assert(!set.unite(1, 0));
+        assert(set.unite(2, 3));
+        assert(set.set_count() == 2);
+        assert(!set.same(0, 3));
+        auto x = set.add();
+        assert(x == 4);
+        assert(set.unite(3, x));
+        assert(set.same(2, 4));
+        assert(set.set_count() == 2);
+    }
+    for(bool tracked:{false, true}){
+        graph gr;
+        if(tracked){
+            gr.enable_components();
+        }
+        assert(gr.components_tracked() == tracked);
+        assert(gr.component_count() == 0);
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.add_adjacent(it_0, 1);
+        auto it_2 = gr.insert(2);
+        auto it_3 = gr.add_adjacent(it_2, 3);
+        assert(gr.component_count() == 2);
+        assert(gr.connected(it_0, it_1));
+        assert(!gr.connected(it_1, it_3));
+        auto e_13 = gr.connect(it_1, it_3);
+        assert(gr.connected(it_0, it_2));
+        assert(gr.component_count() == 1);
+        gr.disconnect(e_13);
+        assert(!gr.connected(it_0, it_2));
+        assert(gr.component_count() == 2);
+        // updates after rebuild keep working
+        gr.connect(it_0, it_2);
+        assert(gr.connected(it_1, it_3));
+        gr.erase(it_0);
+        assert(gr.component_count() == 2);
+        assert(gr.connected(it_2, it_3));
+        assert(!gr.connected(it_1, it_2));
+        auto it_4 = gr.add_adjacent(it_1, 4);
+        assert(gr.connected(it_4, it_1));
+        assert(gr.component_count() == 2);
+    }
+    {
+        // tracked answers match untracked ones on a random graph with removals
+        graph gr;
+        std::vector<graph::bfs_iterator> nodes;
+        std::vector<graph::edge_id> edges;
+        std::mt19937 gen(3);
+        for(int i=0; i<2000; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        gr.enable_components();
+        std::uniform_int_distribution<size_t> node_dist(0, nodes.size()-1);
+        for(int i=0; i<1500; i++){
+            edges.emplace_back(gr.connect(nodes[node_dist(gen)], nodes[node_dist(gen)]));
+        }
+        auto tracked = gr.component_count();
+        gr.disable_components();
+        assert(gr.component_count() == tracked);
+        gr.enable_components();
+        for(int i=0; i<300; i++){
+            gr.disconnect(edges[i*5]);
+        }
+        tracked = gr.component_count();
+        std::vector<std::pair<size_t, size_t>> pairs;
+        std::vector<bool> answers;
+        for(int i=0; i<100; i++){
+            pairs.emplace_back(node_dist(gen), node_dist(gen));
+            answers.emplace_back(gr.connected(nodes[pairs.back().first], nodes[pairs.back().second]));
+        }
+        gr.disable_components();
+        assert(gr.component_count() == tracked);
+        for(int i=0; i<100; i++){
+            assert(gr.connected(nodes[pairs[i].first], nodes[pairs[i].second]) == answers[i]);
+        }
+    }
+    std::cout << "components test done\n";
+    return 0;
+};
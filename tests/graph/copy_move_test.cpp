@@ -0,0 +1,154 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int, int>;
+using cxx_graph::adjacency_mode;
+
+bool same(const graph &a, const graph &b){
+    auto csr_a = a.to_csr(), csr_b = b.to_csr();
+    return csr_a.offsets() == csr_b.offsets() && csr_a.targets() == csr_b.targets()
+        && csr_a.values() == csr_b.values() && csr_a.edge_values() == csr_b.edge_values()
+        && a.edge_count() == b.edge_count();
+}
+
+graph random_graph(int size, int edges, std::mt19937 &gen, std::vector<graph::edge_id> &ids){
+    graph gr;
+    std::vector<graph::bfs_iterator> nodes;
+    for(int i=0; i<size; i++){
+        nodes.emplace_back(gr.insert(i));
+    }
+    std::uniform_int_distribution<int> dist(0, size-1);
+    for(int i=0; i<edges; i++){
+        ids.emplace_back(gr.connect(nodes[dist(gen)], nodes[dist(gen)], i));
+    }
+    return gr;
+}
+
+// copy throws once the budget runs out
+struct thrower{
+    static inline int budget = -1;
+    int value = 0;
+    thrower(int v):value(v){}
+    thrower(thrower &&) = default;
+    thrower(const thrower &rhs):value(rhs.value){
+        if(budget == 0){
+            throw std::runtime_error("copy");
+        }
+        budget--;
+    }
+};
+
+int main(){
+    std::mt19937 gen(5);
+    for(auto mode:{adjacency_mode::unordered, adjacency_mode::sorted, adjacency_mode::hashed}){
+        std::vector<graph::edge_id> ids;
+        auto gr = random_graph(200, 1500, gen, ids);
+        gr.set_adjacency_mode(mode, 8);
+        gr.enable_components();
+        // holes in the arena and in a reordered block
+        for(size_t i=0; i<ids.size(); i+=7){
+            gr.disconnect(ids[i]);
+        }
+        auto it = graph::bfs_iterator(gr.begin());
+        gr.erase(it);
+        gr.reorder(cxx_graph::reorder_policy::rcm);
+        gr.insert(1000);
+        // erase took some edges too
+        std::vector<graph::edge_id> live;
+        for(size_t i=1; i<ids.size(); i++){
+            try{
+                gr.edge_value(ids[i]);
+                live.emplace_back(ids[i]);
+            }catch(const std::out_of_range&){
+            }
+        }
+
+        graph copy(gr);
+        assert(same(copy, gr));
+        assert(copy.get_adjacency_mode() == mode);
+        assert(copy.component_count() == gr.component_count());
+        for(auto id:live){
+            assert(copy.edge_value(id) == gr.edge_value(id));
+        }
+        // copy is independent and consistent: removing every edge must not touch original
+        auto original_edges = gr.edge_count();
+        for(auto id:live){
+            copy.disconnect(id);
+        }
+        assert(copy.edge_count() == 0);
+        assert(gr.edge_count() == original_edges);
+        for(auto node = graph::bfs_iterator(copy.begin()); node != copy.end(); ++node){
+            assert(graph::get_adjacent(node).empty());
+        }
+
+        // copy of a copy keeps sorted lists, then it is changed as any graph
+        graph second = gr;
+        graph third = second;
+        assert(same(third, gr));
+        auto a = graph::bfs_iterator(third.begin()), b = third.insert(-1);
+        third.connect(a, b, 7);
+        assert(graph::is_adjacent(a, b));
+        assert(third.edge_count() == gr.edge_count()+1);
+
+        graph moved(std::move(second));
+        assert(same(moved, gr));
+        assert(second.size() == 0 && second.edge_count() == 0);
+        assert(second.begin() == second.end());
+        // moved-from graph is usable
+        auto x = second.insert(1), y = second.insert(2);
+        second.connect(x, y, 3);
+        assert(second.size() == 2 && second.edge_count() == 1);
+
+        moved = std::move(second);
+        assert(moved.size() == 2 && moved.edge_count() == 1);
+        moved = gr;
+        assert(same(moved, gr));
+        const auto& self = moved;
+        moved = self;
+        assert(same(moved, gr));
+        moved.clear();
+        assert(moved.size() == 0 && moved.edge_count() == 0);
+        assert(moved.component_count() == 0);
+    }
+    {
+        // a throwing node copy leaves the target empty and usable
+        using tgraph = cxx_graph::graph<thrower, int>;
+        tgraph gr, target;
+        std::vector<tgraph::bfs_iterator> nodes;
+        for(int i=0; i<10; i++){
+            nodes.emplace_back(gr.insert(thrower(i)));
+        }
+        for(int i=1; i<10; i++){
+            gr.connect(nodes[i-1], nodes[i], i);
+        }
+        target.insert(thrower(-1));
+        thrower::budget = 5;
+        bool thrown = false;
+        try{
+            target = gr;
+        }catch(const std::runtime_error&){
+            thrown = true;
+        }
+        thrower::budget = -1;
+        assert(thrown);
+        assert(target.size() == 0 && target.edge_count() == 0);
+        assert(target.begin() == target.end());
+        auto x = target.insert(thrower(1)), y = target.insert(thrower(2));
+        target.connect(x, y, 3);
+        assert(target.size() == 2 && target.edge_count() == 1);
+        target = gr;
+        assert(target.size() == gr.size() && target.edge_count() == gr.edge_count());
+    }
+    {
+        graph empty;
+        graph copy(empty), moved(std::move(copy));
+        assert(moved.size() == 0);
+    }
+    std::cout << "copy move test done\n";
+    return 0;
+};
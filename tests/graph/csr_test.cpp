@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "graph.hpp"
+
+int main(){
+    using graph = cxx_graph::graph<int>;
+    /*  0 - 1 - 3
+        |
+        2 - 4
+    */
+    graph gr;
+    auto it_0 = gr.insert(0);
+    auto it_1 = gr.add_adjacent(it_0, 1);
+    auto it_2 = gr.add_adjacent(it_0, 2);
+    gr.add_adjacent(it_1, 3);
+    auto it_4 = gr.add_adjacent(it_2, 4);
+    assert(gr.size() == 5);
+
+    auto csr = gr.to_csr();
+    assert(csr.node_count() == 5);
+    assert(csr.edge_count() == 8);
+    assert(csr.degree(0) == 2);
+    assert(csr.degree(4) == 1);
+    for(size_t v=0; v<csr.node_count(); v++){
+        assert(csr.value(v) == int(v));
+    }
+    assert(csr.is_adjacent(0, 1));
+    assert(csr.is_adjacent(4, 2));
+    assert(!csr.is_adjacent(0, 3));
+    std::vector<int> row(csr.neighbors(0).begin(), csr.neighbors(0).end());
+    assert(row == (std::vector<int>{1, 2}));
+
+    std::vector<int> order, depths;
+    csr.bfs(0, [&](auto v, auto depth){
+        order.emplace_back(v);
+        depths.emplace_back(depth);
+    });
+    assert(order == (std::vector<int>{0, 1, 2, 3, 4}));
+    assert(depths == (std::vector<int>{0, 1, 1, 2, 2}));
+    order.clear();
+    csr.dfs(0, [&](auto v){ order.emplace_back(v); });
+    assert(order == (std::vector<int>{0, 1, 3, 2, 4}));
+    order.clear();
+    csr.dfs(4, [&](auto v){ order.emplace_back(v); });
+    assert(order == (std::vector<int>{4, 2, 0, 1, 3}));
+
+    // node 4 takes place of erased node 1
+    gr.erase(it_1);
+    csr = gr.to_csr();
+    assert(csr.node_count() == 4);
+    assert(csr.edge_count() == 4);
+    assert(csr.value(1) == 4);
+    assert(csr.degree(3) == 0);
+    assert(csr.is_adjacent(0, 2));
+    assert(csr.is_adjacent(1, 2));
+    std::cout << "csr test done\n";
+    return 0;
+};
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+auto collect(graph::dfs_iterator it, const graph& gr){
+    std::vector<int> result;
+    while(it != gr.end()){
+        result.emplace_back(*it);
+        ++it;
+    }
+    return result;
+}
+
+int main(){
+    {
+        /*  0 - 1 - 3
+            |   |
+            2   5
+            |
+            4
+        */
+        graph gr;
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.add_adjacent(it_0, 1);
+        auto it_2 = gr.add_adjacent(it_0, 2);
+        gr.add_adjacent(it_1, 3);
+        gr.add_adjacent(it_2, 4);
+        gr.add_adjacent(it_1, 5);
+        using cxx_graph::dfs_order;
+        assert(collect(graph::dfs_iterator(it_0), gr) == (std::vector<int>{0, 1, 3, 5, 2, 4}));
+        assert(collect(graph::dfs_iterator(it_0, dfs_order::post), gr) == (std::vector<int>{3, 5, 1, 4, 2, 0}));
+        assert(collect(graph::dfs_iterator(it_2), gr) == (std::vector<int>{2, 0, 1, 3, 5, 4}));
+        assert(collect(graph::dfs_iterator(it_2, dfs_order::post), gr) == (std::vector<int>{3, 5, 1, 0, 4, 2}));
+
+        // copies share traversal, but have their own positions
+        auto it = graph::dfs_iterator(it_0);
+        ++it;
+        auto copy = it++;
+        assert(*copy == 1);
+        assert(*it == 3);
+        ++it;
+        ++copy;
+        assert(*copy == 3);
+        assert(*it == 5);
+        --it;
+        assert(*it == 3);
+        bool thrown = false;
+        try{
+            auto first = graph::dfs_iterator(it_0);
+            --first;
+        }catch(const std::out_of_range&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // long path doesn't overflow the call stack: DFS doesn't recurse
+        graph gr;
+        const int size = 200000;
+        auto tail = gr.insert(0);
+        auto first = tail;
+        for(int i=1; i<size; i++){
+            tail = gr.add_adjacent(tail, i);
+        }
+        int expected = 0;
+        for(auto it = graph::dfs_iterator(first); it != gr.end(); ++it){
+            assert(*it == expected++);
+        }
+        assert(expected == size);
+        expected = 0;
+        for(auto it = graph::dfs_iterator(first, cxx_graph::dfs_order::post); it != gr.end(); ++it){
+            assert(*it == size - 1 - expected++);
+        }
+        assert(expected == size);
+    }
+    std::cout << "dfs test done\n";
+    return 0;
+};
@@ -0,0 +1,314 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+#include "graph_file.hpp"
+
+using graph = cxx_graph::graph<int>;
+using cxx_graph::direction;
+using cxx_graph::graph_algo::index_type;
+
+template<class It>
+std::vector<int> values(const std::vector<It> &nodes){
+    std::vector<int> result;
+    for(auto &n:nodes){
+        result.emplace_back(*n);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int main(){
+    {
+        graph gr(direction::directed);
+        assert(gr.is_directed() && !graph().is_directed());
+        auto a = gr.insert(1), b = gr.insert(2), c = gr.insert(3);
+        auto ab = gr.connect(a, b);
+        gr.connect(a, c);
+        gr.connect(c, b);
+        auto cc = gr.connect(c, c);
+        assert(gr.edge_count() == 4);
+        assert(values(graph::get_adjacent(a)) == std::vector<int>({2, 3}));
+        assert(graph::get_adjacent(b).empty());
+        assert(values(graph::get_incoming(b)) == std::vector<int>({1, 3}));
+        assert(values(graph::get_incoming(c)) == std::vector<int>({1, 3}));
+        assert(graph::is_adjacent(a, b) && !graph::is_adjacent(b, a));
+        assert(graph::is_adjacent(c, c));
+
+        gr.disconnect(ab);
+        assert(!graph::is_adjacent(a, b));
+        assert(values(graph::get_incoming(b)) == std::vector<int>({3}));
+        gr.disconnect(cc);
+        assert(values(graph::get_adjacent(c)) == std::vector<int>({2}));
+        assert(values(graph::get_incoming(c)) == std::vector<int>({1}));
+
+        gr.connect(b, a);
+        gr.erase(c);
+        assert(gr.edge_count() == 1);
+        assert(values(graph::get_adjacent(a)).empty());
+        assert(values(graph::get_incoming(a)) == std::vector<int>({2}));
+
+        auto csr = gr.to_csr();
+        assert(csr.node_count() == 2 && csr.edge_count() == 1);
+    }
+    {
+        // random edits agree with a reference matrix in every adjacency mode
+        for(auto mode:{cxx_graph::adjacency_mode::unordered, cxx_graph::adjacency_mode::sorted,
+            cxx_graph::adjacency_mode::hashed})
+        {
+            const int n = 40;
+            graph gr(direction::directed);
+            gr.set_adjacency_mode(mode, 4);
+            std::vector<graph::default_it> nodes;
+            for(int i=0; i<n; i++){
+                nodes.emplace_back(gr.insert(i));
+            }
+            std::vector<std::vector<graph::edge_id>> ids(n * n);
+            std::mt19937 rng(7);
+            for(int step=0; step<3000; step++){
+                int u = rng() % n, v = rng() % n;
+                auto &list = ids[u * n + v];
+                if(rng() % 3 != 0 || list.empty()){
+                    list.emplace_back(gr.connect(nodes[u], nodes[v]));
+                }else{
+                    gr.disconnect(list.back());
+                    list.pop_back();
+                }
+            }
+            auto check = [&](const graph &g){
+                std::vector<int> out(n, 0), in(n, 0);
+                for(auto it=g.begin(); it!=g.end(); ++it){
+                    for(auto &s:graph::get_adjacent(it)){
+                        assert(!ids[*it * n + *s].empty());
+                        out[*it]++;
+                    }
+                    for(auto &p:graph::get_incoming(it)){
+                        assert(!ids[*p * n + *it].empty());
+                        in[*it]++;
+                    }
+                }
+                for(int u=0; u<n; u++){
+                    int expected_out = 0, expected_in = 0;
+                    for(int v=0; v<n; v++){
+                        expected_out += int(ids[u * n + v].size());
+                        expected_in += int(ids[v * n + u].size());
+                    }
+                    assert(out[u] == expected_out && in[u] == expected_in);
+                }
+            };
+            check(gr);
+            for(int u=0; u<n; u++){
+                for(int v=0; v<n; v++){
+                    assert(graph::is_adjacent(nodes[u], nodes[v]) == !ids[u * n + v].empty());
+                }
+            }
+            graph copy(gr);
+            assert(copy.is_directed());
+            check(copy);
+            gr.reorder(cxx_graph::reorder_policy::rcm);
+            check(gr);
+            auto csr = gr.to_csr();
+            size_t total = 0;
+            for(auto &list:ids){
+                total += list.size();
+            }
+            assert(gr.edge_count() == total && csr.edge_count() == total);
+        }
+    }
+    {
+        // layered DAG: edges only go from lower layer to higher one
+        const int layers = 20, width = 30;
+        graph gr(direction::directed);
+        std::vector<graph::default_it> nodes;
+        for(int i=0; i<layers * width; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        std::mt19937 rng(3);
+        for(int l=0; l+1<layers; l++){
+            for(int i=0; i<width; i++){
+                for(int k=0; k<3; k++){
+                    int to = (l + 1 + int(rng() % (layers - l - 1))) * width + int(rng() % width);
+                    gr.connect(nodes[l * width + i], nodes[to]);
+                }
+            }
+        }
+        auto csr = gr.to_csr();
+        const auto n = csr.node_count();
+        auto order = cxx_graph::graph_algo::topological_sort(csr);
+        assert(order.size() == n);
+        std::vector<size_t> position(n);
+        for(size_t i=0; i<n; i++){
+            position[order[i]] = i;
+        }
+        for(index_type v=0; v<n; v++){
+            for(auto o=csr.offsets()[v]; o<csr.offsets()[v+1]; o++){
+                assert(position[v] < position[csr.targets()[o]]);
+            }
+        }
+
+        // every task sees all of it's predecessors finished
+        cxx_graph::thread_pool pool(3);
+        cxx_graph::graph_algo::dag_executor executor(pool);
+        std::vector<index_type> finish(n, 0);
+        std::atomic<index_type> clock{0};
+        std::vector<std::vector<index_type>> predecessors(n);
+        for(index_type v=0; v<n; v++){
+            for(auto o=csr.offsets()[v]; o<csr.offsets()[v+1]; o++){
+                predecessors[csr.targets()[o]].emplace_back(v);
+            }
+        }
+        executor.run(csr, [&](index_type v){
+            for(auto p:predecessors[v]){
+                assert(finish[p] != 0);
+            }
+            finish[v] = ++clock;
+        });
+        assert(clock == n);
+        for(index_type v=0; v<n; v++){
+            for(auto p:predecessors[v]){
+                assert(finish[p] < finish[v]);
+            }
+        }
+
+        // exception of a task is rethrown, executor is usable after it
+        bool thrown = false;
+        try{
+            executor.run(csr, [&](index_type v){
+                if(v == order[n / 2]){
+                    throw std::runtime_error("task");
+                }
+            });
+        }catch(const std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+        std::atomic<size_t> ran{0};
+        executor.run(csr, [&](index_type){ ran++; });
+        assert(ran == n);
+
+        // cycle
+        gr.connect(nodes[(layers - 1) * width], nodes[0]);
+        gr.connect(nodes[0], nodes[(layers - 1) * width]);
+        auto cyclic = gr.to_csr();
+        thrown = false;
+        try{
+            cxx_graph::graph_algo::topological_sort(cyclic);
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        ran = 0;
+        try{
+            executor.run(cyclic, [&](index_type){ ran++; });
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        assert(thrown && ran < n);
+    }
+    {
+        // CSR of a directed graph: chain 0 -> 1 -> 2, algorithms follow edges
+        namespace algo = cxx_graph::graph_algo;
+        cxx_graph::graph<int, int> gr(direction::directed);
+        auto n0 = gr.insert(0);
+        auto n1 = gr.add_adjacent(n0, 1, 1);
+        gr.add_adjacent(n1, 2, 1);
+        auto csr = gr.to_csr();
+        assert(csr.is_directed() && csr.edge_count() == 2);
+        assert(csr.is_adjacent(0, 1) && !csr.is_adjacent(1, 0));
+        assert(csr.in_degree(0) == 0 && csr.in_degree(1) == 1 && *csr.in_neighbors(2).begin() == 1);
+        assert(csr.edge_value(csr.in_edge(csr.in_offsets()[2])) == 1);
+
+        cxx_graph::thread_pool pool(3);
+        auto forward = algo::parallel_bfs(csr, 0, pool);
+        assert((forward.m_distance == std::vector<index_type>{0, 1, 2}));
+        assert((forward.m_parent == std::vector<index_type>{0, 0, 1}));
+        auto backward = algo::parallel_bfs(csr, 2, pool);
+        assert(backward.m_distance[0] == cxx_graph::graph_algo::bfs_result::none);
+        assert((algo::shortest_path(csr, 0, 2) == algo::path{0, 1, 2}));
+        assert(algo::shortest_path(csr, 2, 0).empty());
+        auto sssp = algo::delta_stepping(csr, 1, 1, pool);
+        assert(sssp.m_distance[0] == algo::sssp_result<int>::unreachable() && sssp.m_distance[2] == 1);
+        assert(algo::dijkstra(csr, 1).m_distance == sssp.m_distance);
+        std::vector<int> x{1, 10, 100}, y;
+        algo::spmv(csr, x, y, pool);
+        assert((y == std::vector<int>{0, 1, 10}));
+        bool thrown = false;
+        try{
+            algo::triangle_count(csr, pool);
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        assert(thrown);
+
+        const std::string path = "directed_test.bin";
+        cxx_graph::save_graph(gr, path);
+        auto mapped = cxx_graph::load_mmap<decltype(gr)>(path);
+        assert(mapped.is_directed() && mapped.is_adjacent(0, 1) && !mapped.is_adjacent(1, 0));
+        assert(mapped.to_csr().is_directed() && mapped.to_csr().in_degree(2) == 1);
+        std::remove(path.c_str());
+    }
+    {
+        // random directed graph: bottom-up steps, path search and SSSP agree with sequential ones
+        namespace algo = cxx_graph::graph_algo;
+        const int n = 20000;
+        cxx_graph::graph<int, int> gr(direction::directed);
+        std::vector<cxx_graph::graph<int, int>::default_it> nodes;
+        for(int i=0; i<n; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        std::mt19937 rng(11);
+        for(int i=0; i<8*n; i++){
+            gr.connect(nodes[rng() % n], nodes[rng() % n], int(rng() % 50));
+        }
+        auto csr = gr.to_csr();
+        std::vector<index_type> depth(n, algo::bfs_result::none);
+        csr.bfs(0, [&](index_type v, size_t d){ depth[v] = index_type(d); });
+        cxx_graph::thread_pool pool(4);
+        auto result = algo::parallel_bfs(csr, 0, pool);
+        assert(result.m_distance == depth);
+        bool bottom_up = false;
+        for(const auto& level:result.m_levels){
+            bottom_up |= level.m_bottom_up;
+        }
+        assert(bottom_up);
+        for(index_type v=1; v<n; v++){
+            if(depth[v] != algo::bfs_result::none){
+                assert(csr.is_adjacent(result.m_parent[v], v));
+            }
+        }
+        for(index_type target=1; target<n; target+=997){
+            auto p = algo::shortest_path(csr, 0, target);
+            assert(p.empty() == (depth[target] == algo::bfs_result::none));
+            if(!p.empty()){
+                assert(p.size() == depth[target] + 1);
+                for(size_t i=0; i+1<p.size(); i++){
+                    assert(csr.is_adjacent(p[i], p[i+1]));
+                }
+            }
+        }
+        auto expected = algo::dijkstra(csr, 0);
+        auto sssp = algo::delta_stepping(csr, 0, 10, pool);
+        assert(sssp.m_distance == expected.m_distance);
+        for(index_type v=1; v<n; v++){
+            if(sssp.m_distance[v] == algo::sssp_result<int>::unreachable()){
+                continue;
+            }
+            auto u = sssp.m_parent[v];
+            bool found = false;
+            for(auto i=csr.offsets()[u]; i<csr.offsets()[u+1]; i++){
+                found |= csr.targets()[i] == v && sssp.m_distance[u] + csr.edge_value(i) == sssp.m_distance[v];
+            }
+            assert(found);
+        }
+    }
+    std::cout << "directed test done\n";
+    return 0;
+};
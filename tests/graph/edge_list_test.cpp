@@ -0,0 +1,190 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "edge_list.hpp"
+
+using graph = cxx_graph::graph<int>;
+namespace edge_list = cxx_graph::edge_list;
+
+// adjacency sets of a loaded graph, by node index
+std::vector<std::set<int>> adjacency(const graph &gr){
+    auto csr = gr.to_csr();
+    std::vector<std::set<int>> result(csr.node_count());
+    for(uint32_t v=0; v<csr.node_count(); v++){
+        for(auto u:csr.neighbors(v)){
+            result[v].insert(int(u));
+        }
+    }
+    return result;
+}
+
+template<class E = std::runtime_error, class F>
+bool throws(F &&f){
+    try{
+        f();
+    }catch(const E&){
+        return true;
+    }
+    return false;
+}
+
+// default value throws once the budget runs out
+struct thrower{
+    static inline int budget = -1;
+    thrower(){
+        if(budget == 0){
+            throw std::runtime_error("value");
+        }
+        budget--;
+    }
+};
+
+int main(){
+    const std::string text_path = "edge_list_test.txt", binary_path = "edge_list_test.bin";
+    const std::string graph_path = "edge_list_test.graph";
+    {
+        // comments, repeated and reversed edges, a loop, blank lines, extra columns
+        std::ofstream(text_path) << "# comment\n% another\n0 1\n1 0\n\n1\t2 0.5\n2 2\n  3 1\r\n0 1\n5 4";
+        auto gr = edge_list::load<graph>(text_path);
+        assert(gr.size() == 6);
+        assert(gr.edge_count() == 4);
+        auto adj = adjacency(gr);
+        assert(adj[0] == (std::set<int>{1}));
+        assert(adj[1] == (std::set<int>{0, 2, 3}));
+        assert(adj[2] == (std::set<int>{1}));
+        assert(adj[4] == (std::set<int>{5}));
+        // graph is a regular one afterwards
+        auto it = gr.begin();
+        gr.erase(it);
+        assert(gr.edge_count() == 3);
+        auto a = gr.insert(10), b = gr.insert(11);
+        gr.connect(a, b);
+        assert(graph::is_adjacent(a, b));
+
+        std::ifstream in(text_path);
+        auto from_stream = edge_list::load<graph>(in);
+        assert(adjacency(from_stream) == adjacency(edge_list::load<graph>(text_path)));
+
+        std::ofstream(text_path) << "0 1\n1 x\n";
+        assert(throws([&]{ edge_list::load<graph>(text_path); }));
+        std::ofstream(text_path) << "0 99999999999\n";
+        assert(throws([&]{ edge_list::load<graph>(text_path); }));
+        assert(throws([&]{ edge_list::load<graph>("no_such_edge_list.txt"); }));
+        std::ofstream(text_path) << "";
+        assert(edge_list::load<graph>(text_path).size() == 0);
+    }
+    {
+        // random list in all formats and through external conversion with a tiny budget
+        const int size = 5000;
+        std::mt19937 gen(8);
+        std::uniform_int_distribution<uint32_t> dist(0, size-1);
+        std::vector<uint32_t> pairs;
+        std::ostringstream text;
+        std::vector<std::set<int>> expected(size);
+        for(int i=0; i<60000; i++){
+            auto u = dist(gen), v = dist(gen);
+            pairs.emplace_back(u);
+            pairs.emplace_back(v);
+            text << u << ' ' << v << '\n';
+            if(u != v){
+                expected[u].insert(int(v));
+                expected[v].insert(int(u));
+            }
+        }
+        std::ofstream(text_path) << text.str();
+        std::ofstream(binary_path, std::ios::binary).write(reinterpret_cast<const char*>(pairs.data()),
+            std::streamsize(pairs.size() * sizeof(uint32_t)));
+        auto gr = edge_list::load<graph>(text_path);
+        assert(adjacency(gr) == expected);
+        assert(adjacency(edge_list::load<graph>(binary_path, edge_list::format::binary)) == expected);
+        std::istringstream in(text.str());
+        assert(adjacency(edge_list::load<graph>(in)) == expected);
+
+        edge_list::convert<int>(text_path, graph_path, edge_list::format::text, 1 << 16);
+        {
+            auto mapped = cxx_graph::load_mmap<graph>(graph_path);
+            assert(mapped.verify());
+            auto csr = gr.to_csr();
+            assert(mapped.node_count() == csr.node_count() && mapped.edge_count() == csr.edge_count());
+            for(uint32_t v=0; v<csr.node_count(); v++){
+                auto row = mapped.neighbors(v), expected_row = csr.neighbors(v);
+                assert(std::vector<uint32_t>(row.begin(), row.end())
+                    == std::vector<uint32_t>(expected_row.begin(), expected_row.end()));
+                assert(mapped.value(v) == 0);
+            }
+        }
+        edge_list::convert<int>(binary_path, graph_path, edge_list::format::binary, 1 << 16);
+        assert(cxx_graph::load_mmap<graph>(graph_path).to_csr().targets() == gr.to_csr().targets());
+
+        {
+            // more runs than one merge takes, they are merged in passes
+            std::vector<uint32_t> many;
+            std::uniform_int_distribution<uint32_t> wide(0, 50000);
+            for(int i=0; i<600000; i++){
+                many.emplace_back(wide(gen));
+            }
+            std::ofstream(binary_path, std::ios::binary).write(reinterpret_cast<const char*>(many.data()),
+                std::streamsize(many.size() * sizeof(uint32_t)));
+            edge_list::convert<int>(binary_path, graph_path, edge_list::format::binary, 1 << 16);
+            auto mapped = cxx_graph::load_mmap<graph>(graph_path);
+            assert(mapped.verify());
+            auto loaded = edge_list::load<graph>(binary_path, edge_list::format::binary).to_csr();
+            assert(mapped.to_csr().targets() == loaded.targets());
+            assert(mapped.to_csr().offsets() == loaded.offsets());
+            assert(!std::ifstream(graph_path + ".run0"));
+        }
+
+        // truncated binary file
+        std::ofstream(binary_path, std::ios::binary).write(reinterpret_cast<const char*>(pairs.data()),
+            std::streamsize(pairs.size() * sizeof(uint32_t) - 3));
+        assert(throws([&]{ edge_list::load<graph>(binary_path, edge_list::format::binary); }));
+        std::ifstream truncated(binary_path, std::ios::binary);
+        assert(throws([&]{ edge_list::load<graph>(truncated, edge_list::format::binary); }));
+
+        std::vector<edge_list::key_type> keys(100000), sorted;
+        std::uniform_int_distribution<edge_list::key_type> any;
+        for(auto& k:keys){
+            k = any(gen) >> (gen() % 64);
+        }
+        sorted = keys;
+        std::sort(sorted.begin(), sorted.end());
+        edge_list::radix_sort(keys);
+        assert(keys == sorted);
+    }
+    {
+        // from_edges checks keys before it allocates anything
+        auto key = [](std::uint64_t u, std::uint64_t v){ return (u << 32) | v; };
+        auto gr = graph::from_edges(3, {key(0, 1), key(1, 2)});
+        assert(gr.size() == 3 && gr.edge_count() == 2);
+        assert(throws<std::out_of_range>([&]{ graph::from_edges(2, {key(0, 5)}); }));
+        assert(throws<std::out_of_range>([&]{ graph::from_edges(2, {key(7, 1)}); }));
+        assert(throws<std::out_of_range>([&]{ graph::from_edges(0, {key(0, 1)}); }));
+        assert(throws<std::invalid_argument>([&]{ graph::from_edges(2, {key(0, 1), key(1, 1)}); }));
+        assert(graph::from_edges(0, {}).size() == 0);
+
+        // a throwing node value frees nodes built so far
+        using tgraph = cxx_graph::graph<thrower>;
+        std::vector<std::uint64_t> path;
+        for(std::uint64_t i=1; i<100; i++){
+            path.emplace_back(key(i-1, i));
+        }
+        thrower::budget = 50;
+        assert(throws([&]{ tgraph::from_edges(100, path); }));
+        thrower::budget = -1;
+        auto built = tgraph::from_edges(100, path);
+        assert(built.size() == 100 && built.edge_count() == 99);
+    }
+    std::remove(text_path.c_str());
+    std::remove(binary_path.c_str());
+    std::remove(graph_path.c_str());
+    std::cout << "edge list test done\n";
+    return 0;
+};
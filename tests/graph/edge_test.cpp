@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cassert>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+
+int main(){
+    {
+        graph gr;
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.insert(1);
+        auto it_2 = gr.insert(2);
+        assert(!graph::is_adjacent(it_0, it_1));
+        auto e_01 = gr.connect(it_0, it_1);
+        auto e_12 = gr.connect(it_1, it_2);
+        auto e_00 = gr.connect(it_0, it_0);
+        assert(gr.edge_count() == 3);
+        assert(graph::is_adjacent(it_0, it_1));
+        assert(graph::is_adjacent(it_1, it_0));
+        assert(graph::is_adjacent(it_0, it_0));
+        assert(!graph::is_adjacent(it_0, it_2));
+        assert(graph::get_adjacent(it_1).size() == 2);
+
+        gr.disconnect(e_01);
+        assert(gr.edge_count() == 2);
+        assert(!graph::is_adjacent(it_0, it_1));
+        assert(graph::is_adjacent(it_1, it_2));
+        bool thrown = false;
+        try{
+            gr.disconnect(e_01);
+        }catch(const std::out_of_range&){
+            thrown = true;
+        }
+        assert(thrown);
+
+        // freed id is reused
+        auto e_02 = gr.connect(it_0, it_2);
+        assert(e_02 == e_01);
+        gr.disconnect(e_00);
+        assert(!graph::is_adjacent(it_0, it_0));
+        assert(graph::is_adjacent(it_0, it_2));
+        gr.disconnect(e_12);
+        assert(gr.edge_count() == 1);
+        gr.erase(it_0);
+        assert(gr.edge_count() == 0);
+        assert(graph::get_adjacent(it_2).empty());
+    }
+    {
+        // erasing a hub is linear in it's degree
+        graph gr;
+        const int size = 200000;
+        auto hub = gr.insert(0);
+        for(int i=1; i<size; i++){
+            gr.add_adjacent(hub, i);
+        }
+        assert(gr.edge_count() == size-1);
+        auto leaf = graph::get_adjacent(hub)[size/2];
+        gr.erase(hub);
+        assert(gr.size() == size-1);
+        assert(gr.edge_count() == 0);
+        assert(graph::get_adjacent(leaf).empty());
+        // and leaves are still usable
+        auto leaf_two = graph::bfs_iterator(gr.begin());
+        gr.connect(leaf, leaf_two);
+        assert(graph::is_adjacent(leaf_two, leaf));
+    }
+    std::cout << "edge test done\n";
+    return 0;
+};
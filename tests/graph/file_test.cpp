@@ -0,0 +1,118 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "graph.hpp"
+#include "graph_file.hpp"
+
+template<class Graph, class Mapped>
+void check_same(const Graph &gr, const Mapped &mapped){
+    auto csr = gr.to_csr();
+    assert(mapped.node_count() == csr.node_count());
+    assert(mapped.edge_count() == csr.edge_count());
+    for(typename Mapped::index_type v=0; v<csr.node_count(); v++){
+        assert(mapped.value(v) == csr.value(v));
+        assert(mapped.degree(v) == csr.degree(v));
+        auto row = mapped.neighbors(v);
+        assert(std::equal(row.begin(), row.end(), csr.neighbors(v).begin()));
+    }
+}
+
+using graph_file_header = cxx_graph::graph_file::header;
+
+void corrupt(const std::string &path, long pos){
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(pos);
+    char c = 0;
+    file.read(&c, 1);
+    c ^= 0x5a;
+    file.seekp(pos);
+    file.write(&c, 1);
+}
+
+template<class Mapped>
+bool load_fails(const std::string &path){
+    try{
+        Mapped mapped(path);
+    }catch(const std::runtime_error&){
+        return true;
+    }
+    return false;
+}
+
+int main(){
+    const std::string path = "graph_file_test.bin";
+    {
+        using graph = cxx_graph::graph<int, double>;
+        graph gr;
+        auto it_0 = gr.insert(10);
+        auto it_1 = gr.add_adjacent(it_0, 11, 0.5);
+        auto it_2 = gr.add_adjacent(it_0, 12, 1.5);
+        gr.connect(it_1, it_2, 2.5);
+        auto tail = it_2;
+        for(int i=0; i<1000; i++){
+            tail = gr.add_adjacent(tail, 100+i, i*0.25);
+        }
+        cxx_graph::save_graph(gr, path);
+        auto mapped = cxx_graph::load_mmap<graph>(path);
+        assert(mapped.verify());
+        check_same(gr, mapped);
+        for(size_t i=0; i<mapped.edge_count(); i++){
+            assert(mapped.edge_value(i) == gr.to_csr().edge_value(i));
+        }
+        assert(mapped.is_adjacent(1, 2));
+        assert(!mapped.is_adjacent(1, 3));
+        auto copy = mapped.to_csr();
+        assert(copy.edge_values() == gr.to_csr().edge_values());
+
+        // moved view keeps the mapping
+        auto moved = std::move(mapped);
+        assert(moved.value(0) == 10);
+
+        // types have to match
+        assert((load_fails<cxx_graph::mapped_graph<int>>(path)));
+        assert((load_fails<cxx_graph::mapped_graph<double, double>>(path)));
+
+        // damaged section is found by verify, damaged header by load
+        corrupt(path, 1000);
+        assert(!cxx_graph::load_mmap<graph>(path).verify());
+        corrupt(path, 20);
+        assert((load_fails<cxx_graph::mapped_graph<int, double>>(path)));
+    }
+    {
+        using graph = cxx_graph::graph<long>;
+        graph gr;
+        cxx_graph::save_graph(gr, path);
+        auto empty = cxx_graph::load_mmap<graph>(path);
+        assert(empty.node_count() == 0);
+        assert(empty.verify());
+
+        auto hub = gr.insert(0);
+        for(long i=1; i<500; i++){
+            gr.add_adjacent(hub, i);
+        }
+        cxx_graph::save_graph(gr, path);
+        auto mapped = cxx_graph::load_mmap<graph>(path);
+        assert(mapped.verify());
+        check_same(gr, mapped);
+        // first and last offsets are checked by load
+        graph_file_header h;
+        std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(&h), sizeof(h));
+        const long offsets = long(h.m_sections[cxx_graph::graph_file::offsets_section].m_pos);
+        const long last = offsets + long(h.m_node_count * sizeof(cxx_graph::mapped_graph<long>::offset_type));
+        corrupt(path, last);
+        assert(load_fails<cxx_graph::mapped_graph<long>>(path));
+        corrupt(path, last);
+        assert(!load_fails<cxx_graph::mapped_graph<long>>(path));
+        corrupt(path, offsets);
+        assert(load_fails<cxx_graph::mapped_graph<long>>(path));
+        corrupt(path, offsets);
+        corrupt(path, 8);
+        assert(load_fails<cxx_graph::mapped_graph<long>>(path));
+    }
+    assert(load_fails<cxx_graph::mapped_graph<int>>("no_such_graph_file.bin"));
+    std::remove(path.c_str());
+    std::cout << "file test done\n";
+    return 0;
+};
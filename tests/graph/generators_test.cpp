@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "generators.hpp"
+#include "graph.hpp"
+
+namespace el = cxx_graph::edge_list;
+namespace gen = cxx_graph::generators;
+
+template<class F>
+bool throws(F &&f){
+    try{
+        f();
+    }catch(const std::invalid_argument&){
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Checks shape promised by generators, returns degrees
+ */
+std::vector<size_t> check(const el::edges &edges){
+    std::vector<size_t> degree(size_t(edges.m_node_count), 0);
+    for(size_t i=0; i<edges.m_keys.size(); i++){
+        auto k = edges.m_keys[i];
+        assert(el::key_first(k) < el::key_second(k));
+        assert(el::key_second(k) < edges.m_node_count);
+        assert(i == 0 || edges.m_keys[i-1] < k);
+        degree[el::key_first(k)]++;
+        degree[el::key_second(k)]++;
+    }
+    return degree;
+}
+
+int main(){
+    cxx_graph::thread_pool pool(3), single(1);
+    {
+        auto g = gen::grid(7, 5);
+        assert(g.m_node_count == 35);
+        assert(g.m_keys.size() == 2*35 - 7 - 5);
+        auto degree = check(g);
+        assert(degree[0] == 2 && degree[8] == 4 && degree[6] == 2 && degree[7] == 3);
+        assert(gen::grid(1, 1).m_keys.empty() && gen::grid(0, 4).m_keys.empty());
+        // 2^32 nodes would take id 0xffffffff, node count doesn't fit index_type
+        assert(throws([]{ gen::grid(65536, 65536); }));
+        assert(throws([&]{ gen::rmat(32, 1, pool); }));
+    }
+    {
+        const size_t m = 200000;
+        auto er = gen::erdos_renyi(10000, m, pool, 5);
+        check(er);
+        // repeats of 200k pairs out of 50M are rare
+        assert(er.m_keys.size() > m - 2000 && er.m_keys.size() <= m);
+        assert(gen::erdos_renyi(10000, m, single, 5).m_keys == er.m_keys);
+        assert(gen::erdos_renyi(10000, m, pool, 6).m_keys != er.m_keys);
+        assert(gen::erdos_renyi(1, 10, pool).m_keys.empty());
+    }
+    {
+        auto rmat = gen::rmat(14, 16 << 14, pool);
+        auto degree = check(rmat);
+        assert(rmat.m_node_count == 1 << 14);
+        assert(gen::rmat(14, 16 << 14, single).m_keys == rmat.m_keys);
+        // hubs get low ids
+        auto max = *std::max_element(degree.begin(), degree.end());
+        assert(degree[0] == max && max > 50 * rmat.m_keys.size() / rmat.m_node_count);
+
+        auto kron = gen::kronecker(14, 16, pool);
+        auto kron_degree = check(kron);
+        assert(kron.m_keys.size() == rmat.m_keys.size());
+        std::sort(degree.begin(), degree.end());
+        std::sort(kron_degree.begin(), kron_degree.end());
+        assert(degree == kron_degree);
+    }
+    {
+        auto pl = gen::power_law(20000, 100000, pool, 2.2);
+        auto degree = check(pl);
+        assert(gen::power_law(20000, 100000, single, 2.2).m_keys == pl.m_keys);
+        auto avg = 2 * pl.m_keys.size() / pl.m_node_count;
+        assert(degree[0] > 50 * avg && degree[0] > degree[100] && degree[100] > degree[10000]);
+    }
+    {
+        // generated lists build graphs
+        auto edges = gen::grid(30, 30);
+        std::vector<cxx_graph::graph<int>::default_it> nodes;
+        cxx_graph::graph<int> gr;
+        for(size_t i=0; i<edges.m_node_count; i++){
+            nodes.emplace_back(gr.insert(int(i)));
+        }
+        for(auto k:edges.m_keys){
+            gr.connect(nodes[el::key_first(k)], nodes[el::key_second(k)]);
+        }
+        assert(gr.size() == 900 && gr.edge_count() == edges.m_keys.size());
+        assert(gr.to_csr().edge_count() == 2 * edges.m_keys.size());
+    }
+    std::cout << "generators test done\n";
+    return 0;
+};
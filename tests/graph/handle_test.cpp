@@ -0,0 +1,128 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+using cxx_graph::node_handle;
+
+// copy throws when asked to
+struct thrower{
+    static inline bool fail = false;
+    int value = 0;
+    thrower(int v):value(v){}
+    thrower(const thrower &rhs):value(rhs.value){
+        if(fail){
+            throw std::runtime_error("copy");
+        }
+    }
+};
+
+int main(){
+    {
+        graph gr;
+        auto a = gr.insert(1), b = gr.insert(2), c = gr.insert(3);
+        gr.connect(a, b);
+        gr.connect(b, c);
+        auto ha = gr.handle(a), hb = gr.handle(b), hc = gr.handle(c);
+        assert(ha != hb && hb != hc);
+        assert(gr.contains(hb) && *gr.find(hb) == 2);
+        assert(!gr.contains(node_handle()));
+        assert(gr.find(node_handle()) == gr.end());
+
+        gr.erase(b);
+        assert(!gr.contains(hb));
+        assert(gr.find(hb) == gr.end());
+        assert(*gr.find(ha) == 1 && *gr.find(hc) == 3);
+        // freed slot is reused with a new generation, old handle stays stale
+        auto d = gr.insert(4);
+        auto hd = gr.handle(d);
+        assert(hd.m_index == hb.m_index && hd != hb);
+        assert(!gr.contains(hb) && *gr.find(hd) == 4);
+
+        graph copy(gr);
+        assert(*copy.find(ha) == 1 && *copy.find(hd) == 4 && !copy.contains(hb));
+        gr.clear();
+        assert(!gr.contains(ha) && !gr.contains(hd));
+        assert(*copy.find(hc) == 3);
+        auto e = gr.insert(5);
+        assert(gr.handle(e) != ha && gr.handle(e) != hc && gr.handle(e) != hd);
+    }
+    {
+        // random inserts and erases against a model, handles survive reorder and move
+        std::mt19937 gen(3);
+        graph gr;
+        std::vector<std::pair<node_handle, int>> live, dead;
+        for(int step=0; step<5000; step++){
+            if(live.empty() || gen() % 3){
+                auto it = gr.insert(step);
+                if(!live.empty()){
+                    auto other = gr.find(live[gen() % live.size()].first);
+                    gr.connect(it, other);
+                }
+                live.emplace_back(gr.handle(it), step);
+            }else{
+                auto pos = gen() % live.size();
+                auto it = gr.find(live[pos].first);
+                gr.erase(it);
+                dead.emplace_back(live[pos]);
+                live[pos] = live.back();
+                live.pop_back();
+            }
+            if(step % 1000 == 999){
+                gr.reorder(cxx_graph::reorder_policy::rcm);
+            }
+        }
+        graph moved(std::move(gr));
+        assert(moved.size() == live.size());
+        for(auto& h:live){
+            assert(*moved.find(h.first) == h.second);
+        }
+        for(auto& h:dead){
+            assert(!moved.contains(h.first));
+        }
+        size_t count = 0;
+        for(auto it = graph::bfs_iterator(moved.begin()); it != moved.end(); ++it){
+            count++;
+        }
+        assert(count <= moved.size());
+    }
+    {
+        // a throwing insert keeps graph, handles and free slots as they were
+        using tgraph = cxx_graph::graph<thrower>;
+        tgraph gr;
+        gr.enable_components();
+        const thrower value(7);
+        auto a = gr.insert(value), b = gr.insert(value);
+        gr.connect(a, b);
+        auto hb = gr.handle(b);
+        gr.erase(b);
+        for(int fresh=0; fresh<2; fresh++){
+            const auto size = gr.size(), components = gr.component_count();
+            thrower::fail = true;
+            bool thrown = false;
+            try{
+                gr.insert(value);
+            }catch(const std::runtime_error&){
+                thrown = true;
+            }
+            thrower::fail = false;
+            assert(thrown);
+            assert(gr.size() == size && gr.component_count() == components);
+            auto c = gr.insert(value);
+            // first round reuses the slot of b, second takes a new one
+            assert((gr.handle(c).m_index == hb.m_index) == (fresh == 0));
+            assert(gr.contains(gr.handle(c)) && gr.component_count() == components+1);
+            gr.erase(c);
+            if(fresh == 0){
+                // take the freed slot, so next insert needs a new one
+                gr.insert(value);
+            }
+        }
+        assert(gr.size() == 2);
+    }
+    std::cout << "handle test done\n";
+    return 0;
+};
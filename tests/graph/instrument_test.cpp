@@ -0,0 +1,64 @@
+#define CONT_INSTRUMENT 1
+#define CONT_INSTRUMENT_LATENCY 1
+#include <iostream>
+#include <cassert>
+#include <numeric>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int>;
+using cont::instrument::op_kind;
+
+int main(){
+    // star of 10 leaves, leaf 0 continues to a path of 20 nodes
+    graph gr;
+    auto center = gr.insert(-1);
+    std::vector<graph::default_it> leaves;
+    for(int i=0; i<10; i++){
+        leaves.emplace_back(gr.insert(i));
+        gr.connect(center, leaves.back());
+    }
+    auto tail = leaves[0];
+    for(int i=0; i<20; i++){
+        auto next = gr.insert(100 + i);
+        gr.connect(tail, next);
+        tail = next;
+    }
+
+    cont::instrument::reset();
+    size_t count = 0;
+    for(auto it = graph::bfs_iterator(center); it != gr.end(); ++it){
+        count++;
+    }
+    auto s = cont::instrument::snapshot()[op_kind::graph_bfs_next];
+    assert(count == 31 && s.calls == 31);
+    assert(s.queue_high_water == 10);
+    // every node is expanded once: itself and it's adjacency
+    assert(s.node_visits == 31 + 2 * gr.edge_count());
+    // shared state and growth of it's buffers
+    assert(s.allocations > 1 && s.allocations < 31);
+    assert(std::accumulate(s.latency.begin(), s.latency.end(), size_t(0)) == s.calls);
+
+    count = 0;
+    for(auto it = graph::dfs_iterator(leaves[9]); it != gr.end(); ++it){
+        count++;
+    }
+    s = cont::instrument::snapshot()[op_kind::graph_dfs_next];
+    assert(count == 31 && s.calls == 31);
+    // leaf 9, center, leaf 0 and the path
+    assert(s.queue_high_water == 23);
+    assert(s.node_visits == 2 * gr.edge_count());
+    assert(std::accumulate(s.latency.begin(), s.latency.end(), size_t(0)) == s.calls);
+
+    // copies share traversal state, so a second pass doesn't expand anything
+    auto it = graph::bfs_iterator(center);
+    ++it;
+    auto copy = it;
+    cont::instrument::reset();
+    ++copy;
+    ++it;
+    assert(cont::instrument::snapshot()[op_kind::graph_bfs_next].calls == 2);
+    assert(cont::instrument::snapshot()[op_kind::graph_bfs_next].allocations == 0);
+    std::cout << "instrument test done\n";
+    return 0;
+};
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+
+namespace algo = cxx_graph::graph_algo;
+
+// textbook power iteration on adjacency lists
+std::vector<double> reference(const std::vector<std::vector<int>> &adj, double damping, int iterations){
+    const auto n = adj.size();
+    std::vector<double> rank(n, 1.0/n);
+    for(int i=0; i<iterations; i++){
+        std::vector<double> next(n, (1-damping)/n);
+        for(size_t v=0; v<n; v++){
+            if(adj[v].empty()){
+                for(auto& r:next){
+                    r += damping * rank[v] / n;
+                }
+            }
+            for(auto u:adj[v]){
+                next[u] += damping * rank[v] / adj[v].size();
+            }
+        }
+        rank = next;
+    }
+    return rank;
+}
+
+int main(){
+    const int size = 3000;
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<int> dist(0, size-1);
+    cxx_graph::graph<int, double> gr;
+    std::vector<cxx_graph::graph<int, double>::bfs_iterator> nodes;
+    for(int i=0; i<size; i++){
+        nodes.emplace_back(gr.insert(i));
+    }
+    std::vector<std::vector<int>> adj(size);
+    for(int i=0; i<3*size; i++){
+        auto a = dist(gen), b = dist(gen);
+        if(a != b){
+            gr.connect(nodes[a], nodes[b], 0.5);
+            adj[a].emplace_back(b);
+            adj[b].emplace_back(a);
+        }
+    }
+    auto csr = gr.to_csr();
+    cxx_graph::thread_pool pool(3);
+    {
+        std::vector<double> x(size), y, weighted;
+        for(int i=0; i<size; i++){
+            x[i] = i % 7;
+        }
+        algo::spmv(csr, x, y, pool);
+        algo::spmv(csr, x, weighted, pool, [](double w){ return w; });
+        for(int v=0; v<size; v++){
+            double expected = 0;
+            for(auto u:adj[v]){
+                expected += x[u];
+            }
+            assert(std::abs(y[v] - expected) < 1e-9);
+            assert(std::abs(weighted[v] - expected/2) < 1e-9);
+        }
+    }
+    {
+        auto result = algo::pagerank(csr, pool, 0.85, 1e-10, 200);
+        assert(result.m_converged);
+        assert(!result.m_iterations.empty());
+        assert(result.m_iterations.back().m_error < 1e-10);
+        auto expected = reference(adj, 0.85, int(result.m_iterations.size()));
+        double sum = 0;
+        for(int v=0; v<size; v++){
+            sum += result.m_rank[v];
+            assert(std::abs(result.m_rank[v] - expected[v]) < 1e-9);
+        }
+        assert(std::abs(sum - 1) < 1e-9);
+        // scheduling doesn't change sums
+        assert(algo::pagerank(csr, 0.85, 1e-10, 200).m_rank == result.m_rank);
+        auto limited = algo::pagerank(csr, pool, 0.85, 0, 3);
+        assert(!limited.m_converged && limited.m_iterations.size() == 3);
+    }
+    {
+        // star: center takes the most, leaves are equal
+        cxx_graph::graph<int> star;
+        auto center = star.insert(0);
+        for(int i=1; i<10; i++){
+            star.add_adjacent(center, i);
+        }
+        auto result = algo::pagerank(star.to_csr(), pool);
+        assert(result.m_converged);
+        for(size_t v=1; v<10; v++){
+            assert(result.m_rank[0] > result.m_rank[v]);
+            assert(std::abs(result.m_rank[1] - result.m_rank[v]) < 1e-12);
+        }
+        assert(algo::pagerank(cxx_graph::graph<int>().to_csr(), pool).m_rank.empty());
+    }
+    {
+        // directed: rank and spmv values flow along edges only
+        using directed_graph = cxx_graph::graph<int, double>;
+        directed_graph dg(cxx_graph::direction::directed);
+        std::vector<directed_graph::bfs_iterator> dnodes;
+        for(int i=0; i<size; i++){
+            dnodes.emplace_back(dg.insert(i));
+        }
+        std::vector<std::vector<int>> out(size);
+        for(int i=0; i<2*size; i++){
+            auto a = dist(gen), b = dist(gen);
+            if(a != b){
+                dg.connect(dnodes[a], dnodes[b], 2.0);
+                out[a].emplace_back(b);
+            }
+        }
+        auto dcsr = dg.to_csr();
+        std::vector<double> x(size), y, weighted;
+        for(int i=0; i<size; i++){
+            x[i] = i % 5;
+        }
+        algo::spmv(dcsr, x, y, pool);
+        algo::spmv(dcsr, x, weighted, pool, [](double w){ return w; });
+        std::vector<double> expected_y(size, 0);
+        for(int u=0; u<size; u++){
+            for(auto v:out[u]){
+                expected_y[v] += x[u];
+            }
+        }
+        for(int v=0; v<size; v++){
+            assert(std::abs(y[v] - expected_y[v]) < 1e-9 && std::abs(weighted[v] - 2*expected_y[v]) < 1e-9);
+        }
+        auto result = algo::pagerank(dcsr, pool, 0.85, 1e-10, 200);
+        assert(result.m_converged);
+        auto expected = reference(out, 0.85, int(result.m_iterations.size()));
+        for(int v=0; v<size; v++){
+            assert(std::abs(result.m_rank[v] - expected[v]) < 1e-9);
+        }
+    }
+    std::cout << "pagerank test done\n";
+    return 0;
+};
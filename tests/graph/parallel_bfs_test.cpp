@@ -0,0 +1,112 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+
+using graph = cxx_graph::graph<int>;
+using cxx_graph::graph_algo::bfs_result;
+
+void check(const cxx_graph::csr_graph<int> &csr, bfs_result::index_type source, cxx_graph::thread_pool &pool){
+    auto result = cxx_graph::graph_algo::parallel_bfs(csr, source, pool);
+    std::vector<bfs_result::index_type> expected(csr.node_count(), bfs_result::none);
+    csr.bfs(source, [&](auto v, auto depth){
+        expected[v] = static_cast<bfs_result::index_type>(depth);
+    });
+    assert(result.m_distance == expected);
+    assert(result.m_parent[source] == source);
+    for(size_t v=0; v<csr.node_count(); v++){
+        auto p = result.m_parent[v];
+        if(expected[v] == bfs_result::none){
+            assert(p == bfs_result::none);
+        }else if(v != source){
+            assert(csr.is_adjacent(p, v));
+            assert(expected[p] + 1 == expected[v]);
+        }
+    }
+    size_t visited = 0;
+    for(const auto& level:result.m_levels){
+        visited += level.m_frontier;
+    }
+    assert(visited == csr.node_count() - std::count(expected.begin(), expected.end(), bfs_result::none));
+}
+
+int main(){
+    cxx_graph::thread_pool pool(4), inline_pool(1);
+    {
+        // random graph with a separate component
+        graph gr;
+        const size_t size = 50000;
+        std::vector<graph::bfs_iterator> nodes;
+        for(size_t i=0; i<size; i++){
+            nodes.emplace_back(gr.insert(int(i)));
+        }
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<size_t> dist(0, size-1001);
+        for(size_t i=0; i<size*8; i++){
+            gr.connect(nodes[dist(gen)], nodes[dist(gen)]);
+        }
+        for(size_t i=size-1000; i<size-1; i++){
+            gr.connect(nodes[i], nodes[i+1]);
+        }
+        auto csr = gr.to_csr();
+        check(csr, 0, pool);
+        check(csr, 0, inline_pool);
+        check(csr, size-1, pool);
+        auto result = cxx_graph::graph_algo::parallel_bfs(csr, 0, pool);
+        bool bottom_up = false;
+        for(const auto& level:result.m_levels){
+            bottom_up |= level.m_bottom_up;
+        }
+        assert(bottom_up);
+    }
+    {
+        // long path stays top-down
+        graph gr;
+        auto tail = gr.insert(0);
+        for(int i=1; i<10000; i++){
+            tail = gr.add_adjacent(tail, i);
+        }
+        auto csr = gr.to_csr();
+        check(csr, 5000, pool);
+        auto result = cxx_graph::graph_algo::parallel_bfs(csr, 0);
+        assert(result.m_levels.size() == 10000);
+        assert(!result.m_levels.back().m_bottom_up);
+        bool thrown = false;
+        try{
+            cxx_graph::graph_algo::parallel_bfs(csr, 10000, pool);
+        }catch(const std::out_of_range&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // a throwing job is rethrown from run once every worker is done, pool stays usable
+        for(size_t thrower=0; thrower<pool.size(); thrower++){
+            std::atomic<size_t> calls(0);
+            bool thrown = false;
+            try{
+                pool.run([&](size_t worker){
+                    if(worker == thrower){
+                        throw std::runtime_error("job");
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    calls++;
+                });
+            }catch(const std::runtime_error&){
+                thrown = true;
+            }
+            assert(thrown && calls == pool.size()-1);
+        }
+        std::atomic<size_t> calls(0);
+        pool.run([&](size_t){ calls++; });
+        assert(calls == pool.size());
+    }
+    std::cout << "parallel bfs test done\n";
+    return 0;
+};
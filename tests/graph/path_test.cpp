@@ -0,0 +1,93 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+
+using graph = cxx_graph::graph<int>;
+using csr = cxx_graph::csr_graph<int>;
+namespace algo = cxx_graph::graph_algo;
+
+// path goes from source to target over edges of a graph
+bool valid(const csr &gr, const algo::path &p, algo::index_type source, algo::index_type target){
+    if(p.empty() || p.front() != source || p.back() != target){
+        return false;
+    }
+    for(size_t i=1; i<p.size(); i++){
+        if(!gr.is_adjacent(p[i-1], p[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(){
+    {
+        // two components: path 0-1-2-3-4 with a shortcut 1-3, and 5-6
+        graph gr;
+        std::vector<graph::bfs_iterator> nodes;
+        for(int i=0; i<7; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        for(int i=0; i<4; i++){
+            gr.connect(nodes[i], nodes[i+1]);
+        }
+        gr.connect(nodes[1], nodes[3]);
+        gr.connect(nodes[5], nodes[6]);
+        auto c = gr.to_csr();
+        algo::path_searcher<int, cxx_graph::no_payload> searcher(c);
+        assert(searcher.shortest_path(0, 4) == (algo::path{0, 1, 3, 4}));
+        assert(searcher.shortest_path(4, 0) == (algo::path{4, 3, 1, 0}));
+        assert(searcher.shortest_path(2, 2) == (algo::path{2}));
+        assert(searcher.shortest_path(0, 6).empty());
+        assert(searcher.shortest_path(6, 5) == (algo::path{6, 5}));
+        // visited marks of previous queries don't leak into next ones
+        assert(searcher.shortest_path(0, 4).size() == 4);
+        bool thrown = false;
+        try{
+            searcher.shortest_path(0, 7);
+        }catch(const std::out_of_range&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // random sparse graph, lengths match full BFS
+        const int size = 2000;
+        std::mt19937 gen(9);
+        std::uniform_int_distribution<int> dist(0, size-1);
+        graph gr;
+        std::vector<graph::bfs_iterator> nodes;
+        for(int i=0; i<size; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        for(int i=0; i<size; i++){
+            gr.connect(nodes[dist(gen)], nodes[dist(gen)]);
+        }
+        auto c = gr.to_csr();
+        std::vector<std::pair<algo::index_type, algo::index_type>> queries;
+        for(int i=0; i<300; i++){
+            queries.emplace_back(dist(gen), dist(gen));
+        }
+        cxx_graph::thread_pool pool(3);
+        auto paths = algo::shortest_paths(c, queries, pool);
+        algo::path_searcher<int, cxx_graph::no_payload> searcher(c);
+        for(size_t i=0; i<queries.size(); i++){
+            auto source = queries[i].first, target = queries[i].second;
+            auto expected = algo::parallel_bfs(c, source, pool).m_distance[target];
+            if(expected == algo::bfs_result::none){
+                assert(paths[i].empty());
+            }else{
+                assert(valid(c, paths[i], source, target));
+                assert(paths[i].size() == expected+1);
+            }
+            assert(searcher.shortest_path(source, target).size() == paths[i].size());
+        }
+        assert(algo::shortest_path(c, queries[0].first, queries[0].second) == paths[0]);
+    }
+    std::cout << "path test done\n";
+    return 0;
+};
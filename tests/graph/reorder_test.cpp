@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+using graph = cxx_graph::graph<int, int>;
+using edge_set = std::set<std::pair<int, int>>;
+
+// edges as pairs of node values, independent of node order
+edge_set edges_of(const graph &gr){
+    edge_set result;
+    auto csr = gr.to_csr();
+    for(size_t v=0; v<csr.node_count(); v++){
+        for(auto u:csr.neighbors(v)){
+            result.emplace(csr.value(v), csr.value(u));
+        }
+    }
+    return result;
+}
+
+// max distance between indices of neighbours
+size_t bandwidth(const graph &gr){
+    auto csr = gr.to_csr();
+    size_t result = 0;
+    for(size_t v=0; v<csr.node_count(); v++){
+        for(auto u:csr.neighbors(v)){
+            result = std::max(result, v > u? v - u : u - v);
+        }
+    }
+    return result;
+}
+
+int main(){
+    // grid with shuffled insertion order
+    const int side = 40;
+    std::vector<int> cells(side*side);
+    for(int i=0; i<side*side; i++){
+        cells[i] = i;
+    }
+    std::shuffle(cells.begin(), cells.end(), std::mt19937(5));
+    for(auto policy:{cxx_graph::reorder_policy::rcm, cxx_graph::reorder_policy::degree,
+        cxx_graph::reorder_policy::bfs})
+    {
+        graph gr;
+        std::vector<graph::bfs_iterator> nodes(side*side, graph::bfs_iterator(nullptr));
+        for(auto cell:cells){
+            nodes[cell] = gr.insert(cell);
+        }
+        std::vector<std::pair<graph::edge_id, int>> ids;
+        for(int y=0; y<side; y++){
+            for(int x=0; x<side; x++){
+                if(x+1 < side){
+                    ids.emplace_back(gr.connect(nodes[y*side+x], nodes[y*side+x+1], y*side+x), y*side+x);
+                }
+                if(y+1 < side){
+                    ids.emplace_back(gr.connect(nodes[y*side+x], nodes[(y+1)*side+x], -(y*side+x)), -(y*side+x));
+                }
+            }
+        }
+        gr.enable_components();
+        auto edges = edges_of(gr);
+        auto before = gr.to_csr();
+        auto old_bandwidth = bandwidth(gr);
+
+        auto permutation = gr.reorder(policy);
+        assert(permutation.size() == gr.size());
+        auto after = gr.to_csr();
+        for(size_t v=0; v<permutation.size(); v++){
+            assert(after.value(permutation[v]) == before.value(v));
+        }
+        assert(edges_of(gr) == edges);
+        assert(gr.edge_count() == ids.size());
+        // edge ids survive
+        for(const auto& id:ids){
+            assert(gr.edge_value(id.first) == id.second);
+        }
+        assert(gr.component_count() == 1);
+        if(policy == cxx_graph::reorder_policy::rcm){
+            assert(bandwidth(gr) <= size_t(side)*2);
+            assert(bandwidth(gr) < old_bandwidth);
+        }else if(policy == cxx_graph::reorder_policy::degree){
+            for(size_t v=1; v<after.node_count(); v++){
+                assert(after.degree(v-1) >= after.degree(v));
+            }
+        }else{
+            size_t depth_prev = 0;
+            after.bfs(0, [&](size_t v, size_t depth){
+                assert(depth >= depth_prev);
+                depth_prev = depth;
+                (void)v;
+            });
+        }
+
+        // graph stays usable: erase relocated nodes, add new ones, reorder again
+        for(auto it = gr.begin(); gr.size() > side*side/2; it = gr.begin()){
+            gr.erase(it);
+        }
+        auto extra = gr.insert(-1);
+        auto first = gr.begin();
+        gr.connect(extra, first);
+        gr.reorder(policy);
+        assert(gr.size() == side*side/2 + 1);
+        gr.reorder(cxx_graph::reorder_policy::bfs);
+        size_t reached = 0;
+        for(auto it = graph::bfs_iterator(gr.begin()); it != gr.end(); ++it){
+            reached++;
+        }
+        assert(reached >= 1);
+    }
+    {
+        graph gr;
+        assert(gr.reorder(cxx_graph::reorder_policy::rcm).empty());
+    }
+    std::cout << "reorder test done\n";
+    return 0;
+};
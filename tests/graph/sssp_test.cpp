@@ -0,0 +1,157 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+#include "graph.hpp"
+#include "graph_algo.hpp"
+
+namespace algo = cxx_graph::graph_algo;
+
+struct road{
+    int m_length = 0;
+    bool m_toll = false;
+};
+
+template<class Csr, class Result, class WeightF>
+void check_parents(const Csr &csr, algo::index_type source, const Result &result, WeightF weight){
+    assert(result.m_parent[source] == source);
+    for(algo::index_type v=0; v<csr.node_count(); v++){
+        if(v == source){
+            continue;
+        }
+        auto p = result.m_parent[v];
+        if(result.m_distance[v] == Result::unreachable()){
+            assert(p == Result::none);
+            continue;
+        }
+        bool found = false;
+        for(auto i=csr.offsets()[v]; i<csr.offsets()[v+1]; i++){
+            if(csr.targets()[i] == p && result.m_distance[p] + weight(csr.edge_value(i)) == result.m_distance[v]){
+                found = true;
+            }
+        }
+        assert(found);
+        // parents form a tree rooted at source
+        size_t steps = 0;
+        for(auto u=v; u!=source; u=result.m_parent[u]){
+            assert(++steps < csr.node_count());
+        }
+    }
+}
+
+int main(){
+    cxx_graph::thread_pool pool(4);
+    {
+        /*  0 -5- 1 -1- 3
+            |2    |1
+            2 -1- 4     5
+        */
+        using graph = cxx_graph::graph<int, double>;
+        graph gr;
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.add_adjacent(it_0, 1, 5.0);
+        auto it_2 = gr.add_adjacent(it_0, 2, 2.0);
+        gr.add_adjacent(it_1, 3, 1.0);
+        auto it_4 = gr.add_adjacent(it_2, 4, 1.0);
+        auto e_14 = gr.connect(it_1, it_4, 1.0);
+        gr.insert(5);
+        assert(gr.edge_value(e_14) == 1.0);
+        gr.edge_value(e_14) = 0.5;
+
+        auto csr = gr.to_csr();
+        assert(csr.edge_values().size() == csr.edge_count());
+        auto result = algo::dijkstra(csr, 0);
+        assert((result.m_distance == std::vector<double>{0, 3.5, 2, 4.5, 3, algo::sssp_result<double>::unreachable()}));
+        assert(result.m_parent[1] == 4);
+        assert(result.m_parent[4] == 2);
+        assert(result.m_parent[5] == algo::sssp_result<double>::none);
+        check_parents(csr, 0, result, algo::payload_weight());
+        auto parallel = algo::delta_stepping(csr, 0, 1.0, pool);
+        assert(parallel.m_distance == result.m_distance);
+        assert(parallel.m_parent == result.m_parent);
+
+        gr.edge_value(e_14) = -1;
+        bool thrown = false;
+        try{
+            algo::dijkstra(gr.to_csr(), 0);
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try{
+            algo::delta_stepping(gr.to_csr(), 0, 1.0, pool);
+        }catch(const std::invalid_argument&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // random graph, payload with a weight functor
+        using graph = cxx_graph::graph<int, road>;
+        graph gr;
+        const size_t size = 20000;
+        std::vector<graph::bfs_iterator> nodes;
+        for(size_t i=0; i<size; i++){
+            nodes.emplace_back(gr.insert(int(i)));
+        }
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<size_t> node_dist(0, size-1);
+        std::uniform_int_distribution<int> length_dist(0, 100);
+        for(size_t i=0; i<size*4; i++){
+            gr.connect(nodes[node_dist(gen)], nodes[node_dist(gen)], road{length_dist(gen), i%3 == 0});
+        }
+        auto csr = gr.to_csr();
+        auto weight = [](const road &r){ return r.m_length + (r.m_toll? 50 : 0); };
+        auto expected = algo::dijkstra(csr, 0, weight);
+        check_parents(csr, 0, expected, weight);
+        for(int delta:{1, 10, 1000}){
+            auto result = algo::delta_stepping(csr, 0, delta, pool, weight);
+            assert(result.m_distance == expected.m_distance);
+            check_parents(csr, 0, result, weight);
+        }
+        cxx_graph::thread_pool inline_pool(1);
+        assert(algo::delta_stepping(csr, 0, 10, inline_pool, weight).m_distance == expected.m_distance);
+        // weights past the bucket ring go through overflow lists
+        auto heavy = [&weight](const road &r){ return weight(r) * 100; };
+        auto heavy_expected = algo::dijkstra(csr, 0, heavy);
+        auto heavy_result = algo::delta_stepping(csr, 0, 1, pool, heavy);
+        assert(heavy_result.m_distance == heavy_expected.m_distance);
+        check_parents(csr, 0, heavy_result, heavy);
+    }
+    {
+        // unweighted graph counts hops
+        using graph = cxx_graph::graph<int>;
+        graph gr;
+        auto tail = gr.insert(0);
+        for(int i=1; i<100; i++){
+            tail = gr.add_adjacent(tail, i);
+        }
+        auto csr = gr.to_csr();
+        auto hops = [](cxx_graph::no_payload){ return 1; };
+        auto result = algo::dijkstra(csr, 0, hops);
+        assert(result.m_distance[99] == 99);
+        assert(algo::delta_stepping(csr, 0, 4, pool, hops).m_distance == result.m_distance);
+    }
+    {
+        // zero weight edges don't make parents point at each other
+        using graph = cxx_graph::graph<int, int>;
+        graph gr;
+        auto it_0 = gr.insert(0);
+        auto it_1 = gr.insert(1);
+        auto it_2 = gr.insert(2);
+        auto it_3 = gr.insert(3);
+        gr.connect(it_0, it_3, 1);
+        gr.connect(it_3, it_2, 1);
+        gr.connect(it_2, it_1, 0);
+        auto csr = gr.to_csr();
+        for(int delta:{1, 2, 10}){
+            auto result = algo::delta_stepping(csr, 0, delta, pool);
+            assert((result.m_distance == std::vector<int>{0, 2, 2, 1}));
+            assert(result.m_parent[2] == 3 && result.m_parent[1] == 2);
+            check_parents(csr, 0, result, algo::payload_weight());
+        }
+    }
+    std::cout << "sssp test done\n";
+    return 0;
+};
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "graph.hpp"
+
+using alloc = cont::counting_allocator<double>;
+using graph = cxx_graph::graph<double, cxx_graph::no_payload, alloc>;
+
+int main(){
+    {
+        cxx_graph::graph<int> gr;
+        auto a = gr.insert(1), b = gr.insert(2);
+        gr.connect(a, b);
+        auto s = gr.stats();
+        assert(s.elements == 2 && s.live_nodes == 2 && !s.counted && s.value_bytes == 2 * sizeof(int));
+        assert(s.node_bytes > 0);
+    }
+    cont::alloc_counters counters;
+    for(auto dir:{cxx_graph::direction::undirected, cxx_graph::direction::directed}){
+        graph gr(dir, alloc(counters));
+        std::vector<graph::default_it> nodes;
+        for(int i=0; i<200; i++){
+            nodes.emplace_back(gr.insert(i));
+        }
+        for(int i=0; i<200; i++){
+            gr.connect(nodes[i], nodes[(i+1) % 200]);
+            gr.connect(nodes[i], nodes[(i*7) % 200]);
+        }
+        auto s = gr.stats();
+        assert(s.elements == 200 && s.live_nodes == 200 && s.counted);
+        assert(s.value_bytes == 200 * sizeof(double));
+        // adjacency arrays have spare capacity, the rest is counted exactly
+        assert(s.node_bytes + s.value_bytes <= s.allocated_bytes);
+        assert(s.peak_bytes >= s.allocated_bytes && s.allocations > s.deallocations);
+
+        graph copy(gr);
+        assert(copy.stats().node_bytes + copy.stats().value_bytes <= counters.live_bytes - s.allocated_bytes);
+        gr.erase(nodes[0]);
+        // node place stays in the pool, it's edges are gone
+        assert(gr.stats().elements == 199 && gr.stats().node_bytes < s.node_bytes);
+    }
+    assert(counters.live_bytes == 0 && counters.allocations == counters.deallocations);
+    std::cout << "stats test done\n";
+    return 0;
+};
@@ -0,0 +1,93 @@
+#include "k_tree.hpp"
+#include "test_allocator.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+using alloc_ = arena_allocator<int>;
+using tree_ = cont::tree<int, alloc_>;
+
+/**
+ * 0
+ * |
+ * 1-2-5-7
+ *   |
+ * 6-3-4
+ */
+void fill(tree_& t) {
+    auto it0 = t.set_root<tree_::df_iterator>(0);
+    t.append_child(it0, 1);
+    auto it2 = t.append_child(it0, 2);
+    auto it3 = t.append_child(it2, 3);
+    t.append_child(it2, 4);
+    auto it5 = t.append_child(it0, 5);
+    t.insert_left(it3, 6);
+    t.insert_right(it5, 7);
+}
+
+int main() {
+    {
+        const auto news = global_news;
+        tree_ t(alloc_(1));
+        fill(t);
+        assert(t.size() == 8 && arena_live[1] > 0);
+
+        tree_ copy(t, alloc_(2));
+        assert(copy == t && copy.get_allocator() == alloc_(2));
+        // unequal allocators move values one by one
+        tree_ moved(std::move(copy), alloc_(1));
+        assert(moved == t && copy.empty());
+        tree_ foreign(alloc_(3));
+        foreign = std::move(moved);
+        assert(foreign == t && foreign.get_allocator() == alloc_(3));
+        // equal allocators take over nodes
+        tree_ same(alloc_(3));
+        same = std::move(foreign);
+        assert(same == t);
+        assert(global_news == news);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0 && arena_live[3] == 0);
+    {
+        // moved from trees take values again, through any kind of assignment
+        tree_ a(alloc_(1), 1);
+        tree_ b(std::move(a));
+        a = tree_(alloc_(2), 5);
+        assert(a.size() == 1 && *a.begin() == 5);
+        tree_ c(std::move(a));
+        a = b;
+        assert(a == b && a.size() == 1);
+        tree_ d(std::move(b));
+        b = tree_(alloc_(1), 7);
+        assert(*b.begin() == 7);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0);
+    {
+        // move-only values
+        using ptr_tree = cont::tree<std::unique_ptr<int>, arena_allocator<std::unique_ptr<int>>>;
+        ptr_tree t(arena_allocator<std::unique_ptr<int>>(1), new int(5));
+        auto root = t.begin();
+        t.append_child(root, new int(6));
+        ptr_tree other(arena_allocator<std::unique_ptr<int>>(2));
+        other = std::move(t);
+        assert(**other.begin() == 5 && other.size() == 2);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0);
+#if CONT_HAS_PMR
+    {
+        // every byte comes from a buffer, upstream refuses to allocate
+        static char buffer[1 << 14];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        const auto news = global_news;
+        cont::pmr::tree<int> t(&arena);
+        auto root = t.set_root<cont::pmr::tree<int>::df_iterator>(0);
+        for (int i = 1; i < 50; ++i) {
+            t.append_child(root, i);
+        }
+        cont::pmr::tree<int> copy(t, &arena);
+        assert(copy == t && copy.size() == 50);
+        assert(global_news == news);
+    }
+#endif
+    std::cout << "allocator test done\n";
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include "test_struct.hpp"
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 using tree_ = cont::tree<test_struct>;
 auto print_it(const tree_& t, const tree_::iterator_base& it) {
@@ -15,6 +16,14 @@ auto print_it(const tree_& t, const tree_::iterator_base& it) {
     std::cout << std::endl;
 }
 
+auto bf_values(const tree_& t) {
+    std::vector<int> result;
+    for (tree_::bf_iterator it = t.begin(); it != t.end(); ++it) {
+        result.emplace_back((*it).value());
+    }
+    return result;
+}
+
 int main() {
     /* 0
        |
@@ -49,4 +58,46 @@ int main() {
     assert(copy == tree);
     auto rvalue = std::move(copy);
     assert(rvalue == tree);
+    // self assignment keeps the nodes
+    auto& self = rvalue;
+    rvalue = self;
+    assert(rvalue == tree);
+    rvalue = std::move(self);
+    assert(rvalue == tree);
+
+    {
+        // root only
+        tree_ single(std::allocator<test_struct>(), 0);
+        tree_ copy = single;
+        tree_ extended(single, std::allocator<test_struct>());
+        assert(copy == single && extended == single);
+        assert(bf_values(copy) == std::vector<int>{0});
+    }
+    {
+        /* last children have children of their own
+           0
+           |
+           1-2
+             |
+             3
+             |
+             4-5
+        */
+        tree_ deep;
+        auto it0 = deep.set_root<tree_::bf_iterator>(0);
+        deep.append_child(it0, 1);
+        auto it2 = deep.append_child(it0, 2);
+        auto it3 = deep.append_child(it2, 3);
+        deep.append_child(it3, 4);
+        deep.append_child(it3, 5);
+        tree_ copy = deep;
+        assert(copy == deep);
+        assert(bf_values(copy) == (std::vector<int>{0, 1, 2, 3, 4, 5}));
+        // links are usable: grow the copy under it's last leaf
+        tree_::bf_iterator last = copy.begin();
+        std::advance(last, 5);
+        copy.append_child(last, 6);
+        assert(bf_values(copy) == (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+        assert(bf_values(deep).size() == 6);
+    }
 }
@@ -0,0 +1,62 @@
+#define CONT_INSTRUMENT 1
+#include "k_tree.hpp"
+#include <cassert>
+#include <iostream>
+
+using tree_ = cont::tree<int>;
+using cont::instrument::op_kind;
+
+/**
+ * 0
+ * |
+ * 1-5
+ * |
+ * 2
+ * |
+ * 3
+ * |
+ * 4
+ */
+int main() {
+    static_assert(cont::instrument::enabled, "instrumentation is compiled in");
+    tree_ t;
+    auto it0 = t.set_root<tree_::df_iterator>(0);
+    auto it = t.append_child(it0, 1);
+    t.append_child(it0, 5);
+    for (int i = 2; i < 5; i++) {
+        it = t.append_child(it, i);
+    }
+
+    cont::instrument::reset();
+    int count = 0;
+    for (auto df = t.begin(); df != t.end(); df++) {
+        count++;
+    }
+    auto s = cont::instrument::snapshot()[op_kind::tree_df_next];
+    assert(count == 6 && s.calls == 6);
+    // 4 climbs up to 1 to reach 5, 5 climbs to 0 to reach the foot
+    assert(s.parent_climbs == 4);
+    // a hop per climb and one to the next node
+    assert(s.node_visits == s.calls + s.parent_climbs);
+
+    auto last = t.begin();
+    for (int i = 0; i < 5; i++) {
+        ++last;
+    }
+    --last; // 5 -> 4, down the child chain of 1
+    s = cont::instrument::snapshot()[op_kind::tree_df_prev];
+    assert(*last == 4 && s.calls == 1 && s.node_visits == 4 && s.parent_climbs == 0);
+
+    count = 0;
+    for (auto bf = t.begin<tree_::bf_iterator>(); bf != t.end<tree_::bf_iterator>(); ++bf) {
+        count++;
+    }
+    s = cont::instrument::snapshot()[op_kind::tree_bf_next];
+    assert(count == 6 && s.calls == 6 && s.queue_high_water == 2);
+    assert(s.visits_per_call() > 1);
+
+    cont::instrument::reset();
+    assert(cont::instrument::snapshot()[op_kind::tree_df_next].calls == 0);
+    std::cout << "instrument test done\n";
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "k_tree.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using alloc_ = cont::counting_allocator<std::string>;
+using tree_ = cont::tree<std::string, alloc_>;
+
+int main() {
+    {
+        // without counting allocator only node and value figures are there
+        cont::tree<int> t;
+        auto root = t.set_root<cont::tree<int>::df_iterator>(0);
+        t.append_child(root, 1);
+        auto s = t.stats();
+        assert(s.elements == 2 && s.live_nodes == 3 && !s.counted);
+        assert(s.value_bytes == 2 * sizeof(int) && s.node_bytes > 0);
+        assert(s.bytes_per_element() == double(s.node_bytes + s.value_bytes) / 2);
+    }
+    cont::alloc_counters counters;
+    {
+        tree_ t(alloc_(counters), "root");
+        auto root = t.begin();
+        for (int i = 0; i < 10; i++) {
+            auto child = t.append_child(root, std::to_string(i));
+            if (i < 9) {
+                t.append_child(child, "leaf");
+            }
+        }
+        auto s = t.stats();
+        assert(s.elements == 20 && s.live_nodes == 21 && s.counted);
+        assert(s.value_bytes == 20 * sizeof(std::string));
+        // nodes and values are all that tree allocates
+        assert(s.allocated_bytes == s.node_bytes + s.value_bytes);
+        assert(s.allocations - s.deallocations == s.live_nodes + s.elements);
+
+        tree_ copy(t);
+        assert(copy == t && copy.stats().elements == 20);
+        assert(counters.live_bytes == 2 * s.allocated_bytes);
+        const auto peak = counters.peak_bytes.load();
+        t.erase(++t.begin());
+        s = t.stats();
+        assert(s.elements == 18 && s.live_nodes == 19 && s.peak_bytes == peak);
+
+        tree_ moved(std::move(t));
+        assert(moved.stats().elements == 18 && t.stats().elements == 0 && t.stats().live_nodes == 0);
+        moved.clear();
+        assert(moved.stats().elements == 0 && moved.stats().bytes_per_element() == 0);
+    }
+    assert(counters.live_bytes == 0 && counters.allocations == counters.deallocations);
+    std::cout << "stats test done\n";
+    return 0;
+}
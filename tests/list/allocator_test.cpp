@@ -0,0 +1,101 @@
+#include "index_list.hpp"
+#include "list.hpp"
+#include "test_allocator.hpp"
+#include <cassert>
+#include <iostream>
+
+using alloc_ = arena_allocator<int>;
+using list_ = cont::list<int, alloc_>;
+using index_list_ = cont::index_list<int, alloc_>;
+
+int main() {
+    {
+        const auto news = global_news;
+        list_ l(alloc_(1));
+        for (int i = 0; i < 1000; ++i) {
+            l.insert_before(l.end(), i);
+        }
+        l.enable_index();
+        l.insert_at(500, -1);
+        l.erase_at(10);
+        assert(arena_live[1] > 1000 * sizeof(int));
+
+        // copy into another arena, then move back: unequal allocators move values one by one
+        list_ copy(l, alloc_(2));
+        assert(copy == l && copy.indexed());
+        assert(copy.get_allocator() == alloc_(2) && arena_live[2] > 0);
+        list_ moved(std::move(copy), alloc_(1));
+        assert(moved == l && moved.indexed() && copy.empty());
+        // equal allocators take over nodes
+        list_ other(alloc_(1));
+        other = std::move(moved);
+        assert(other == l && *other.nth(499) == -1);
+        list_ foreign(alloc_(3));
+        foreign.insert_before(foreign.end(), 7);
+        foreign = std::move(other);
+        assert(foreign == l && foreign.get_allocator() == alloc_(3));
+        assert(global_news == news);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0 && arena_live[3] == 0);
+    {
+        // moved from lists take values again, through any kind of assignment
+        list_ a(alloc_(1));
+        a.insert_before(a.end(), 1);
+        list_ b(std::move(a));
+        list_ five(alloc_(2));
+        five.insert_before(five.end(), 5);
+        a = std::move(five);
+        assert(a.size() == 1 && *a.begin() == 5);
+        list_ c(std::move(a));
+        a = b;
+        assert(a == b);
+        list_ d(std::move(b));
+        list_ seven(alloc_(1));
+        seven.insert_before(seven.end(), 7);
+        b = std::move(seven);
+        assert(*b.begin() == 7);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0);
+    {
+        const auto news = global_news;
+        index_list_ l(0, 0, alloc_(1));
+        for (int i = 0; i < 100; ++i) {
+            l.insert_before(l.end(), i);
+        }
+        index_list_ other(0, 0, alloc_(2));
+        other = std::move(l);
+        assert(other.size() == 100 && *other.begin() == 0 && l.empty());
+        index_list_ copy(other, alloc_(3));
+        assert(copy == other && copy.get_allocator() == alloc_(3) && arena_live[3] > 0);
+        index_list_ moved(std::move(copy), alloc_(1));
+        assert(moved == other && moved.get_allocator() == alloc_(1) && copy.empty());
+        index_list_ taken(std::move(moved), alloc_(1));
+        assert(taken == other && moved.empty());
+        index_list_ empty(alloc_(2));
+        assert(empty.empty() && empty.get_allocator() == alloc_(2));
+        assert(global_news == news);
+    }
+    assert(arena_live[1] == 0 && arena_live[2] == 0 && arena_live[3] == 0);
+#if CONT_HAS_PMR
+    {
+        // every byte comes from a buffer, upstream refuses to allocate
+        static char buffer[1 << 16];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        const auto news = global_news;
+        cont::pmr::list<int> l(&arena);
+        for (int i = 0; i < 200; ++i) {
+            l.insert_before(l.end(), i);
+        }
+        l.enable_index();
+        cont::pmr::list<int> copy(l, &arena);
+        assert(copy == l);
+        cont::pmr::index_list<int> il(&arena);
+        il.insert_before(il.end(), 1);
+        cont::pmr::index_list<int> il_copy(il, &arena);
+        assert(il_copy == il && il_copy.get_allocator().resource() == &arena);
+        assert(global_news == news);
+    }
+#endif
+    std::cout << "allocator test done\n";
+    return 0;
+}
@@ -61,6 +61,12 @@ int main() {
         auto rvalue = std::move(copy);
         std::cout << "move done\n";
         assert(rvalue == l);
+        // self assignment keeps the nodes
+        auto& self = rvalue;
+        rvalue = self;
+        assert(rvalue == l);
+        rvalue = std::move(self);
+        assert(rvalue == l);
     }
     assert(alloc_counter == 0);
 }
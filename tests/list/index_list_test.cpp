@@ -0,0 +1,119 @@
+#include "index_list.hpp"
+#include "test_struct.hpp"
+#include <cassert>
+#include <iostream>
+#include <list>
+#include <random>
+#include <stdexcept>
+
+using list_ = cont::index_list<test_struct>;
+auto same(const list_& l, const std::list<int>& ref) {
+    if (l.size() != ref.size()) {
+        return false;
+    }
+    auto it = l.begin();
+    for (auto val : ref) {
+        if ((*it).val != val) {
+            return false;
+        }
+        ++it;
+    }
+    // walk back to check left links
+    auto rit = l.end();
+    for (auto ref_it = ref.rbegin(); ref_it != ref.rend(); ++ref_it) {
+        --rit;
+        if ((*rit).val != *ref_it) {
+            return false;
+        }
+    }
+    return it == l.end();
+}
+
+int main() {
+    {
+        //0 - 1 - 2 - 3
+        list_ l;
+        auto it0 = l.insert(l.begin(), 0);
+        auto it3 = l.insert_before(l.end(), 3);
+        l.insert(it0, 1);
+        auto it4 = l.insert_before(it3, 4);
+        auto it5 = l.erase(it4);
+        assert(it5 == it3);
+        auto it2 = l.insert_before(it3, 2);
+        assert(it2.n == it4.n); // erased slot is reused
+        assert(same(l, {0, 1, 2, 3}));
+
+        // iterators are indices, they survive reallocation of a buffer
+        auto cap = l.capacity();
+        for (int i = 0; i < 100; i++) {
+            l.insert_before(l.end(), 5);
+        }
+        assert(l.capacity() > cap);
+        assert((*it2).val == 2 && (*it3).val == 3);
+
+        auto rit = list_::reverse_iterator(it3);
+        ++rit;
+        assert(rit == it2);
+
+        list_ copy = l;
+        assert(copy == l);
+        list_ moved = std::move(copy);
+        assert(moved == l);
+        assert(copy.empty());
+        moved.erase(moved.begin(), std::next(moved.begin(), 3));
+        assert(moved.size() == 100);
+        std::cout << "simple test done\n";
+    }
+    assert(alloc_counter == 0);
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<int> dist(0, 3);
+        list_ l(1, 0);
+        std::list<int> ref(1, 0);
+        for (int i = 0; i < 1000; i++) {
+            auto num = dist(gen);
+            std::uniform_int_distribution<int> node_dist(0, l.size() - 1);
+            auto node_num = node_dist(gen);
+            auto it = std::next(l.begin(), node_num);
+            auto ref_it = std::next(ref.begin(), node_num);
+            if (num == 0) {
+                *it = i;
+                *ref_it = i;
+            } else if (num == 1) {
+                l.insert_before(it, i);
+                ref.insert(ref_it, i);
+            } else if (num == 2) {
+                l.insert(it, i);
+                ref.insert(std::next(ref_it), i);
+            } else if (num == 3 && l.size() > 1) {
+                l.erase(it);
+                ref.erase(ref_it);
+            }
+            assert(same(l, ref));
+        }
+        // free-list keeps buffer from growing past high-water mark
+        assert(l.capacity() <= 1024);
+        std::cout << "random test done\n";
+    }
+    assert(alloc_counter == 0);
+    {
+        // inserting own value at full capacity reads it before the old buffer is freed
+        cont::index_list<long> l;
+        for (long i = 0; i < 16; i++) {
+            l.insert_before(l.end(), i);
+        }
+        assert(l.capacity() == 16);
+        l.insert_before(l.end(), *l.begin());
+        assert(l.size() == 17 && *std::next(l.begin(), 16) == 0);
+        bool thrown = false;
+        try {
+            l.reserve(cont::index_list<long>::npos);
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown && l.size() == 17);
+        std::cout << "self insert test done\n";
+    }
+    return 0;
+}
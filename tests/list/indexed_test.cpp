@@ -0,0 +1,105 @@
+#include "list.hpp"
+#include "test_struct.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using list_ = cont::list<test_struct>;
+auto same(const list_& l, const std::vector<int>& ref) {
+    if (l.size() != ref.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+        auto it = l.nth(i);
+        if ((*it).val != ref[i] || l.index_of(it) != i) {
+            return false;
+        }
+    }
+    return l.nth(ref.size()) == l.end() && l.index_of(l.end()) == ref.size();
+}
+
+int main() {
+    {
+        list_ l;
+        std::vector<int> ref;
+        for (int i = 0; i < 10; i++) {
+            l.insert_before(l.end(), i);
+            ref.emplace_back(i);
+        }
+        assert(l.size() == 10);
+        assert(same(l, ref)); // linear fallback
+        l.enable_index();
+        assert(l.indexed());
+        assert(same(l, ref));
+        l.insert_at(0, 100);
+        ref.insert(ref.begin(), 100);
+        l.insert_at(11, 101);
+        ref.insert(ref.end(), 101);
+        l.erase_at(5);
+        ref.erase(ref.begin() + 5);
+        assert(same(l, ref));
+
+        l.sort([](auto& lhs, auto& rhs) { return lhs.val > rhs.val; });
+        std::sort(ref.begin(), ref.end(), [](int lhs, int rhs) { return lhs > rhs; });
+        assert(same(l, ref));
+
+        list_ copy = l;
+        assert(copy.indexed());
+        assert(same(copy, ref));
+        list_ moved = std::move(copy);
+        assert(moved.indexed());
+        assert(same(moved, ref));
+        moved.clear();
+        assert(moved.size() == 0);
+        moved.insert_at(0, 1);
+        assert(same(moved, {1}));
+        l.disable_index();
+        assert(same(l, ref));
+        std::cout << "simple test done\n";
+    }
+    assert(alloc_counter == 0);
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<int> dist(0, 4);
+        list_ l(1, 0);
+        l.enable_index();
+        std::vector<int> ref(1, 0);
+        for (int i = 0; i < 3000; i++) {
+            auto num = dist(gen);
+            std::uniform_int_distribution<size_t> node_dist(0, l.size() - 1);
+            auto k = node_dist(gen);
+            auto it = l.nth(k);
+            assert(l.index_of(it) == k);
+            if (num == 0) {
+                *it = i;
+                ref[k] = i;
+            } else if (num == 1) {
+                l.insert_before(it, i);
+                ref.insert(ref.begin() + k, i);
+            } else if (num == 2) {
+                l.insert(it, i);
+                ref.insert(ref.begin() + k + 1, i);
+            } else if (num == 3) {
+                l.insert_at(k, i);
+                ref.insert(ref.begin() + k, i);
+            } else if (num == 4 && l.size() > 1) {
+                if (i % 2) {
+                    l.erase(it);
+                } else {
+                    l.erase_at(k);
+                }
+                ref.erase(ref.begin() + k);
+            }
+            assert(l.size() == ref.size());
+            if (i % 100 == 0) {
+                assert(same(l, ref));
+            }
+        }
+        assert(same(l, ref));
+        std::cout << "random test done\n";
+    }
+    assert(alloc_counter == 0);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#define CONT_INSTRUMENT 1
+#include "list.hpp"
+#include <cassert>
+#include <iostream>
+
+using cont::instrument::op_kind;
+
+int main() {
+    cont::list<int> l;
+    for (int i = 0; i < 100; ++i) {
+        l.insert_before(l.end(), i);
+    }
+    cont::instrument::reset();
+    int sum = 0;
+    for (auto it = l.begin(); it != l.end(); it++) {
+        sum += *it;
+    }
+    for (auto it = l.end(); it != l.begin();) {
+        --it;
+        sum -= *it;
+    }
+    auto s = cont::instrument::snapshot();
+    // postfix increment calls prefix one, it's counted once
+    assert(sum == 0 && s[op_kind::list_next].calls == 100 && s[op_kind::list_next].node_visits == 100);
+    assert(s[op_kind::list_prev].calls == 100);
+    assert(s[op_kind::list_next].allocations == 0 && s[op_kind::list_next].parent_climbs == 0);
+    assert(s[op_kind::tree_df_next].calls == 0);
+    std::cout << "instrument test done\n";
+    return 0;
+}
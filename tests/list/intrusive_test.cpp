@@ -0,0 +1,75 @@
+#include "intrusive_list.hpp"
+#include "test_struct.hpp"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+struct record {
+    test_struct value;
+    cont::list_hook hook;
+    record(int val)
+        : value(val) {}
+};
+
+using list_ = cont::intrusive_list<record, &record::hook>;
+auto values(const list_& l) {
+    std::vector<int> result;
+    for (auto it = l.begin(); it != l.end(); ++it) {
+        result.emplace_back((*it).value.val);
+    }
+    return result;
+}
+
+int main() {
+    {
+        std::vector<record> records;
+        for (int i = 0; i < 5; i++) {
+            records.emplace_back(i);
+        }
+        auto bak = alloc_counter;
+        list_ l;
+        assert(l.empty());
+        //0 - 1 - 2 - 3
+        auto it0 = l.insert(l.end(), records[0]);
+        auto it3 = l.insert_before(l.end(), records[3]);
+        l.insert(it0, records[1]);
+        auto it2 = l.insert_before(it3, records[2]);
+        assert(values(l) == (std::vector<int>{0, 1, 2, 3}));
+        assert(l.size() == 4);
+        assert(bak == alloc_counter); // no copies were made
+        assert(l.iterator_to(records[2]) == it2);
+        assert(&*l.iterator_to(records[1]) == &records[1]);
+        assert(!records[4].hook.is_linked());
+
+        auto it = l.erase(l.iterator_to(records[1]));
+        assert(it == it2);
+        assert(!records[1].hook.is_linked());
+        assert(values(l) == (std::vector<int>{0, 2, 3}));
+
+        auto rit = list_::reverse_iterator(--l.end());
+        std::vector<int> reversed;
+        while (rit != l.end<list_::reverse_iterator>()) {
+            reversed.emplace_back(rit->value.val);
+            ++rit;
+        }
+        assert(reversed == (std::vector<int>{3, 2, 0}));
+
+        list_ moved = std::move(l);
+        assert(l.empty());
+        assert(values(moved) == (std::vector<int>{0, 2, 3}));
+        moved.insert(moved.iterator_to(records[3]), records[4]);
+        assert(values(moved) == (std::vector<int>{0, 2, 3, 4}));
+        moved.erase(moved.begin(), moved.iterator_to(records[2]));
+        assert(values(moved) == (std::vector<int>{3, 4}));
+        assert(!records[0].hook.is_linked());
+        moved.clear();
+        assert(moved.empty());
+        for (auto& r : records) {
+            assert(!r.hook.is_linked());
+        }
+        assert(bak == alloc_counter);
+        std::cout << "intrusive list done\n";
+    }
+    assert(alloc_counter == 0);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "list.hpp"
+#include "test_struct.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <utility>
+
+template<class List, class Compare>
+auto is_sorted(const List& l, Compare comp) {
+    if (l.empty()) {
+        return true;
+    }
+    auto prev = l.begin();
+    auto it = std::next(prev);
+    while (it != l.end()) {
+        if (comp(*it, *prev)) {
+            return false;
+        }
+        prev = it;
+        ++it;
+    }
+    // check left links too, reverse walk has to visit every node
+    auto rit = l.end();
+    --rit;
+    size_t count = 1;
+    while (rit != l.begin()) {
+        --rit;
+        ++count;
+    }
+    return count == l.size();
+}
+
+int main() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    {
+        using list_ = cont::list<test_struct>;
+        std::uniform_int_distribution<int> dist(0, 100);
+        auto comp = [](auto& lhs, auto& rhs) { return lhs.val < rhs.val; };
+        list_ l;
+        l.sort(comp);
+        for (int i = 0; i < 100; i++) {
+            l.insert_before(l.end(), dist(gen));
+        }
+        auto first = l.begin();
+        auto bak = alloc_counter;
+        l.sort(comp);
+        assert(bak == alloc_counter); // no copies were made
+        assert(is_sorted(l, comp));
+        bool found = false; // iterators stay valid
+        for (auto it = l.begin(); it != l.end(); ++it) {
+            found |= it == first;
+        }
+        assert(found);
+        std::cout << "sort done\n";
+    }
+    assert(alloc_counter == 0);
+    {
+        using list_ = cont::list<std::pair<int, int>>;
+        std::uniform_int_distribution<int> dist(0, 1000);
+        auto comp = [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; };
+        auto stable = [](const list_& l) {
+            auto prev = l.begin();
+            for (auto it = std::next(prev); it != l.end(); prev = it, ++it) {
+                if ((*it).first == (*prev).first && (*it).second < (*prev).second) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        list_ l, pl;
+        for (int i = 0; i < 200000; i++) {
+            auto val = dist(gen);
+            l.insert_before(l.end(), val, i);
+            pl.insert_before(pl.end(), val, i);
+        }
+        l.sort(comp);
+        assert(is_sorted(l, comp));
+        assert(stable(l));
+        pl.parallel_sort(comp, 4);
+        assert(is_sorted(pl, comp));
+        assert(stable(pl));
+        assert(l == pl);
+        std::cout << "parallel sort done\n";
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "index_list.hpp"
+#include "list.hpp"
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+using alloc_ = cont::counting_allocator<long>;
+
+int main() {
+    {
+        cont::list<long> l;
+        l.insert_before(l.end(), 1);
+        auto s = l.stats();
+        assert(s.elements == 1 && s.live_nodes == 2 && !s.counted && s.value_bytes == sizeof(long));
+    }
+    cont::alloc_counters counters;
+    {
+        cont::list<long, alloc_> l(alloc_{counters});
+        for (long i = 0; i < 1000; ++i) {
+            l.insert_before(l.end(), i);
+        }
+        auto s = l.stats();
+        assert(s.elements == 1000 && s.live_nodes == 1001 && s.counted);
+        // nodes, values and index are all that list allocates
+        assert(s.allocated_bytes == s.node_bytes + s.value_bytes);
+        assert(s.allocations - s.deallocations == s.live_nodes + s.elements);
+
+        l.enable_index();
+        auto indexed = l.stats();
+        assert(indexed.node_bytes > s.node_bytes && indexed.allocated_bytes == indexed.node_bytes + indexed.value_bytes);
+        l.insert_at(10, -1);
+        l.erase_at(500);
+        l.erase_at(0);
+        s = l.stats();
+        assert(s.elements == 999 && s.allocated_bytes == s.node_bytes + s.value_bytes);
+        l.disable_index();
+        s = l.stats();
+        assert(s.allocated_bytes == s.node_bytes + s.value_bytes && s.peak_bytes >= indexed.allocated_bytes);
+        assert(s.bytes_per_element() == double(s.allocated_bytes) / 999);
+
+        cont::list<long, alloc_> moved(std::move(l));
+        assert(moved.stats().elements == 999 && l.stats().elements == 0 && l.stats().live_nodes == 0);
+    }
+    assert(counters.live_bytes == 0 && counters.allocations == counters.deallocations);
+    {
+        cont::index_list<long, alloc_> l(0, 0, alloc_{counters});
+        for (long i = 0; i < 100; ++i) {
+            l.insert_before(l.end(), i);
+        }
+        auto s = l.stats();
+        assert(s.elements == 100 && s.value_bytes == 100 * sizeof(long));
+        assert(s.allocated_bytes == s.node_bytes + s.value_bytes);
+        l.clear();
+        assert(l.stats().elements == 0 && l.stats().value_bytes == 0);
+    }
+    assert(counters.live_bytes == 0);
+    {
+        // default constructed allocators share global counters from any thread
+        auto work = [] {
+            cont::list<long, alloc_> l;
+            for (long i = 0; i < 10000; ++i) {
+                l.insert_before(l.end(), i);
+            }
+        };
+        std::thread a(work), b(work);
+        a.join();
+        b.join();
+        const auto& global = cont::global_alloc_counters();
+        assert(global.live_bytes == 0 && global.allocations == global.deallocations);
+        assert(global.allocations >= 2 * 20000);
+    }
+    std::cout << "stats test done\n";
+    return 0;
+}
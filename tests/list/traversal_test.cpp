@@ -0,0 +1,61 @@
+#include "list.hpp"
+#include "test_struct.hpp"
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+int main() {
+    {
+        using list_ = cont::list<test_struct>;
+        list_ l;
+        assert(l.to_vector().empty());
+        for (int i = 0; i < 100; i++) {
+            l.insert_before(l.end(), i);
+        }
+        int sum = 0;
+        l.for_each([&sum](const test_struct& val) { sum += val.val; });
+        assert(sum == 4950);
+        l.for_each([](test_struct& val) { val.val *= 2; });
+        const auto& cl = l;
+        sum = 0;
+        cl.for_each([&sum](const test_struct& val) { sum += val.val; });
+        assert(sum == 9900);
+
+        auto vec = l.to_vector();
+        assert(vec.size() == 100);
+        std::vector<test_struct> copy;
+        l.copy_to(std::back_inserter(copy));
+        assert(vec == copy);
+        auto it = l.begin();
+        for (auto& val : vec) {
+            assert(val == *it);
+            ++it;
+        }
+        std::cout << "traversal done\n";
+    }
+    assert(alloc_counter == 0);
+    {
+        cont::list<int> l;
+        for (int i = 0; i < 3; i++) {
+            l.insert_before(l.end(), i);
+        }
+        int buf[3] = {};
+        auto end = l.copy_to(buf);
+        assert(end == buf + 3);
+        assert(buf[0] == 0 && buf[1] == 1 && buf[2] == 2);
+    }
+    {
+        // trivial values are gathered from both ends, odd and even sizes meet differently
+        cont::list<int> l;
+        for (int i = 0; i < 8; i++) {
+            auto vec = l.to_vector();
+            assert(vec.size() == size_t(i) && vec.capacity() == vec.size());
+            for (int k = 0; k < i; k++) {
+                assert(vec[k] == k);
+            }
+            l.insert_before(l.end(), i);
+        }
+    }
+    return 0;
+}
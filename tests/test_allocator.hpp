@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+/**
+ * Bytes taken from each arena of arena_allocator
+ */
+static size_t arena_live[4] = {};
+/**
+ * Calls of global operator new, containers with arena_allocator shouldn't make any
+ */
+static size_t global_news = 0;
+
+void* operator new(size_t size) {
+    global_news++;
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    global_news++;
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/**
+ * Stateful allocator, instances of different arenas are unequal
+ */
+template<class T>
+struct arena_allocator {
+    using value_type = T;
+    int arena;
+
+    explicit arena_allocator(int arena) : arena(arena) {}
+    template<class U>
+    arena_allocator(const arena_allocator<U>& rhs) : arena(rhs.arena) {}
+
+    T* allocate(size_t n) {
+        arena_live[arena] += n * sizeof(T);
+        if (auto p = std::malloc(n * sizeof(T))) {
+            return static_cast<T*>(p);
+        }
+        throw std::bad_alloc();
+    }
+    void deallocate(T* p, size_t n) {
+        arena_live[arena] -= n * sizeof(T);
+        std::free(p);
+    }
+    template<class U>
+    friend bool operator==(const arena_allocator& lhs, const arena_allocator<U>& rhs) {
+        return lhs.arena == rhs.arena;
+    }
+    template<class U>
+    friend bool operator!=(const arena_allocator& lhs, const arena_allocator<U>& rhs) {
+        return lhs.arena != rhs.arena;
+    }
+};